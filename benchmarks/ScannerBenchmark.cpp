@@ -0,0 +1,347 @@
+// 扫描器基准测试：生成合成的卸载信息注册表，测量AppScanner完整路径
+// （枚举、解析、系统应用判定、信号投递和搜索）的耗时与内存，结果以JSON输出。
+//
+// 用法: btu_scanner_benchmark [--sizes 100,1000,10000,100000] [--output result.json]
+//                            [--queries 200] [--batch 256] [--seed 42] [--write-fixture dir]
+
+#include "AppScanner.h"
+#include "FixtureRegistryBackend.h"
+#include "Version.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QDate>
+#include <QDateTime>
+#include <QRandomGenerator>
+#include <QStandardPaths>
+#include <QSysInfo>
+#include <QThread>
+#include <QTextStream>
+#include <algorithm>
+#include <cmath>
+#include <memory>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace {
+
+const char* const kNameWords[] = {
+    "Adobe", "Acrobat", "Reader", "Studio", "Visual", "Code", "Office", "Player", "Media", "Cloud",
+    "Sync", "Drive", "Photo", "Editor", "Manager", "Tools", "Runtime", "Driver", "Update", "Helper",
+    "Game", "Launcher", "Browser", "Mail", "Chat", "Backup", "Security", "Antivirus", "VPN", "Toolkit",
+    "SDK", "Compiler", "Python", "Java", "Node", "Git", "Terminal", "Notes", "Viewer", "Converter"
+};
+
+const char* const kPublishers[] = {
+    "Microsoft Corporation", "Adobe Inc.", "Google LLC", "Mozilla", "Oracle Corporation",
+    "NVIDIA Corporation", "Intel Corporation", "Valve Corporation", "JetBrains s.r.o.", "Apple Inc.",
+    "Python Software Foundation", "The Git Development Community", "Tencent", "Alibaba", "Kingsoft",
+    "Realtek Semiconductor Corp.", "AMD", "Logitech", "Dropbox, Inc.", "Zoom Video Communications"
+};
+
+const char* const kHivePaths[] = {
+    "HKEY_LOCAL_MACHINE\\SOFTWARE\\Microsoft\\Windows\\CurrentVersion\\Uninstall",
+    "HKEY_LOCAL_MACHINE\\SOFTWARE\\WOW6432Node\\Microsoft\\Windows\\CurrentVersion\\Uninstall",
+    "HKEY_CURRENT_USER\\SOFTWARE\\Microsoft\\Windows\\CurrentVersion\\Uninstall"
+};
+
+template <typename T, size_t N>
+constexpr int arraySize(const T (&)[N]) { return static_cast<int>(N); }
+
+// 发布商近似Zipf分布：少数发布商占据大部分条目
+int pickPublisher(QRandomGenerator& random) {
+    const double u = random.generateDouble();
+    const int count = arraySize(kPublishers);
+    return qMin(count - 1, static_cast<int>(std::pow(u, 2.5) * count));
+}
+
+QString randomName(QRandomGenerator& random, int index) {
+    const int words = 1 + random.bounded(3);
+    QStringList parts;
+    for (int i = 0; i < words; ++i) {
+        parts << kNameWords[random.bounded(arraySize(kNameWords))];
+    }
+    // 序号保证名称唯一，避免大目录中全部重名
+    parts << QString::number(index);
+    return parts.join(' ');
+}
+
+QString randomInstallDate(QRandomGenerator& random) {
+    const QDate date = QDate(2010, 1, 1).addDays(random.bounded(5000));
+    switch (random.bounded(10)) {
+    case 0: return date.toString("yyyy-MM-dd");
+    case 1: return date.toString("M/d/yyyy");
+    case 2: return QString();
+    default: return date.toString("yyyyMMdd");
+    }
+}
+
+// 生成接近真实分布的卸载信息：约10%为没有显示名的组件条目，
+// 约70%带安装目录，约60%带EstimatedSize（对数正态分布，单位KB）
+void generateCatalog(FixtureRegistryBackend& registry, int entries, quint32 seed) {
+    QRandomGenerator random(seed);
+    registry.clear();
+    
+    for (int i = 0; i < entries; ++i) {
+        const int hiveRoll = random.bounded(10);
+        const int hive = hiveRoll < 6 ? 0 : (hiveRoll < 9 ? 1 : 2);
+        const QString subKey = random.bounded(4) == 0
+            ? QString("{%1}").arg(QString::number(random.generate64(), 16).toUpper())
+            : QString("App%1").arg(i);
+        
+        QVariantHash values;
+        if (random.bounded(10) != 0) {
+            const QString name = randomName(random, i);
+            values.insert("DisplayName", name);
+            values.insert("DisplayVersion", QString("%1.%2.%3").arg(random.bounded(20)).arg(random.bounded(10)).arg(random.bounded(1000)));
+            values.insert("Publisher", QString(kPublishers[pickPublisher(random)]));
+            values.insert("UninstallString", QString("\"C:\\Program Files\\%1\\uninstall.exe\"").arg(name));
+            
+            const QString installDate = randomInstallDate(random);
+            if (!installDate.isEmpty()) {
+                values.insert("InstallDate", installDate);
+            }
+            if (random.bounded(10) < 7) {
+                values.insert("InstallLocation", QString("C:\\Program Files\\%1").arg(name));
+            }
+            if (random.bounded(10) < 6) {
+                values.insert("EstimatedSize", static_cast<qint64>(std::exp(8.0 + 4.0 * random.generateDouble())));
+            }
+        } else {
+            values.insert("SystemComponent", 1);
+            values.insert("ParentKeyName", "OperatingSystem");
+        }
+        
+        registry.setValues(QString("%1\\%2").arg(kHivePaths[hive], subKey), values);
+    }
+}
+
+// 峰值常驻内存（KB）
+qint64 peakMemoryKb() {
+#ifdef Q_OS_WIN
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return static_cast<qint64>(counters.PeakWorkingSetSize / 1024);
+    }
+    return -1;
+#else
+    QFile status("/proc/self/status");
+    if (status.open(QIODevice::ReadOnly)) {
+        for (const QByteArray& line : status.readAll().split('\n')) {
+            if (line.startsWith("VmHWM:")) {
+                return line.mid(6).trimmed().split(' ').value(0).toLongLong();
+            }
+        }
+    }
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+#endif
+}
+
+// 尽可能重置峰值统计，使每轮测量只反映本轮
+void resetPeakMemory() {
+#ifdef Q_OS_LINUX
+    QFile clearRefs("/proc/self/clear_refs");
+    if (clearRefs.open(QIODevice::WriteOnly)) {
+        clearRefs.write("5");
+    }
+#endif
+}
+
+struct ScanMeasurement {
+    qint64 elapsedUs = -1;
+    qint64 firstRowUs = -1;
+    int rows = 0;
+    int batches = 0;
+    int updates = 0;
+};
+
+// 运行一次扫描直到scanFinished，统计首行时间和投递情况
+ScanMeasurement runScan(AppScanner& scanner, bool incremental) {
+    ScanMeasurement measurement;
+    QElapsedTimer timer;
+    QEventLoop loop;
+    
+    auto onRows = [&](int count) {
+        if (measurement.firstRowUs < 0) {
+            measurement.firstRowUs = timer.nsecsElapsed() / 1000;
+        }
+        measurement.rows += count;
+        ++measurement.batches;
+    };
+    
+    QList<QMetaObject::Connection> connections;
+    connections << QObject::connect(&scanner, &AppScanner::applicationsFound, [&](const QList<ApplicationInfo>& batch) {
+        onRows(static_cast<int>(batch.size()));
+    });
+    connections << QObject::connect(&scanner, &AppScanner::applicationFound, [&](const ApplicationInfo&) {
+        onRows(1);
+    });
+    connections << QObject::connect(&scanner, &AppScanner::applicationUpdated, [&](const ApplicationInfo&) {
+        ++measurement.updates;
+    });
+    connections << QObject::connect(&scanner, &AppScanner::scanFinished, &loop, &QEventLoop::quit);
+    
+    timer.start();
+    if (incremental) {
+        scanner.refreshApplications();
+    } else {
+        scanner.startScan();
+    }
+    loop.exec();
+    measurement.elapsedUs = timer.nsecsElapsed() / 1000;
+    
+    for (const QMetaObject::Connection& connection : connections) {
+        QObject::disconnect(connection);
+    }
+    return measurement;
+}
+
+QJsonObject runBenchmark(int entries, int queryCount, int batchSize, quint32 seed, const QString& fixtureDir) {
+    auto registry = std::make_shared<FixtureRegistryBackend>();
+    
+    QElapsedTimer generateTimer;
+    generateTimer.start();
+    generateCatalog(*registry, entries, seed);
+    const qint64 generateMs = generateTimer.elapsed();
+    
+    if (!fixtureDir.isEmpty()) {
+        registry->save(QString("%1/uninstall_%2.json").arg(fixtureDir).arg(entries));
+    }
+    
+    resetPeakMemory();
+    
+    AppScanner scanner;
+    scanner.setRegistryBackend(registry);
+    scanner.setBatchDelivery(batchSize, 16);
+    
+    // 完整扫描
+    const ScanMeasurement full = runScan(scanner, false);
+    const QList<ApplicationInfo> applications = scanner.getApplications();
+    
+    // 修改1%的条目后增量扫描
+    QRandomGenerator random(seed + 1);
+    const int changed = qMax(1, static_cast<int>(applications.size()) / 100);
+    for (int i = 0; i < changed && !applications.isEmpty(); ++i) {
+        const ApplicationInfo& appInfo = applications[random.bounded(static_cast<int>(applications.size()))];
+        registry->setValue(appInfo.registryKey(), "DisplayVersion", QString("99.0.%1").arg(i));
+    }
+    const ScanMeasurement incremental = runScan(scanner, true);
+    
+    // 搜索：名称前缀、完整单词、发布商和不存在的词混合
+    QStringList queries;
+    for (int i = 0; i < queryCount && !applications.isEmpty(); ++i) {
+        const ApplicationInfo& appInfo = applications[random.bounded(static_cast<int>(applications.size()))];
+        switch (i % 4) {
+        case 0: queries << appInfo.name.left(3); break;
+        case 1: queries << appInfo.name.section(' ', 0, 0); break;
+        case 2: queries << appInfo.publisher.section(' ', 0, 0); break;
+        default: queries << QString("zzqx%1").arg(i); break;
+        }
+    }
+    
+    QVector<qint64> searchUs;
+    searchUs.reserve(queries.size());
+    qint64 searchHits = 0;
+    for (const QString& query : queries) {
+        QElapsedTimer timer;
+        timer.start();
+        searchHits += scanner.searchApplications(query).size();
+        searchUs.append(timer.nsecsElapsed() / 1000);
+    }
+    std::sort(searchUs.begin(), searchUs.end());
+    
+    qint64 searchTotalUs = 0;
+    for (qint64 us : searchUs) {
+        searchTotalUs += us;
+    }
+    
+    QJsonObject result;
+    result["entries"] = entries;
+    result["validApplications"] = static_cast<int>(applications.size());
+    result["generateMs"] = generateMs;
+    result["fullScanMs"] = full.elapsedUs / 1000.0;
+    result["timeToFirstRowMs"] = full.firstRowUs / 1000.0;
+    result["entriesPerSecond"] = full.elapsedUs > 0 ? entries * 1000000.0 / full.elapsedUs : 0.0;
+    result["rowsDelivered"] = full.rows;
+    result["batchesDelivered"] = full.batches;
+    result["incrementalChangedEntries"] = changed;
+    result["incrementalScanMs"] = incremental.elapsedUs / 1000.0;
+    result["incrementalUpdates"] = incremental.updates;
+    result["searchQueries"] = static_cast<int>(searchUs.size());
+    result["searchHits"] = searchHits;
+    result["searchAvgUs"] = searchUs.isEmpty() ? 0.0 : static_cast<double>(searchTotalUs) / searchUs.size();
+    result["searchP95Us"] = searchUs.isEmpty() ? 0 : searchUs[static_cast<int>(searchUs.size() * 95 / 100)];
+    result["peakMemoryKb"] = peakMemoryKb();
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("BTUScannerBenchmark");
+    app.setApplicationVersion(BTU_VERSION_STRING);
+    
+    // 快照和缓存写入测试目录，不影响正式安装的数据
+    QStandardPaths::setTestModeEnabled(true);
+    
+    QCommandLineParser parser;
+    parser.setApplicationDescription("BTU扫描器基准测试");
+    parser.addHelpOption();
+    parser.addOption({"sizes", "条目数量列表，逗号分隔", "list", "100,1000,10000,100000"});
+    parser.addOption({"output", "JSON结果输出文件，默认输出到标准输出", "file"});
+    parser.addOption({"queries", "每轮搜索次数", "count", "200"});
+    parser.addOption({"batch", "批量投递大小，0为逐条投递", "count", "256"});
+    parser.addOption({"seed", "随机种子", "seed", "42"});
+    parser.addOption({"write-fixture", "将生成的模拟注册表保存到该目录", "dir"});
+    parser.process(app);
+    
+    QJsonArray results;
+    const QStringList sizes = parser.value("sizes").split(',', Qt::SkipEmptyParts);
+    for (const QString& size : sizes) {
+        const int entries = size.trimmed().toInt();
+        if (entries <= 0) {
+            continue;
+        }
+        
+        QTextStream(stderr) << "benchmark: " << entries << " entries" << Qt::endl;
+        results.append(runBenchmark(entries, parser.value("queries").toInt(), parser.value("batch").toInt(),
+                                    parser.value("seed").toUInt(), parser.value("write-fixture")));
+    }
+    
+    QJsonObject report;
+    report["benchmark"] = "scanner";
+    report["version"] = BTU_VERSION_STRING;
+    report["timestamp"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    report["platform"] = QSysInfo::prettyProductName();
+    report["cpuArchitecture"] = QSysInfo::currentCpuArchitecture();
+    report["threads"] = QThread::idealThreadCount();
+    report["results"] = results;
+    
+    const QByteArray json = QJsonDocument(report).toJson(QJsonDocument::Indented);
+    const QString outputPath = parser.value("output");
+    if (outputPath.isEmpty()) {
+        QTextStream(stdout) << json;
+        return 0;
+    }
+    
+    QFile output(outputPath);
+    if (!output.open(QIODevice::WriteOnly)) {
+        QTextStream(stderr) << "无法写入结果文件: " << outputPath << Qt::endl;
+        return 1;
+    }
+    output.write(json);
+    return 0;
+}
@@ -1,23 +1,85 @@
 #include "AppScanner.h"
+#include "CatalogSnapshot.h"
 #include "SafetyChecker.h"
 #include "Logger.h"
-#include <QSettings>
 #include <QDir>
 #include <QFileInfo>
 #include <QCoreApplication>
 #include <QRegularExpression>
+#include <QThreadPool>
+#include <QSet>
+#include <QDate>
 
-#ifdef Q_OS_WIN
-#include <windows.h>
-#include <winreg.h>
-#endif
+namespace {
+
+// 进度信号的最小间隔（毫秒）
+const int kProgressIntervalMs = 50;
+
+} // namespace
+
+// ApplicationInfo实现
+const QStringList& ApplicationInfo::hivePaths() {
+    static const QStringList paths = {
+        "HKEY_LOCAL_MACHINE\\SOFTWARE\\Microsoft\\Windows\\CurrentVersion\\Uninstall",
+        "HKEY_LOCAL_MACHINE\\SOFTWARE\\WOW6432Node\\Microsoft\\Windows\\CurrentVersion\\Uninstall",
+        "HKEY_CURRENT_USER\\SOFTWARE\\Microsoft\\Windows\\CurrentVersion\\Uninstall"
+    };
+    return paths;
+}
+
+QString ApplicationInfo::registryKey() const {
+    return hivePaths().value(hive) + "\\" + subKey;
+}
+
+QString ApplicationInfo::sizeText() const {
+    const qint64 bytes = footprint();
+    return bytes < 0 ? QString("未知") : formatSize(bytes);
+}
+
+QString ApplicationInfo::installDateText() const {
+    if (installDate == 0) {
+        return QString();
+    }
+    return QString("%1-%2-%3")
+        .arg(installDate / 10000, 4, 10, QChar('0'))
+        .arg((installDate / 100) % 100, 2, 10, QChar('0'))
+        .arg(installDate % 100, 2, 10, QChar('0'));
+}
+
+QString ApplicationInfo::formatSize(qint64 bytes) {
+    if (bytes < 1024) {
+        return QString("%1 B").arg(bytes);
+    } else if (bytes < 1024 * 1024) {
+        return QString("%1 KB").arg(bytes / 1024);
+    } else if (bytes < 1024 * 1024 * 1024) {
+        return QString("%1 MB").arg(bytes / (1024 * 1024));
+    } else {
+        return QString("%1 GB").arg(bytes / (1024 * 1024 * 1024));
+    }
+}
 
 AppScanner::AppScanner(QObject* parent)
     : QObject(parent)
     , m_scanThread(nullptr)
+    , m_scanWorker(nullptr)
+    , m_registry(RegistryBackend::defaultBackend())
+    , m_sizeEngine(new SizeEngine(this))
+    , m_batchSize(0)
+    , m_batchIntervalMs(16)
     , m_isScanning(false)
+    , m_isSilentScan(false)
+    , m_reconcilePending(false)
+    , m_searchRevision(0)
+    , m_scanGeneration(0)
+    , m_addedCount(0)
+    , m_updatedCount(0)
     , m_shouldStop(false)
+    , m_snapshotGeneration(0)
 {
+    m_snapshotPool.setMaxThreadCount(1);
+    
+    connect(m_sizeEngine, &SizeEngine::sizeCalculated, this, &AppScanner::onSizeCalculated);
+    connect(m_sizeEngine, &SizeEngine::finished, this, &AppScanner::onSizeCalculationFinished);
 }
 
 AppScanner::~AppScanner() {
@@ -29,24 +91,70 @@ void AppScanner::startScan() {
         return;
     }
     
+    beginScan(false);
+}
+
+void AppScanner::beginScan(bool incremental, bool silent, const ScanScope& scope) {
     m_isScanning = true;
+    m_isSilentScan = silent;
+    m_scanScope = scope;
     m_shouldStop = false;
-    m_applications.clear();
+    m_addedCount = 0;
+    m_updatedCount = 0;
+    
+    // 前台扫描结束后会重新计算全部目录占用
+    if (!silent) {
+        m_sizeEngine->cancel();
+        m_pendingSizeTargets.clear();
+    }
+    
+    if (!incremental) {
+        {
+            QMutexLocker locker(&m_mutex);
+            m_applications.clear();
+            m_fingerprints.clear();
+            m_rowByKey.clear();
+            m_searchIndex.clear();
+        }
+        ++m_searchRevision;
+        emit applicationsCleared();
+    }
     
     // 创建工作线程
     m_scanThread = new QThread(this);
     ScanWorker* worker = new ScanWorker(this);
     worker->moveToThread(m_scanThread);
+    m_scanWorker = worker;
     
-    // 连接信号
+    // 连接信号：结果在本线程中合并到目录，已被停止的扫描投递的结果按代号丢弃
+    const quint64 generation = ++m_scanGeneration;
     connect(m_scanThread, &QThread::started, worker, &ScanWorker::doWork);
-    connect(worker, &ScanWorker::finished, this, &AppScanner::onScanFinished);
-    connect(worker, &ScanWorker::applicationFound, this, &AppScanner::applicationFound);
-    connect(worker, &ScanWorker::progress, this, &AppScanner::scanProgress);
+    connect(m_scanThread, &QThread::finished, worker, &QObject::deleteLater);
+    connect(worker, &ScanWorker::parsed, this, [this, generation](const QList<ApplicationInfo>& batch) {
+        if (generation == m_scanGeneration) {
+            mergeParsed(batch);
+        }
+    });
+    connect(worker, &ScanWorker::completed, this,
+            [this, generation](const QHash<QString, quint64>& fingerprints, const QStringList& invalidKeys) {
+        if (generation == m_scanGeneration) {
+            completeScan(fingerprints, invalidKeys);
+        }
+    });
+    connect(worker, &ScanWorker::finished, this, [this, generation]() {
+        if (generation == m_scanGeneration) {
+            onScanFinished();
+        }
+    });
     connect(worker, &ScanWorker::error, this, &AppScanner::scanError);
     
-    emit scanStarted();
-    LOG_INFO("开始扫描已安装应用程序");
+    if (silent) {
+        LOG_INFO("开始后台对账已安装应用程序");
+    } else {
+        connect(worker, &ScanWorker::progress, this, &AppScanner::scanProgress);
+        emit scanStarted();
+        LOG_INFO(incremental ? "开始增量扫描已安装应用程序" : "开始扫描已安装应用程序");
+    }
     
     m_scanThread->start();
 }
@@ -57,6 +165,13 @@ void AppScanner::stopScan() {
     }
     
     m_shouldStop = true;
+    ++m_scanGeneration;
+    
+    // 被中止的扫描不再投递结果，以免与随后开始的扫描混在一起
+    if (m_scanWorker) {
+        disconnect(m_scanWorker, nullptr, this, nullptr);
+        m_scanWorker = nullptr;
+    }
     
     if (m_scanThread) {
         m_scanThread->quit();
@@ -70,6 +185,7 @@ void AppScanner::stopScan() {
 
 void AppScanner::onScanFinished() {
     m_isScanning = false;
+    m_scanWorker = nullptr;
     
     if (m_scanThread) {
         m_scanThread->quit();
@@ -78,8 +194,297 @@ void AppScanner::onScanFinished() {
         m_scanThread = nullptr;
     }
     
-    LOG_INFO(QString("扫描完成，找到 %1 个应用程序").arg(m_applications.size()));
-    emit scanFinished();
+    if (m_isSilentScan) {
+        LOG_INFO(QString("后台对账完成，共 %1 个应用程序").arg(m_applications.size()));
+    } else {
+        LOG_INFO(QString("扫描完成，找到 %1 个应用程序").arg(m_applications.size()));
+        emit scanFinished();
+    }
+    
+    if (!m_shouldStop) {
+        emit catalogChanged();
+        
+        // 对账只需计算新增或安装目录变化的应用
+        startSizeCalculation(m_isSilentScan);
+    }
+    
+    if (m_reconcilePending) {
+        // 全量对账覆盖所有局部请求
+        m_reconcilePending = false;
+        m_pendingReconcileKeys.clear();
+        m_pendingReconcileHives.clear();
+        reconcile();
+    } else if (!m_pendingReconcileKeys.isEmpty() || !m_pendingReconcileHives.isEmpty()) {
+        const QStringList keys(m_pendingReconcileKeys.cbegin(), m_pendingReconcileKeys.cend());
+        const QList<int> hives(m_pendingReconcileHives.cbegin(), m_pendingReconcileHives.cend());
+        m_pendingReconcileKeys.clear();
+        m_pendingReconcileHives.clear();
+        reconcileKeys(keys, hives);
+    }
+}
+
+void AppScanner::reconcile() {
+    if (m_isScanning) {
+        m_reconcilePending = true;
+        return;
+    }
+    
+    bool hasFingerprints;
+    {
+        QMutexLocker locker(&m_mutex);
+        hasFingerprints = !m_fingerprints.isEmpty();
+    }
+    
+    // 还没有完成过扫描时没有可对账的基准
+    if (hasFingerprints) {
+        beginScan(true, true);
+    }
+}
+
+void AppScanner::reconcileKeys(const QStringList& registryKeys, const QList<int>& hives) {
+    if (registryKeys.isEmpty() && hives.isEmpty()) {
+        return;
+    }
+    
+    if (m_isScanning) {
+        for (const QString& key : registryKeys) {
+            m_pendingReconcileKeys.insert(key);
+        }
+        for (int hive : hives) {
+            m_pendingReconcileHives.insert(hive);
+        }
+        return;
+    }
+    
+    bool hasFingerprints;
+    {
+        QMutexLocker locker(&m_mutex);
+        hasFingerprints = !m_fingerprints.isEmpty();
+    }
+    
+    // 还没有完成过扫描时没有可对账的基准
+    if (hasFingerprints) {
+        ScanScope scope;
+        scope.all = false;
+        scope.registryKeys = registryKeys;
+        scope.hives = hives;
+        beginScan(true, true, scope);
+    }
+}
+
+QStringList AppScanner::knownRegistryKeys() const {
+    QMutexLocker locker(&m_mutex);
+    return m_fingerprints.keys();
+}
+
+void AppScanner::mergeParsed(const QList<ApplicationInfo>& parsed) {
+    QList<ApplicationInfo> added;
+    QList<ApplicationInfo> updated;
+    {
+        QMutexLocker locker(&m_mutex);
+        for (ApplicationInfo appInfo : parsed) {
+            const QString key = appInfo.registryKey();
+            auto it = m_rowByKey.constFind(key);
+            if (it != m_rowByKey.constEnd()) {
+                // 安装目录未变时沿用已计算的目录占用
+                const ApplicationInfo& existing = m_applications[it.value()];
+                if (existing.installLocation == appInfo.installLocation) {
+                    appInfo.diskSize = existing.diskSize;
+                    appInfo.allocatedSize = existing.allocatedSize;
+                }
+                if (existing.name != appInfo.name || existing.publisher != appInfo.publisher) {
+                    m_searchIndex.insert(key, appInfo.name, appInfo.publisher);
+                    ++m_searchRevision;
+                }
+                m_applications[it.value()] = appInfo;
+                updated.append(appInfo);
+            } else {
+                m_rowByKey.insert(key, static_cast<int>(m_applications.size()));
+                m_applications.append(appInfo);
+                m_searchIndex.insert(key, appInfo.name, appInfo.publisher);
+                added.append(appInfo);
+            }
+        }
+    }
+    if (!added.isEmpty()) {
+        ++m_searchRevision;
+    }
+    m_addedCount += static_cast<int>(added.size());
+    m_updatedCount += static_cast<int>(updated.size());
+    
+    for (const ApplicationInfo& appInfo : updated) {
+        emit applicationUpdated(appInfo);
+    }
+    if (added.isEmpty()) {
+        return;
+    }
+    if (m_batchSize > 0) {
+        emit applicationsFound(added);
+    } else {
+        for (const ApplicationInfo& appInfo : added) {
+            emit applicationFound(appInfo);
+        }
+    }
+}
+
+void AppScanner::completeScan(const QHash<QString, quint64>& fingerprints, const QStringList& invalidKeys) {
+    QStringList removedKeys;
+    bool incremental;
+    {
+        QMutexLocker locker(&m_mutex);
+        incremental = !m_fingerprints.isEmpty();
+        
+        // 不再存在或不再是有效应用的子键
+        const QSet<QString> invalid(invalidKeys.cbegin(), invalidKeys.cend());
+        for (auto it = m_rowByKey.constBegin(); it != m_rowByKey.constEnd(); ++it) {
+            if (!fingerprints.contains(it.key()) || invalid.contains(it.key())) {
+                removedKeys.append(it.key());
+            }
+        }
+    }
+    
+    // 逐个删除并通知，接收方处理每个通知时看到的行号与目录一致
+    for (const QString& key : removedKeys) {
+        int row;
+        {
+            QMutexLocker locker(&m_mutex);
+            row = removeRow(key);
+        }
+        emit applicationRemoved(key, row);
+    }
+    
+    bool changed;
+    {
+        QMutexLocker locker(&m_mutex);
+        changed = fingerprints != m_fingerprints;
+        m_fingerprints = fingerprints;
+    }
+    
+    // 目录有变化时在后台更新磁盘快照
+    if (changed) {
+        saveSnapshot();
+    }
+    
+    if (incremental) {
+        LOG_INFO(QString("增量扫描: 新增 %1，更新 %2，删除 %3")
+                 .arg(m_addedCount).arg(m_updatedCount).arg(removedKeys.size()));
+    }
+}
+
+int AppScanner::removeRow(const QString& registryKey) {
+    const int row = m_rowByKey.take(registryKey);
+    const int lastRow = static_cast<int>(m_applications.size()) - 1;
+    if (row != lastRow) {
+        m_applications[row] = std::move(m_applications[lastRow]);
+        m_rowByKey[m_applications[row].registryKey()] = row;
+    }
+    m_applications.removeLast();
+    m_searchIndex.remove(registryKey);
+    return row;
+}
+
+void AppScanner::refreshSizes(const QStringList& registryKeys) {
+    QList<QPair<QString, QString>> targets;
+    {
+        QMutexLocker locker(&m_mutex);
+        for (const QString& key : registryKeys) {
+            auto it = m_rowByKey.constFind(key);
+            if (it != m_rowByKey.constEnd() && !m_applications[it.value()].installLocation.isEmpty()) {
+                targets.append(qMakePair(key, m_applications[it.value()].installLocation));
+            }
+        }
+    }
+    
+    calculateSizes(targets);
+}
+
+void AppScanner::startSizeCalculation(bool onlyMissing) {
+    QList<QPair<QString, QString>> targets;
+    {
+        QMutexLocker locker(&m_mutex);
+        targets.reserve(m_applications.size());
+        for (const ApplicationInfo& appInfo : m_applications) {
+            if (appInfo.installLocation.isEmpty() || (onlyMissing && appInfo.allocatedSize >= 0)) {
+                continue;
+            }
+            targets.append(qMakePair(appInfo.registryKey(), appInfo.installLocation));
+        }
+    }
+    
+    calculateSizes(targets);
+}
+
+void AppScanner::calculateSizes(const QList<QPair<QString, QString>>& targets) {
+    if (targets.isEmpty()) {
+        return;
+    }
+    
+    // 计算进行中时排队，避免打断正在进行的批次
+    if (m_sizeEngine->isRunning()) {
+        m_pendingSizeTargets.append(targets);
+        return;
+    }
+    
+    m_sizeEngine->calculate(targets);
+}
+
+void AppScanner::onSizeCalculated(const QString& registryKey, qint64 logicalBytes, qint64 allocatedBytes) {
+    ApplicationInfo appInfo;
+    {
+        QMutexLocker locker(&m_mutex);
+        auto it = m_rowByKey.constFind(registryKey);
+        if (it == m_rowByKey.constEnd()) {
+            return;
+        }
+        
+        ApplicationInfo& stored = m_applications[it.value()];
+        if (stored.diskSize == logicalBytes && stored.allocatedSize == allocatedBytes) {
+            return;
+        }
+        stored.diskSize = logicalBytes;
+        stored.allocatedSize = allocatedBytes;
+        appInfo = stored;
+    }
+    
+    emit applicationUpdated(appInfo);
+}
+
+void AppScanner::onSizeCalculationFinished() {
+    if (!m_pendingSizeTargets.isEmpty()) {
+        const QList<QPair<QString, QString>> targets = std::move(m_pendingSizeTargets);
+        m_pendingSizeTargets.clear();
+        m_sizeEngine->calculate(targets);
+        return;
+    }
+    
+    if (m_isScanning) {
+        return;
+    }
+    
+    // 将计算出的目录占用写入快照，下次启动即可直接显示
+    saveSnapshot();
+}
+
+void AppScanner::saveSnapshot() {
+    QList<ApplicationInfo> catalog;
+    QHash<QString, quint64> fingerprints;
+    {
+        QMutexLocker locker(&m_mutex);
+        catalog = m_applications;
+        fingerprints = m_fingerprints;
+    }
+    
+    // 单线程池按请求顺序写入，最后写入的总是最新的目录
+    const quint64 generation = ++m_snapshotGeneration;
+    m_snapshotPool.start([this, catalog, fingerprints, generation]() {
+        if (generation != m_snapshotGeneration.load()) {
+            return;
+        }
+        CatalogSnapshot snapshot(CatalogSnapshot::defaultPath());
+        if (!snapshot.save(catalog, fingerprints)) {
+            LOG_WARNING("保存应用快照失败");
+        }
+    });
 }
 
 QList<ApplicationInfo> AppScanner::getApplications() const {
@@ -91,129 +496,235 @@ QList<ApplicationInfo> AppScanner::searchApplications(const QString& keyword) co
     QMutexLocker locker(&m_mutex);
     QList<ApplicationInfo> results;
     
-    QString lowerKeyword = keyword.toLower();
-    
-    for (const ApplicationInfo& app : m_applications) {
-        if (app.displayName.toLower().contains(lowerKeyword) ||
-            app.name.toLower().contains(lowerKeyword) ||
-            app.publisher.toLower().contains(lowerKeyword)) {
-            results.append(app);
+    const QStringList keys = m_searchIndex.search(keyword);
+    results.reserve(keys.size());
+    for (const QString& key : keys) {
+        auto it = m_rowByKey.constFind(key);
+        if (it != m_rowByKey.constEnd()) {
+            results.append(m_applications[it.value()]);
         }
     }
     
     return results;
 }
 
+QStringList AppScanner::searchKeys(const QString& keyword) const {
+    QMutexLocker locker(&m_mutex);
+    return m_searchIndex.search(keyword);
+}
+
+quint64 AppScanner::searchRevision() const {
+    return m_searchRevision;
+}
+
+int AppScanner::applicationCount() const {
+    return static_cast<int>(m_applications.size());
+}
+
+const ApplicationInfo& AppScanner::applicationAt(int row) const {
+    return m_applications[row];
+}
+
+int AppScanner::rowOf(const QString& registryKey) const {
+    return m_rowByKey.value(registryKey, -1);
+}
+
+void AppScanner::reindexRows() {
+    m_rowByKey.clear();
+    m_rowByKey.reserve(m_applications.size());
+    for (int row = 0; row < m_applications.size(); ++row) {
+        m_rowByKey.insert(m_applications[row].registryKey(), row);
+    }
+}
+
 void AppScanner::refreshApplications() {
     stopScan();
-    startScan();
+    
+    bool hasFingerprints;
+    {
+        QMutexLocker locker(&m_mutex);
+        hasFingerprints = !m_fingerprints.isEmpty();
+    }
+    
+    // 没有上一次扫描的指纹时只能完整扫描
+    beginScan(hasFingerprints);
+}
+
+bool AppScanner::loadSnapshot() {
+    if (m_isScanning) {
+        return false;
+    }
+    
+    QList<ApplicationInfo> applications;
+    QHash<QString, quint64> fingerprints;
+    CatalogSnapshot snapshot(CatalogSnapshot::defaultPath());
+    if (!snapshot.load(applications, fingerprints)) {
+        return false;
+    }
+    
+    // 快照中的发布商重新驻留，恢复共享存储
+    for (ApplicationInfo& appInfo : applications) {
+        appInfo.publisher = m_publisherPool.intern(appInfo.publisher);
+    }
+    
+    {
+        QMutexLocker locker(&m_mutex);
+        m_applications = applications;
+        m_fingerprints = fingerprints;
+        reindexRows();
+        
+        m_searchIndex.clear();
+        for (const ApplicationInfo& appInfo : applications) {
+            m_searchIndex.insert(appInfo.registryKey(), appInfo.name, appInfo.publisher);
+        }
+    }
+    
+    ++m_searchRevision;
+    emit applicationsCleared();
+    
+    LOG_INFO(QString("从快照加载 %1 个应用程序").arg(applications.size()));
+    emit catalogChanged();
+    return true;
+}
+
+void AppScanner::setBatchDelivery(int batchSize, int intervalMs) {
+    m_batchSize = qMax(0, batchSize);
+    m_batchIntervalMs = qMax(1, intervalMs);
+}
+
+void AppScanner::setRegistryBackend(std::shared_ptr<RegistryBackend> backend) {
+    if (backend) {
+        m_registry = std::move(backend);
+    }
+}
+
+std::shared_ptr<RegistryBackend> AppScanner::registryBackend() const {
+    return m_registry;
 }
 
 bool AppScanner::isScanning() const {
     return m_isScanning;
 }
 
-QString AppScanner::formatSize(qint64 bytes) const {
-    if (bytes < 1024) {
-        return QString("%1 B").arg(bytes);
-    } else if (bytes < 1024 * 1024) {
-        return QString("%1 KB").arg(bytes / 1024);
-    } else if (bytes < 1024 * 1024 * 1024) {
-        return QString("%1 MB").arg(bytes / (1024 * 1024));
-    } else {
-        return QString("%1 GB").arg(bytes / (1024 * 1024 * 1024));
+quint32 AppScanner::parseInstallDate(const QString& dateStr) const {
+    // 常见为YYYYMMDD，少数安装程序写入带分隔符的日期
+    static const char* const formats[] = {"yyyyMMdd", "yyyy-MM-dd", "yyyy/M/d", "M/d/yyyy"};
+    
+    QString trimmed = dateStr.trimmed();
+    if (trimmed.isEmpty()) {
+        return 0;
+    }
+    
+    for (const char* format : formats) {
+        QDate date = QDate::fromString(trimmed, QLatin1String(format));
+        if (date.isValid()) {
+            return static_cast<quint32>(date.year() * 10000 + date.month() * 100 + date.day());
+        }
     }
+    return 0;
 }
 
-QString AppScanner::parseInstallDate(const QString& dateStr) const {
-    if (dateStr.length() == 8) {
-        // YYYYMMDD格式
-        QString year = dateStr.mid(0, 4);
-        QString month = dateStr.mid(4, 2);
-        QString day = dateStr.mid(6, 2);
-        return QString("%1-%2-%3").arg(year, month, day);
+ApplicationInfo AppScanner::parseRegistryEntry(const RegistryEntry& entry, int hive) const {
+    const QVariantHash& values = entry.values;
+    
+    ApplicationInfo appInfo;
+    appInfo.name = values.value("DisplayName").toString();
+    appInfo.version = values.value("DisplayVersion").toString();
+    appInfo.publisher = m_publisherPool.intern(values.value("Publisher").toString());
+    appInfo.installDate = parseInstallDate(values.value("InstallDate").toString());
+    appInfo.installLocation = values.value("InstallLocation").toString();
+    appInfo.uninstallString = values.value("UninstallString").toString();
+    appInfo.subKey = entry.subKey;
+    appInfo.hive = static_cast<quint8>(hive);
+    
+    // 估算大小以KB为单位
+    QVariant sizeVar = values.value("EstimatedSize");
+    if (sizeVar.isValid()) {
+        appInfo.estimatedSize = sizeVar.toLongLong() * 1024;
     }
-    return dateStr;
+    
+    return appInfo;
 }
 
 // ScanWorker实现
 ScanWorker::ScanWorker(AppScanner* scanner)
     : m_scanner(scanner)
+    , m_lastProgressMs(0)
 {
 }
 
 void ScanWorker::doWork() {
     try {
-        QStringList registryKeys = {
-            "HKEY_LOCAL_MACHINE\\SOFTWARE\\Microsoft\\Windows\\CurrentVersion\\Uninstall",
-            "HKEY_LOCAL_MACHINE\\SOFTWARE\\WOW6432Node\\Microsoft\\Windows\\CurrentVersion\\Uninstall",
-            "HKEY_CURRENT_USER\\SOFTWARE\\Microsoft\\Windows\\CurrentVersion\\Uninstall"
-        };
+        const QStringList& registryKeys = ApplicationInfo::hivePaths();
         
-        int totalProcessed = 0;
-        int totalKeys = 0;
+        // 上一次扫描的指纹，完整扫描时为空
+        QHash<QString, quint64> previous;
+        {
+            QMutexLocker locker(&m_scanner->m_mutex);
+            previous = m_scanner->m_fingerprints;
+        }
+        
+        // 扫描期间持有注册表实现，即使中途被替换也不受影响
+        const std::shared_ptr<RegistryBackend> registry = m_scanner->m_registry;
+        registry->refresh();
+        const AppScanner::ScanScope scope = m_scanner->m_scanScope;
         
-        // 首先计算总数
-        for (const QString& keyPath : registryKeys) {
-            QSettings registry(keyPath, QSettings::NativeFormat);
-            totalKeys += registry.childGroups().size();
+        QList<ScanTask> tasks;
+        QSet<QString> vanished;   // 局部对账中发现已被删除的子键
+        if (scope.all) {
+            // 单次枚举所有根路径的子键，总数直接来自这一遍枚举
+            for (int hive = 0; hive < registryKeys.size(); ++hive) {
+                const QStringList subKeys = registry->childKeys(registryKeys[hive]);
+                for (const QString& subKey : subKeys) {
+                    tasks.append({hive, subKey});
+                }
+            }
+        } else {
+            collectScopedTasks(*registry, scope, previous, tasks, vanished);
         }
         
+        const int totalKeys = tasks.size();
+        m_progressTimer.start();
         emit progress(0, totalKeys);
         
-        SafetyChecker& safety = SafetyChecker::instance();
+        // 按连续区间分片，每个分片在线程池中独立解析，解析出的应用随时成批投递
+        const int shardCount = qBound(1, QThread::idealThreadCount(), qMax(1, totalKeys));
+        const int shardSize = (totalKeys + shardCount - 1) / shardCount;
+        QVector<ShardResult> shardResults(shardCount);
+        std::atomic<int> processed(0);
         
-        for (const QString& keyPath : registryKeys) {
-            QSettings registry(keyPath, QSettings::NativeFormat);
-            QStringList subKeys = registry.childGroups();
-            
-            for (const QString& subKey : subKeys) {
-                if (m_scanner->m_shouldStop) {
-                    break;
-                }
-                
-                registry.beginGroup(subKey);
-                
-                ApplicationInfo appInfo;
-                appInfo.name = registry.value("DisplayName").toString();
-                appInfo.displayName = appInfo.name;
-                appInfo.version = registry.value("DisplayVersion").toString();
-                appInfo.publisher = registry.value("Publisher").toString();
-                appInfo.installDate = m_scanner->parseInstallDate(registry.value("InstallDate").toString());
-                appInfo.installLocation = registry.value("InstallLocation").toString();
-                appInfo.uninstallString = registry.value("UninstallString").toString();
-                appInfo.registryKey = keyPath + "\\" + subKey;
-                
-                // 处理估算大小
-                QVariant sizeVar = registry.value("EstimatedSize");
-                if (sizeVar.isValid()) {
-                    qint64 sizeKB = sizeVar.toLongLong();
-                    appInfo.estimatedSize = m_scanner->formatSize(sizeKB * 1024);
-                } else {
-                    appInfo.estimatedSize = "未知";
-                }
-                
-                registry.endGroup();
-                
-                // 检查是否为有效应用
-                if (!appInfo.name.isEmpty() && !appInfo.uninstallString.isEmpty()) {
-                    // 检查是否为系统应用
-                    appInfo.isSystemApp = safety.isSystemApplication(appInfo.name, appInfo.publisher);
-                    appInfo.canUninstall = !appInfo.isSystemApp;
-                    
-                    QMutexLocker locker(&m_scanner->m_mutex);
-                    m_scanner->m_applications.append(appInfo);
-                    
-                    emit applicationFound(appInfo);
+        QThreadPool pool;
+        pool.setMaxThreadCount(shardCount);
+        for (int shard = 0; shard < shardCount; ++shard) {
+            const int begin = shard * shardSize;
+            const int end = qMin(totalKeys, begin + shardSize);
+            if (begin >= end) {
+                break;
+            }
+            ShardResult& result = shardResults[shard];
+            pool.start([this, &registry, &tasks, begin, end, &previous, &result, &processed, totalKeys]() {
+                scanShard(*registry, tasks, begin, end, previous, result, processed, totalKeys);
+            });
+        }
+        pool.waitForDone();
+        emit progress(processed, totalKeys);
+        
+        if (!m_scanner->m_shouldStop) {
+            // 各分片的指纹和无效键汇总后一次性对账，得出被删除的应用；
+            // 局部对账时范围之外的子键沿用上次的指纹
+            QHash<QString, quint64> fingerprints;
+            if (!scope.all) {
+                fingerprints = previous;
+                for (const QString& key : std::as_const(vanished)) {
+                    fingerprints.remove(key);
                 }
-                
-                totalProcessed++;
-                emit progress(totalProcessed, totalKeys);
             }
-            
-            if (m_scanner->m_shouldStop) {
-                break;
+            QStringList invalidKeys;
+            for (const ShardResult& result : shardResults) {
+                fingerprints.insert(result.fingerprints);
+                invalidKeys.append(result.invalidKeys);
             }
+            emit completed(fingerprints, invalidKeys);
         }
         
     } catch (const std::exception& e) {
@@ -225,4 +736,134 @@ void ScanWorker::doWork() {
     emit finished();
 }
 
+void ScanWorker::collectScopedTasks(const RegistryBackend& registry, const AppScanner::ScanScope& scope,
+                                    const QHash<QString, quint64>& previous, QList<ScanTask>& tasks,
+                                    QSet<QString>& vanished) {
+    const QStringList& hivePaths = ApplicationInfo::hivePaths();
+    QSet<QString> queued;
+    
+    // 重新枚举的根路径只解析新出现的子键，已有子键是否变化由其自身的通知决定
+    for (int hive : scope.hives) {
+        if (hive < 0 || hive >= hivePaths.size()) {
+            continue;
+        }
+        const QString prefix = hivePaths[hive] + "\\";
+        QSet<QString> present;
+        for (const QString& subKey : registry.childKeys(hivePaths[hive])) {
+            const QString key = prefix + subKey;
+            present.insert(key);
+            if (!previous.contains(key) && !queued.contains(key)) {
+                queued.insert(key);
+                tasks.append({hive, subKey});
+            }
+        }
+        for (auto it = previous.constBegin(); it != previous.constEnd(); ++it) {
+            if (it.key().startsWith(prefix) && !present.contains(it.key())) {
+                vanished.insert(it.key());
+            }
+        }
+    }
+    
+    for (const QString& key : scope.registryKeys) {
+        if (queued.contains(key) || vanished.contains(key)) {
+            continue;
+        }
+        for (int hive = 0; hive < hivePaths.size(); ++hive) {
+            const QString prefix = hivePaths[hive] + "\\";
+            if (key.startsWith(prefix) && key.indexOf(QLatin1Char('\\'), prefix.size()) < 0) {
+                queued.insert(key);
+                tasks.append({hive, key.mid(prefix.size())});
+                break;
+            }
+        }
+    }
+}
+
+void ScanWorker::scanShard(const RegistryBackend& registry, const QList<ScanTask>& tasks,
+                           int begin, int end, const QHash<QString, quint64>& previous,
+                           ShardResult& result, std::atomic<int>& processed, int totalKeys) {
+    const QStringList& hivePaths = ApplicationInfo::hivePaths();
+    
+    // 本分片待投递的应用：攒够一批或距上次投递超过间隔即发送，首批结果不必等整个扫描结束
+    const int batchSize = qMax(1, m_scanner->m_batchSize);
+    const int intervalMs = m_scanner->m_batchIntervalMs;
+    QList<ApplicationInfo> batch;
+    QElapsedTimer batchTimer;
+    batchTimer.start();
+    
+    for (int i = begin; i < end; ++i) {
+        if (m_scanner->m_shouldStop) {
+            return;
+        }
+        
+        const ScanTask& task = tasks[i];
+        const QString& keyPath = hivePaths[task.hiveIndex];
+        const QString registryKey = keyPath + "\\" + task.subKey;
+        
+        // 上次扫描过的子键先只比较指纹，未变化的无需读取任何值
+        auto previousIt = previous.constFind(registryKey);
+        if (previousIt != previous.constEnd()) {
+            const quint64 fingerprint = registry.fingerprint(keyPath, task.subKey);
+            if (fingerprint != 0 && previousIt.value() == fingerprint) {
+                result.fingerprints.insert(registryKey, fingerprint);
+                reportProgress(++processed, totalKeys);
+                continue;
+            }
+        }
+        
+        // 一次读取子键的全部值
+        RegistryEntry entry;
+        if (!registry.readEntry(keyPath, task.subKey, entry)) {
+            result.fingerprints.insert(registryKey, 0);
+            result.invalidKeys.append(registryKey);
+            reportProgress(++processed, totalKeys);
+            continue;
+        }
+        result.fingerprints.insert(registryKey, entry.fingerprint);
+        
+        ApplicationInfo appInfo = m_scanner->parseRegistryEntry(entry, task.hiveIndex);
+        
+        // 检查是否为有效应用
+        if (!appInfo.name.isEmpty() && !appInfo.uninstallString.isEmpty()) {
+            batch.append(appInfo);
+        } else {
+            result.invalidKeys.append(registryKey);
+        }
+        
+        reportProgress(++processed, totalKeys);
+        
+        if (batch.size() >= batchSize || (!batch.isEmpty() && batchTimer.elapsed() >= intervalMs)) {
+            publish(batch);
+            batchTimer.restart();
+        }
+    }
+    
+    publish(batch);
+}
+
+void ScanWorker::publish(QList<ApplicationInfo>& batch) {
+    if (batch.isEmpty()) {
+        return;
+    }
+    
+    // 整批判断系统应用
+    const QVector<bool> systemApps = SafetyChecker::instance().classifySystemApplications(batch, false);
+    for (int i = 0; i < batch.size(); ++i) {
+        batch[i].setFlag(ApplicationInfo::SystemApp, systemApps[i]);
+        batch[i].setFlag(ApplicationInfo::CanUninstall, !systemApps[i]);
+    }
+    
+    emit parsed(batch);
+    batch.clear();
+}
+
+void ScanWorker::reportProgress(int current, int total) {
+    // 多个分片线程共享同一时间戳，整体按固定频率发送进度
+    qint64 now = m_progressTimer.elapsed();
+    qint64 last = m_lastProgressMs.load();
+    if (now - last >= kProgressIntervalMs && m_lastProgressMs.compare_exchange_strong(last, now)) {
+        emit progress(current, total);
+    }
+}
+
 #include "AppScanner.moc"
@@ -5,22 +5,60 @@
 #include <QObject>
 #include <QThread>
 #include <QMutex>
+#include <QHash>
+#include <QSet>
+#include <QElapsedTimer>
 #include <QDateTime>
+#include <QThreadPool>
+#include "StringPool.h"
+#include "SearchIndex.h"
+#include "SizeEngine.h"
+#include "RegistryBackend.h"
+#include <atomic>
+#include <memory>
 
+class ScanWorker;
+
+// 紧凑的应用信息：数值字段保持原始类型，显示文本在渲染时按需生成
 struct ApplicationInfo {
+    enum Flag : quint8 {
+        SystemApp = 0x01,
+        CanUninstall = 0x02
+    };
+    
     QString name;
-    QString displayName;
     QString version;
-    QString publisher;
-    QString installDate;
+    QString publisher;        // 驻留字符串，相同发布商共享存储
     QString installLocation;
     QString uninstallString;
-    QString estimatedSize;
-    QString registryKey;
-    bool isSystemApp;
-    bool canUninstall;
+    QString subKey;           // Uninstall下的子键名
+    qint64 estimatedSize;     // 注册表EstimatedSize，字节数，-1表示未知
+    qint64 diskSize;          // 安装目录实际文件大小，-1表示尚未计算
+    qint64 allocatedSize;     // 安装目录实际占用的磁盘空间，-1表示尚未计算
+    quint32 installDate;      // 打包为YYYYMMDD，0表示未知
+    quint8 hive;              // 所属根路径在hivePaths()中的下标
+    quint8 flags;
+    
+    ApplicationInfo() : estimatedSize(-1), diskSize(-1), allocatedSize(-1), installDate(0), hive(0), flags(CanUninstall) {}
+    
+    bool testFlag(Flag flag) const { return (flags & flag) != 0; }
+    void setFlag(Flag flag, bool on) { flags = static_cast<quint8>(on ? (flags | flag) : (flags & ~flag)); }
+    bool isSystemApp() const { return testFlag(SystemApp); }
+    bool canUninstall() const { return testFlag(CanUninstall); }
+    
+    // 磁盘占用：优先使用实测的分配大小，其次是注册表估计值
+    qint64 footprint() const { return allocatedSize >= 0 ? allocatedSize : estimatedSize; }
     
-    ApplicationInfo() : isSystemApp(false), canUninstall(true) {}
+    // 完整注册表键路径
+    QString registryKey() const;
+    
+    // 显示用文本
+    QString sizeText() const;
+    QString installDateText() const;
+    
+    // 扫描的卸载信息根路径
+    static const QStringList& hivePaths();
+    static QString formatSize(qint64 bytes);
 };
 
 class AppScanner : public QObject {
@@ -30,7 +68,7 @@ public:
     explicit AppScanner(QObject* parent = nullptr);
     ~AppScanner();
     
-    // 开始扫描已安装应用
+    // 开始扫描已安装应用（清空现有列表后完整扫描）
     void startScan();
     
     // 停止扫描
@@ -39,37 +77,128 @@ public:
     // 获取应用列表
     QList<ApplicationInfo> getApplications() const;
     
-    // 根据名称搜索应用
+    // 根据名称或发布商搜索应用，结果按相关度排序
     QList<ApplicationInfo> searchApplications(const QString& keyword) const;
     
-    // 刷新应用列表
+    // 同上，只返回按相关度排序的注册表键，可在任意线程调用
+    QStringList searchKeys(const QString& keyword) const;
+    
+    // 搜索修订号：新增应用或名称、发布商变化时递增，此前的查询结果不再完整
+    quint64 searchRevision() const;
+    
+    // 按行直接访问目录，只能在本对象所在线程调用（目录只在该线程中修改）。
+    // 新应用追加在末尾；删除时以最后一行填补空位，applicationRemoved给出该行号
+    int applicationCount() const;
+    const ApplicationInfo& applicationAt(int row) const;
+    int rowOf(const QString& registryKey) const;   // 不在目录中时为-1
+    
+    // 刷新应用列表（仅重新解析新增、删除或变更的子键）
     void refreshApplications();
     
+    // 后台静默对账：只重新解析变化的子键，不发送scanStarted/scanFinished和进度，
+    // 扫描进行中调用时在本次扫描结束后执行
+    void reconcile();
+    
+    // 只对账指定范围：registryKeys逐个比较指纹，变化的重新解析；hives（hivePaths()的下标）
+    // 重新枚举子键以发现新增和删除的子键，其余子键不访问。扫描进行中调用时合并到本次扫描结束后执行
+    void reconcileKeys(const QStringList& registryKeys, const QList<int>& hives = QList<int>());
+    
+    // 上次扫描记录的全部子键（含无效条目）
+    QStringList knownRegistryKeys() const;
+    
+    // 重新计算指定应用的目录占用
+    void refreshSizes(const QStringList& registryKeys);
+    
+    // 从磁盘快照加载上一次的扫描结果，随后的刷新会在后台与注册表对账
+    bool loadSnapshot();
+    
+    // 设置批量投递：扫描中每个分片每解析出batchSize条或每隔intervalMs毫秒
+    // 即通过applicationsFound发送一批，batchSize为0时逐条发送applicationFound
+    void setBatchDelivery(int batchSize, int intervalMs = 16);
+    
+    // 替换注册表访问实现（默认为RegistryBackend::defaultBackend()），须在扫描开始前设置
+    void setRegistryBackend(std::shared_ptr<RegistryBackend> backend);
+    std::shared_ptr<RegistryBackend> registryBackend() const;
+    
     // 检查是否正在扫描
     bool isScanning() const;
 
 signals:
     void scanStarted();
     void scanFinished();
+    void applicationsCleared();   // 目录被整体替换（开始完整扫描或加载快照）
     void applicationFound(const ApplicationInfo& appInfo);
+    void applicationsFound(const QList<ApplicationInfo>& batch);
+    void applicationUpdated(const ApplicationInfo& appInfo);
+    void applicationRemoved(const QString& registryKey, int row);
     void scanProgress(int current, int total);
     void scanError(const QString& error);
+    
+    // 应用列表发生变化（扫描、对账或加载快照完成）
+    void catalogChanged();
 
 private slots:
     void onScanFinished();
+    void onSizeCalculated(const QString& registryKey, qint64 logicalBytes, qint64 allocatedBytes);
+    void onSizeCalculationFinished();
 
 private:
+    friend class ScanWorker;
+    
+    // 扫描范围：all为false时只处理列出的子键和根路径
+    struct ScanScope {
+        bool all = true;
+        QStringList registryKeys;
+        QList<int> hives;
+    };
+    
+    void beginScan(bool incremental, bool silent = false, const ScanScope& scope = ScanScope());
+    
+    // 在本线程中合并工作线程解析出的一批应用，并通知新增和更新
+    void mergeParsed(const QList<ApplicationInfo>& parsed);
+    
+    // 扫描完成：按全部子键的最新指纹移除已不存在的应用并更新快照
+    void completeScan(const QHash<QString, quint64>& fingerprints, const QStringList& invalidKeys);
+    
+    // 在后台写入当前目录的磁盘快照。写入依次进行，排队期间有更新的请求时旧的请求直接跳过
+    void saveSnapshot();
+    
+    // 删除一行并以最后一行填补，返回被删除的行号（调用方持有m_mutex）
+    int removeRow(const QString& registryKey);
+    void reindexRows();
     void scanRegistry();
     void scanRegistryKey(const QString& keyPath);
-    ApplicationInfo parseRegistryEntry(const QString& keyPath, const QString& subKey);
-    QString formatSize(qint64 bytes) const;
-    QString parseInstallDate(const QString& dateStr) const;
+    ApplicationInfo parseRegistryEntry(const RegistryEntry& entry, int hive) const;
+    quint32 parseInstallDate(const QString& dateStr) const;
+    void startSizeCalculation(bool onlyMissing);
+    void calculateSizes(const QList<QPair<QString, QString>>& targets);
     
     QThread* m_scanThread;
-    QMutex m_mutex;
+    ScanWorker* m_scanWorker;
+    std::shared_ptr<RegistryBackend> m_registry;
+    SizeEngine* m_sizeEngine;
+    QList<QPair<QString, QString>> m_pendingSizeTargets; // 占用计算进行中时排队的目录
+    mutable QMutex m_mutex;
     QList<ApplicationInfo> m_applications;
+    QHash<QString, quint64> m_fingerprints; // 注册表键 -> 子键指纹（含无效条目）
+    QHash<QString, int> m_rowByKey;          // 注册表键 -> m_applications中的行
+    SearchIndex m_searchIndex;
+    quint64 m_searchRevision;   // 只在本对象所在线程中访问
+    mutable StringPool m_publisherPool;
+    int m_batchSize;
+    int m_batchIntervalMs;
     bool m_isScanning;
-    bool m_shouldStop;
+    bool m_isSilentScan;
+    bool m_reconcilePending;
+    QSet<QString> m_pendingReconcileKeys;   // 扫描进行中请求的局部对账
+    QSet<int> m_pendingReconcileHives;
+    ScanScope m_scanScope;                  // 本次扫描的范围，工作线程开始时读取
+    quint64 m_scanGeneration;   // 每次开始或停止扫描时递增，旧扫描的结果不再合并
+    int m_addedCount;           // 本次扫描新增和更新的应用数
+    int m_updatedCount;
+    std::atomic<bool> m_shouldStop;
+    std::atomic<quint64> m_snapshotGeneration;  // 最近一次请求保存快照的代号
+    QThreadPool m_snapshotPool;  // 单线程，快照依次写入；析构时等待写完，须在最后声明
 };
 
 class ScanWorker : public QObject {
@@ -77,16 +206,49 @@ class ScanWorker : public QObject {
 
 public:
     explicit ScanWorker(AppScanner* scanner);
-    
+
 public slots:
     void doWork();
-    
+
 signals:
     void finished();
-    void applicationFound(const ApplicationInfo& appInfo);
+    
+    // 一批新增或变更的有效应用，在分片线程中解析出后立即发送
+    void parsed(const QList<ApplicationInfo>& batch);
+    
+    // 全部子键处理完毕：所有子键的最新指纹和不再是有效应用的键
+    void completed(const QHash<QString, quint64>& fingerprints, const QStringList& invalidKeys);
+    
     void progress(int current, int total);
     void error(const QString& error);
-    
+
 private:
+    // 单个扫描任务：所属注册表根路径及其子键名
+    struct ScanTask {
+        int hiveIndex;
+        QString subKey;
+    };
+    
+    // 单个分片的扫描结果（有效应用已随解析成批投递）
+    struct ShardResult {
+        QStringList invalidKeys;               // 变更后不再是有效应用的键
+        QHash<QString, quint64> fingerprints;  // 本分片所有子键的最新指纹
+    };
+    
+    // 局部对账的任务：指定的子键，以及重新枚举的根路径下新出现的子键
+    void collectScopedTasks(const RegistryBackend& registry, const AppScanner::ScanScope& scope,
+                            const QHash<QString, quint64>& previous, QList<ScanTask>& tasks,
+                            QSet<QString>& vanished);
+    
+    void scanShard(const RegistryBackend& registry, const QList<ScanTask>& tasks,
+                   int begin, int end, const QHash<QString, quint64>& previous,
+                   ShardResult& result, std::atomic<int>& processed, int totalKeys);
+    void reportProgress(int current, int total);
+    
+    // 判断系统应用后发送一批，并清空batch
+    void publish(QList<ApplicationInfo>& batch);
+    
     AppScanner* m_scanner;
+    QElapsedTimer m_progressTimer;
+    std::atomic<qint64> m_lastProgressMs;
 };
@@ -0,0 +1,433 @@
+#include "ApplicationTableModel.h"
+#include <QBrush>
+#include <QColor>
+#include <algorithm>
+
+ApplicationTableModel::ApplicationTableModel(AppScanner* scanner, QObject* parent)
+    : QAbstractTableModel(parent)
+    , m_scanner(scanner)
+    , m_filterRevision(0)
+    , m_sortColumn(-1)
+    , m_sortOrder(Qt::AscendingOrder)
+{
+    connect(scanner, &AppScanner::applicationsCleared, this, &ApplicationTableModel::onApplicationsCleared);
+    connect(scanner, &AppScanner::applicationFound, this, &ApplicationTableModel::onApplicationsAppended);
+    connect(scanner, &AppScanner::applicationsFound, this, &ApplicationTableModel::onApplicationsAppended);
+    connect(scanner, &AppScanner::applicationUpdated, this, &ApplicationTableModel::onApplicationUpdated);
+    connect(scanner, &AppScanner::applicationRemoved, this, &ApplicationTableModel::onApplicationRemoved);
+    
+    onApplicationsCleared();
+}
+
+int ApplicationTableModel::rowCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : static_cast<int>(m_rows.size());
+}
+
+int ApplicationTableModel::columnCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant ApplicationTableModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid() || index.row() >= m_rows.size()) {
+        return QVariant();
+    }
+    
+    const int catalogRow = m_rows[index.row()];
+    const ApplicationInfo& appInfo = m_scanner->applicationAt(catalogRow);
+    
+    switch (role) {
+    case Qt::CheckStateRole:
+        if (index.column() == ColumnCheckBox) {
+            return static_cast<int>(m_checked[catalogRow] ? Qt::Checked : Qt::Unchecked);
+        }
+        break;
+        
+    case Qt::DisplayRole:
+        switch (index.column()) {
+        case ColumnName: return appInfo.name;
+        case ColumnVersion: return appInfo.version;
+        case ColumnPublisher: return appInfo.publisher;
+        case ColumnSize: return appInfo.sizeText();
+        case ColumnInstallDate: return appInfo.installDateText();
+        case ColumnLocation: return appInfo.installLocation;
+        default: break;
+        }
+        break;
+        
+    case Qt::ForegroundRole:
+        if (index.column() == ColumnName && appInfo.isSystemApp()) {
+            return QBrush(QColor(255, 87, 34)); // 橙色表示系统应用
+        }
+        break;
+        
+    case Qt::ToolTipRole:
+        if (index.column() == ColumnName && appInfo.isSystemApp()) {
+            return QString("系统关键应用，建议不要卸载");
+        }
+        break;
+        
+    default:
+        break;
+    }
+    
+    return QVariant();
+}
+
+bool ApplicationTableModel::setData(const QModelIndex& index, const QVariant& value, int role) {
+    if (!index.isValid() || index.column() != ColumnCheckBox || role != Qt::CheckStateRole) {
+        return false;
+    }
+    
+    m_checked[m_rows[index.row()]] = value.toInt() == Qt::Checked;
+    emit dataChanged(index, index, {Qt::CheckStateRole});
+    
+    // 按勾选列排序时保持有序，之后插入的行才能二分查找位置
+    if (m_sortColumn == ColumnCheckBox) {
+        moveToSortedPosition(index.row());
+    }
+    emit checkedCountChanged(checkedCount());
+    return true;
+}
+
+Qt::ItemFlags ApplicationTableModel::flags(const QModelIndex& index) const {
+    if (!index.isValid()) {
+        return Qt::NoItemFlags;
+    }
+    if (index.column() == ColumnCheckBox) {
+        return Qt::ItemIsUserCheckable | Qt::ItemIsEnabled;
+    }
+    return Qt::ItemIsEnabled | Qt::ItemIsSelectable;
+}
+
+QVariant ApplicationTableModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return QVariant();
+    }
+    
+    static const QStringList headers = {
+        "选择", "应用名称", "版本", "发布商", "大小", "安装日期", "安装位置"
+    };
+    return headers.value(section);
+}
+
+bool ApplicationTableModel::lessThan(int leftRow, int rightRow) const {
+    const ApplicationInfo& left = m_scanner->applicationAt(leftRow);
+    const ApplicationInfo& right = m_scanner->applicationAt(rightRow);
+    
+    switch (m_sortColumn) {
+    case ColumnCheckBox: return m_checked[leftRow] < m_checked[rightRow];
+    case ColumnName: return left.name.compare(right.name, Qt::CaseInsensitive) < 0;
+    case ColumnVersion: return left.version.compare(right.version, Qt::CaseInsensitive) < 0;
+    case ColumnPublisher: return left.publisher.compare(right.publisher, Qt::CaseInsensitive) < 0;
+    case ColumnSize: return left.footprint() < right.footprint();
+    case ColumnInstallDate: return left.installDate < right.installDate;
+    case ColumnLocation: return left.installLocation.compare(right.installLocation, Qt::CaseInsensitive) < 0;
+    default: return false;
+    }
+}
+
+bool ApplicationTableModel::rowBefore(int leftRow, int rightRow) const {
+    return m_sortOrder == Qt::AscendingOrder ? lessThan(leftRow, rightRow) : lessThan(rightRow, leftRow);
+}
+
+void ApplicationTableModel::sortRows(QVector<int>& rows) const {
+    if (m_sortColumn < 0) {
+        return;
+    }
+    
+    std::stable_sort(rows.begin(), rows.end(), [this](int a, int b) { return rowBefore(a, b); });
+}
+
+void ApplicationTableModel::applyOrder(const QVector<int>& rows) {
+    emit layoutAboutToBeChanged({}, QAbstractItemModel::VerticalSortHint);
+    
+    const QVector<int> oldRows = m_rows;
+    m_rows = rows;
+    reindexVisibleRows(0);
+    
+    // 让选中项等持久索引跟随所在的应用移动
+    const QModelIndexList oldIndexes = persistentIndexList();
+    QModelIndexList newIndexes;
+    newIndexes.reserve(oldIndexes.size());
+    for (const QModelIndex& oldIndex : oldIndexes) {
+        const int newRow = m_visibleRowOf[oldRows[oldIndex.row()]];
+        newIndexes.append(index(newRow, oldIndex.column()));
+    }
+    changePersistentIndexList(oldIndexes, newIndexes);
+    
+    emit layoutChanged({}, QAbstractItemModel::VerticalSortHint);
+}
+
+void ApplicationTableModel::sort(int column, Qt::SortOrder order) {
+    m_sortColumn = column;
+    m_sortOrder = order;
+    
+    QVector<int> rows = m_rows;
+    sortRows(rows);
+    applyOrder(rows);
+}
+
+void ApplicationTableModel::reindexVisibleRows(int pos) {
+    for (int row = pos; row < static_cast<int>(m_rows.size()); ++row) {
+        m_visibleRowOf[m_rows[row]] = row;
+    }
+}
+
+void ApplicationTableModel::onApplicationsCleared() {
+    const int count = m_scanner->applicationCount();
+    m_checked.fill(false, count);
+    
+    QVector<int> rows;
+    if (!hasFilter()) {
+        rows.reserve(count);
+        for (int catalogRow = 0; catalogRow < count; ++catalogRow) {
+            rows.append(catalogRow);
+        }
+    }
+    resetRows(rows);
+    checkFilterRevision();
+}
+
+void ApplicationTableModel::onApplicationsAppended() {
+    const int first = static_cast<int>(m_checked.size());
+    const int count = m_scanner->applicationCount();
+    if (count <= first) {
+        return;
+    }
+    
+    m_checked.resize(count);
+    m_visibleRowOf.resize(count, -1);
+    
+    // 有过滤条件时新行是否匹配由重新查询决定
+    if (hasFilter()) {
+        checkFilterRevision();
+        return;
+    }
+    
+    QVector<int> visible;
+    visible.reserve(count - first);
+    for (int catalogRow = first; catalogRow < count; ++catalogRow) {
+        visible.append(catalogRow);
+    }
+    insertVisibleRows(visible);
+}
+
+void ApplicationTableModel::insertVisibleRows(QVector<int> catalogRows) {
+    if (catalogRows.isEmpty()) {
+        return;
+    }
+    
+    if (m_sortColumn < 0) {
+        const int first = static_cast<int>(m_rows.size());
+        beginInsertRows(QModelIndex(), first, first + static_cast<int>(catalogRows.size()) - 1);
+        m_rows.append(catalogRows);
+        endInsertRows();
+        reindexVisibleRows(first);
+        return;
+    }
+    
+    // 新行先排好序，再二分查找插入位置，落在同一位置的连续新行作为一段插入，
+    // 已有的行不重新排序，视图也不必重新布局
+    sortRows(catalogRows);
+    const auto before = [this](int a, int b) { return rowBefore(a, b); };
+    int firstPos = -1;
+    qsizetype next = 0;
+    while (next < catalogRows.size()) {
+        const int pos = static_cast<int>(
+            std::upper_bound(m_rows.cbegin(), m_rows.cend(), catalogRows[next], before) - m_rows.cbegin());
+        qsizetype end = next + 1;
+        while (end < catalogRows.size() && (pos == m_rows.size() || rowBefore(catalogRows[end], m_rows[pos]))) {
+            ++end;
+        }
+        
+        const int length = static_cast<int>(end - next);
+        beginInsertRows(QModelIndex(), pos, pos + length - 1);
+        m_rows.insert(pos, length, 0);
+        std::copy(catalogRows.cbegin() + next, catalogRows.cbegin() + end, m_rows.begin() + pos);
+        endInsertRows();
+        
+        if (firstPos < 0) {
+            firstPos = pos;
+        }
+        next = end;
+    }
+    reindexVisibleRows(firstPos);
+}
+
+void ApplicationTableModel::onApplicationUpdated(const ApplicationInfo& appInfo) {
+    const int catalogRow = m_scanner->rowOf(appInfo.registryKey());
+    if (catalogRow < 0 || catalogRow >= m_checked.size()) {
+        return;
+    }
+    
+    // 可见性保持不变，名称或发布商的变化由重新查询反映
+    int pos = m_visibleRowOf[catalogRow];
+    if (pos >= 0) {
+        pos = moveToSortedPosition(pos);
+        emit dataChanged(index(pos, 0), index(pos, ColumnCount - 1));
+    }
+    checkFilterRevision();
+}
+
+int ApplicationTableModel::moveToSortedPosition(int pos) {
+    if (m_sortColumn < 0) {
+        return pos;
+    }
+    
+    const int catalogRow = m_rows[pos];
+    const int count = static_cast<int>(m_rows.size());
+    const bool afterPrevious = pos == 0 || !rowBefore(catalogRow, m_rows[pos - 1]);
+    const bool beforeNext = pos + 1 == count || !rowBefore(m_rows[pos + 1], catalogRow);
+    if (afterPrevious && beforeNext) {
+        return pos;
+    }
+    
+    // 其余的行仍然有序，只在该行应去的一侧二分查找。
+    // destination为移动前的编号（beginMoveRows的约定），target为移动后该行所在位置
+    const auto before = [this](int a, int b) { return rowBefore(a, b); };
+    int destination;
+    int target;
+    if (!afterPrevious) {
+        destination = static_cast<int>(
+            std::upper_bound(m_rows.cbegin(), m_rows.cbegin() + pos, catalogRow, before) - m_rows.cbegin());
+        target = destination;
+    } else {
+        destination = static_cast<int>(
+            std::upper_bound(m_rows.cbegin() + pos + 1, m_rows.cend(), catalogRow, before) - m_rows.cbegin());
+        target = destination - 1;
+    }
+    
+    beginMoveRows(QModelIndex(), pos, pos, QModelIndex(), destination);
+    m_rows.remove(pos);
+    m_rows.insert(target, catalogRow);
+    for (int row = qMin(pos, target); row <= qMax(pos, target); ++row) {
+        m_visibleRowOf[m_rows[row]] = row;
+    }
+    endMoveRows();
+    return target;
+}
+
+void ApplicationTableModel::onApplicationRemoved(const QString& registryKey, int row) {
+    Q_UNUSED(registryKey);
+    if (row < 0 || row >= m_checked.size()) {
+        return;
+    }
+    
+    const int pos = m_visibleRowOf[row];
+    const bool wasChecked = m_checked[row];
+    
+    // 扫描器已用最后一行填补空位，勾选状态和指向最后一行的可见行随之移动
+    const int lastRow = static_cast<int>(m_checked.size()) - 1;
+    if (row != lastRow) {
+        const int movedPos = m_visibleRowOf[lastRow];
+        m_checked[row] = m_checked[lastRow];
+        m_visibleRowOf[row] = movedPos;
+        if (movedPos >= 0) {
+            m_rows[movedPos] = row;
+        }
+    }
+    m_checked.removeLast();
+    m_visibleRowOf.removeLast();
+    
+    if (pos >= 0) {
+        beginRemoveRows(QModelIndex(), pos, pos);
+        m_rows.remove(pos);
+        endRemoveRows();
+        reindexVisibleRows(pos);
+        
+        if (wasChecked) {
+            emit checkedCountChanged(checkedCount());
+        }
+    }
+}
+
+bool ApplicationTableModel::hasFilter() const {
+    return !m_filter.isEmpty();
+}
+
+void ApplicationTableModel::checkFilterRevision() {
+    if (hasFilter() && m_scanner->searchRevision() != m_filterRevision) {
+        emit filterInvalidated();
+    }
+}
+
+void ApplicationTableModel::setFilterResult(const QString& keyword, const QStringList& keys, quint64 searchRevision) {
+    m_filter = keyword.trimmed();
+    m_filterRevision = searchRevision;
+    
+    QVector<int> rows;
+    if (m_filter.isEmpty()) {
+        rows.reserve(m_checked.size());
+        for (int catalogRow = 0; catalogRow < static_cast<int>(m_checked.size()); ++catalogRow) {
+            rows.append(catalogRow);
+        }
+    } else {
+        // 查询之后被删除的应用已不在目录中，直接跳过
+        rows.reserve(keys.size());
+        for (const QString& key : keys) {
+            const int catalogRow = m_scanner->rowOf(key);
+            if (catalogRow >= 0 && catalogRow < m_checked.size()) {
+                rows.append(catalogRow);
+            }
+        }
+    }
+    resetRows(rows);
+    
+    // 查询期间目录已有变化时结果不完整，先显示再重新查询
+    checkFilterRevision();
+}
+
+void ApplicationTableModel::resetRows(QVector<int> rows) {
+    sortRows(rows);
+    
+    beginResetModel();
+    m_rows = rows;
+    m_visibleRowOf.fill(-1, m_checked.size());
+    reindexVisibleRows(0);
+    endResetModel();
+    
+    emit checkedCountChanged(checkedCount());
+}
+
+const ApplicationInfo& ApplicationTableModel::applicationAt(int row) const {
+    return m_scanner->applicationAt(m_rows[row]);
+}
+
+QList<ApplicationInfo> ApplicationTableModel::checkedApplications() const {
+    QList<ApplicationInfo> applications;
+    for (int catalogRow : m_rows) {
+        if (m_checked[catalogRow]) {
+            applications.append(m_scanner->applicationAt(catalogRow));
+        }
+    }
+    return applications;
+}
+
+int ApplicationTableModel::checkedCount() const {
+    int count = 0;
+    for (int catalogRow : m_rows) {
+        if (m_checked[catalogRow]) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+void ApplicationTableModel::setAllChecked(bool checked) {
+    if (m_rows.isEmpty()) {
+        return;
+    }
+    
+    for (int catalogRow : m_rows) {
+        m_checked[catalogRow] = checked;
+    }
+    
+    emit dataChanged(index(0, ColumnCheckBox),
+                     index(static_cast<int>(m_rows.size()) - 1, ColumnCheckBox),
+                     {Qt::CheckStateRole});
+    emit checkedCountChanged(checkedCount());
+}
+
+int ApplicationTableModel::catalogSize() const {
+    return static_cast<int>(m_checked.size());
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "AppScanner.h"
+#include <QAbstractTableModel>
+#include <QVector>
+
+// 应用列表模型：直接读取扫描器中的目录行，自身只保存勾选状态和可见行的映射，
+// 不为单元格创建任何对象，显示文本在渲染可见行时才生成
+class ApplicationTableModel : public QAbstractTableModel {
+    Q_OBJECT
+
+public:
+    enum Column {
+        ColumnCheckBox = 0,
+        ColumnName = 1,
+        ColumnVersion = 2,
+        ColumnPublisher = 3,
+        ColumnSize = 4,
+        ColumnInstallDate = 5,
+        ColumnLocation = 6,
+        ColumnCount
+    };
+    
+    // 模型跟随scanner的目录变化通知更新，scanner须比模型存活更久
+    explicit ApplicationTableModel(AppScanner* scanner, QObject* parent = nullptr);
+    
+    // QAbstractTableModel接口
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    bool setData(const QModelIndex& index, const QVariant& value, int role = Qt::EditRole) override;
+    Qt::ItemFlags flags(const QModelIndex& index) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+    
+    // 应用后台从搜索索引查询出的过滤结果：keys为按相关度排序的注册表键，
+    // 未按列排序时保持该顺序；关键字为空时显示全部应用。
+    // searchRevision为查询开始时扫描器的搜索修订号
+    void setFilterResult(const QString& keyword, const QStringList& keys, quint64 searchRevision);
+    
+    // 访问可见行对应的应用
+    const ApplicationInfo& applicationAt(int row) const;
+    
+    // 勾选状态（只统计可见行）
+    QList<ApplicationInfo> checkedApplications() const;
+    int checkedCount() const;
+    void setAllChecked(bool checked);
+    
+    // 目录中的应用总数
+    int catalogSize() const;
+
+signals:
+    void checkedCountChanged(int count);
+    
+    // 有过滤条件时目录新增了应用或名称、发布商有变化，需要重新查询搜索索引；
+    // 在此之前新增的应用暂不显示
+    void filterInvalidated();
+
+private slots:
+    // 目录被整体替换，按扫描器中的全部行重建
+    void onApplicationsCleared();
+    
+    // 扫描器在目录末尾追加了应用
+    void onApplicationsAppended();
+    
+    void onApplicationUpdated(const ApplicationInfo& appInfo);
+    void onApplicationRemoved(const QString& registryKey, int row);
+
+private:
+    bool hasFilter() const;
+    
+    // 有过滤条件且搜索修订号已变化时发出filterInvalidated
+    void checkFilterRevision();
+    
+    void resetRows(QVector<int> rows);
+    
+    // 将目录行加入可见行：未排序时追加到末尾，否则逐段归并到已排序的位置
+    void insertVisibleRows(QVector<int> catalogRows);
+    
+    // 排序列的值变化后把可见行pos移到新的有序位置，返回移动后的位置
+    int moveToSortedPosition(int pos);
+    
+    // 从可见行pos起重建目录行到可见行的反向索引
+    void reindexVisibleRows(int pos);
+    
+    bool lessThan(int leftRow, int rightRow) const;
+    bool rowBefore(int leftRow, int rightRow) const;   // 按当前排序方向比较
+    void sortRows(QVector<int>& rows) const;
+    void applyOrder(const QVector<int>& rows);
+    
+    AppScanner* m_scanner;
+    QVector<bool> m_checked;          // 与扫描器的目录行一一对应
+    QVector<int> m_rows;              // 可见行 -> 目录行
+    QVector<int> m_visibleRowOf;      // 目录行 -> 可见行，不可见时为-1
+    QString m_filter;
+    quint64 m_filterRevision;         // 当前过滤结果对应的搜索修订号
+    int m_sortColumn;
+    Qt::SortOrder m_sortOrder;
+};
@@ -8,6 +8,9 @@
 #include <QUrl>
 #include <QFileDialog>
 #include <QStandardPaths>
+#include <QThreadPool>
+#include <QPointer>
+#include <QDateTime>
 
 BTUMainWindow::BTUMainWindow(QWidget* parent)
     : QMainWindow(parent)
@@ -24,13 +27,21 @@ BTUMainWindow::BTUMainWindow(QWidget* parent)
     // 初始化设置
     m_settings = new QSettings("BTU", "BoringToUninstall", this);
     
-    // 创建核心组件
+    // 创建核心组件（扫描结果按批投递，减少事件队列和布局开销）
     m_scanner = new AppScanner(this);
+    m_scanner->setBatchDelivery(256, 16);
+    m_catalogWatcher = new CatalogWatcher(m_scanner, this);
     m_uninstallEngine = new UninstallEngine(this);
     
     // 创建定时器
     m_statusTimer = new QTimer(this);
     
+    m_filterTimer = new QTimer(this);
+    m_filterTimer->setSingleShot(true);
+    m_filterTimer->setInterval(150);
+    m_filterGeneration = std::make_shared<std::atomic<quint64>>(0);
+    m_filterPool.setMaxThreadCount(1);
+    
     // 设置UI
     setupUI();
     setupMenuBar();
@@ -42,10 +53,17 @@ BTUMainWindow::BTUMainWindow(QWidget* parent)
     
     LOG_INFO("BTU主窗口初始化完成");
     
-    // 启动时自动扫描应用
-    QTimer::singleShot(500, this, [this]() {
+    // 启动时先加载上次的快照，再在后台增量扫描与注册表对账
+    m_scanner->loadSnapshot();
+    QTimer::singleShot(0, this, [this]() {
         onRefreshClicked();
     });
+    
+    // 之后的安装和卸载由监视器增量同步到列表
+    m_catalogWatcher->start();
+    
+    // 安全策略文件修改后即时生效，无需重启
+    SafetyChecker::instance().watchPolicyFile(this);
 }
 
 BTUMainWindow::~BTUMainWindow() {
@@ -111,13 +129,10 @@ void BTUMainWindow::setupUI() {
     m_topLayout->addWidget(m_searchEdit);
     m_topLayout->addWidget(m_refreshButton);
     
-    // 创建应用列表表格
-    m_appTable = new QTableWidget(this);
-    m_appTable->setColumnCount(ColumnCount);
-    
-    QStringList headers;
-    headers << "选择" << "应用名称" << "版本" << "发布商" << "大小" << "安装日期" << "安装位置";
-    m_appTable->setHorizontalHeaderLabels(headers);
+    // 创建应用列表（模型/视图，模型直接读取扫描器的目录，只渲染可见行）
+    m_appModel = new ApplicationTableModel(m_scanner, this);
+    m_appTable = new QTableView(this);
+    m_appTable->setModel(m_appModel);
     
     // 设置表格属性
     m_appTable->setSelectionBehavior(QAbstractItemView::SelectRows);
@@ -125,29 +140,33 @@ void BTUMainWindow::setupUI() {
     m_appTable->setSortingEnabled(true);
     m_appTable->verticalHeader()->setVisible(false);
     
+    // 固定行高，避免视图为计算行高访问所有行
+    m_appTable->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    m_appTable->verticalHeader()->setDefaultSectionSize(32);
+    
     // 设置列宽
     m_appTable->horizontalHeader()->setStretchLastSection(true);
-    m_appTable->setColumnWidth(ColumnCheckBox, 60);
-    m_appTable->setColumnWidth(ColumnName, 250);
-    m_appTable->setColumnWidth(ColumnVersion, 100);
-    m_appTable->setColumnWidth(ColumnPublisher, 150);
-    m_appTable->setColumnWidth(ColumnSize, 80);
-    m_appTable->setColumnWidth(ColumnInstallDate, 100);
+    m_appTable->setColumnWidth(ApplicationTableModel::ColumnCheckBox, 60);
+    m_appTable->setColumnWidth(ApplicationTableModel::ColumnName, 250);
+    m_appTable->setColumnWidth(ApplicationTableModel::ColumnVersion, 100);
+    m_appTable->setColumnWidth(ApplicationTableModel::ColumnPublisher, 150);
+    m_appTable->setColumnWidth(ApplicationTableModel::ColumnSize, 80);
+    m_appTable->setColumnWidth(ApplicationTableModel::ColumnInstallDate, 100);
     
     // 表格样式
     m_appTable->setStyleSheet(
-        "QTableWidget {"
+        "QTableView {"
         "    gridline-color: #e0e0e0;"
         "    background-color: white;"
         "    alternate-background-color: #f9f9f9;"
         "    selection-background-color: #E3F2FD;"
         "    font-size: 13px;"
         "}"
-        "QTableWidget::item {"
+        "QTableView::item {"
         "    padding: 8px;"
         "    border: none;"
         "}"
-        "QTableWidget::item:selected {"
+        "QTableView::item:selected {"
         "    background-color: #2196F3;"
         "    color: white;"
         "}"
@@ -314,9 +333,10 @@ void BTUMainWindow::setupConnections() {
     connect(m_exitButton, &QPushButton::clicked, this, &BTUMainWindow::onExitClicked);
     
     // 表格信号连接
-    connect(m_appTable, &QTableWidget::itemChanged, this, &BTUMainWindow::onTableItemChanged);
-    connect(m_appTable, &QTableWidget::itemSelectionChanged, this, &BTUMainWindow::onTableSelectionChanged);
-    connect(m_appTable, &QTableWidget::itemDoubleClicked, this, &BTUMainWindow::onTableItemDoubleClicked);
+    connect(m_appModel, &ApplicationTableModel::checkedCountChanged, this, &BTUMainWindow::onCheckedCountChanged);
+    connect(m_appModel, &ApplicationTableModel::filterInvalidated, this, &BTUMainWindow::onFilterInvalidated);
+    connect(m_appTable->selectionModel(), &QItemSelectionModel::selectionChanged, this, &BTUMainWindow::onTableSelectionChanged);
+    connect(m_appTable, &QTableView::doubleClicked, this, &BTUMainWindow::onTableDoubleClicked);
     
     // 菜单信号连接
     connect(m_refreshAction, &QAction::triggered, this, &BTUMainWindow::onRefreshClicked);
@@ -327,7 +347,6 @@ void BTUMainWindow::setupConnections() {
     // 扫描器信号连接
     connect(m_scanner, &AppScanner::scanStarted, this, &BTUMainWindow::onScanStarted);
     connect(m_scanner, &AppScanner::scanFinished, this, &BTUMainWindow::onScanFinished);
-    connect(m_scanner, &AppScanner::applicationFound, this, &BTUMainWindow::onApplicationFound);
     connect(m_scanner, &AppScanner::scanProgress, this, &BTUMainWindow::onScanProgress);
     connect(m_scanner, &AppScanner::scanError, this, &BTUMainWindow::onScanError);
     
@@ -337,8 +356,10 @@ void BTUMainWindow::setupConnections() {
     connect(m_uninstallEngine, &UninstallEngine::uninstallProgress, this, &BTUMainWindow::onUninstallProgress);
     connect(m_uninstallEngine, &UninstallEngine::uninstallError, this, &BTUMainWindow::onUninstallError);
     connect(m_uninstallEngine, &UninstallEngine::allUninstallsFinished, this, &BTUMainWindow::onAllUninstallsFinished);
+    connect(m_uninstallEngine, &UninstallEngine::previewFinished, this, &BTUMainWindow::onUninstallPreviewFinished);
     
     // 定时器信号连接
+    connect(m_filterTimer, &QTimer::timeout, this, &BTUMainWindow::filterApplications);
     connect(m_statusTimer, &QTimer::timeout, this, &BTUMainWindow::updateStatusInfo);
     m_statusTimer->start(1000); // 每秒更新一次状态
 }
@@ -349,7 +370,7 @@ void BTUMainWindow::loadSettings() {
     restoreState(m_settings->value("windowState").toByteArray());
     
     // 加载表格列宽
-    for (int i = 0; i < ColumnCount; ++i) {
+    for (int i = 0; i < ApplicationTableModel::ColumnCount; ++i) {
         int width = m_settings->value(QString("columnWidth_%1").arg(i), -1).toInt();
         if (width > 0) {
             m_appTable->setColumnWidth(i, width);
@@ -363,7 +384,7 @@ void BTUMainWindow::saveSettings() {
     m_settings->setValue("windowState", saveState());
     
     // 保存表格列宽
-    for (int i = 0; i < ColumnCount; ++i) {
+    for (int i = 0; i < ApplicationTableModel::ColumnCount; ++i) {
         m_settings->setValue(QString("columnWidth_%1").arg(i), m_appTable->columnWidth(i));
     }
 }
@@ -395,7 +416,17 @@ void BTUMainWindow::closeEvent(QCloseEvent* event) {
 // 继续实现其他方法...
 void BTUMainWindow::onSearchTextChanged(const QString& text) {
     m_currentFilter = text;
-    filterApplications();
+    
+    // 输入停顿后才开始过滤，同时让进行中的旧查询失效
+    ++*m_filterGeneration;
+    m_filterTimer->start();
+}
+
+void BTUMainWindow::onFilterInvalidated() {
+    // 扫描中目录持续变化，不推迟已在等待的查询，最多每个防抖间隔查询一次
+    if (!m_filterTimer->isActive()) {
+        m_filterTimer->start();
+    }
 }
 
 void BTUMainWindow::onRefreshClicked() {
@@ -409,12 +440,7 @@ void BTUMainWindow::onRefreshClicked() {
 void BTUMainWindow::onSelectAllClicked() {
     bool selectAll = m_selectAllCheckBox->isChecked();
     
-    for (int row = 0; row < m_appTable->rowCount(); ++row) {
-        QTableWidgetItem* checkItem = m_appTable->item(row, ColumnCheckBox);
-        if (checkItem) {
-            checkItem->setCheckState(selectAll ? Qt::Checked : Qt::Unchecked);
-        }
-    }
+    m_appModel->setAllChecked(selectAll);
     
     updateSelectionInfo();
 }
@@ -432,23 +458,80 @@ void BTUMainWindow::onUninstallClicked() {
         return;
     }
     
+    // 先预演，确认对话框列出将要清理的内容
+    m_statusLabel->setText(QString("正在分析 %1 个应用程序的待清理内容...").arg(selectedApps.size()));
+    m_progressBar->setVisible(true);
+    m_progressBar->setRange(0, 0);
+    setUIEnabled(false);
+    
+    // 与未选中的应用共享的残留不自动删除
+    m_uninstallEngine->setInstalledApplications(m_scanner->getApplications());
+    m_uninstallEngine->previewUninstall(selectedApps);
+}
+
+void BTUMainWindow::onUninstallPreviewFinished(const QList<UninstallPlan>& plans) {
+    m_progressBar->setVisible(false);
+    setUIEnabled(true);
+    m_statusLabel->setText("就绪");
+    
+    if (plans.isEmpty()) {
+        return;
+    }
+    
     // 显示确认对话框
     QString appNames;
-    for (int i = 0; i < selectedApps.size() && i < 5; ++i) {
-        appNames += "• " + selectedApps[i].name + "\n";
+    qint64 totalFiles = 0;
+    qint64 totalBytes = 0;
+    int totalRegistryKeys = 0;
+    int rejected = 0;
+    for (int i = 0; i < plans.size(); ++i) {
+        const UninstallPlan& plan = plans[i];
+        totalFiles += plan.totalFiles;
+        totalBytes += plan.totalBytes;
+        totalRegistryKeys += plan.totalRegistryKeys;
+        rejected += plan.rejected.size();
+        
+        if (i < 5) {
+            appNames += QString("• %1（%2 个文件，%3）\n")
+                        .arg(plan.application.name).arg(plan.totalFiles)
+                        .arg(ApplicationInfo::formatSize(plan.totalBytes));
+        }
+    }
+    if (plans.size() > 5) {
+        appNames += QString("... 以及其他 %1 个应用\n").arg(plans.size() - 5);
     }
-    if (selectedApps.size() > 5) {
-        appNames += QString("... 以及其他 %1 个应用").arg(selectedApps.size() - 5);
+    
+    QString summary = QString("共删除 %1 个文件（%2），清理 %3 个注册表项。\n")
+                      .arg(totalFiles).arg(ApplicationInfo::formatSize(totalBytes)).arg(totalRegistryKeys);
+    if (rejected > 0) {
+        summary += QString("%1 个位置未通过安全检查，将被保留。\n").arg(rejected);
     }
     
-    QMessageBox::StandardButton ret = QMessageBox::warning(this, "确认卸载",
-        QString("确定要深度卸载以下 %1 个应用程序吗？\n\n%2\n"
+    QMessageBox box(QMessageBox::Warning, "确认卸载",
+        QString("确定要深度卸载以下 %1 个应用程序吗？\n\n%2\n%3\n"
                 "⚠️ 警告：深度卸载将完全删除应用及其相关文件，此操作不可撤销！")
-                .arg(selectedApps.size()).arg(appNames),
-        QMessageBox::Yes | QMessageBox::No);
+                .arg(plans.size()).arg(appNames, summary),
+        QMessageBox::Yes | QMessageBox::No, this);
+    QPushButton* exportButton = box.addButton("导出计划...", QMessageBox::ActionRole);
+    
+    // 导出后回到确认对话框
+    for (;;) {
+        box.exec();
+        if (box.clickedButton() != exportButton) {
+            break;
+        }
+        
+        const QString defaultPath = QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation) +
+            QString("/BTU_Plan_%1.json").arg(QDateTime::currentDateTime().toString("yyyyMMdd_hhmmss"));
+        const QString filePath = QFileDialog::getSaveFileName(this, "导出卸载计划", defaultPath, "JSON 文件 (*.json)");
+        if (!filePath.isEmpty() && !UninstallEngine::exportPlans(plans, filePath)) {
+            QMessageBox::warning(this, "导出失败", QString("无法写入文件: %1").arg(filePath));
+        }
+    }
     
-    if (ret == QMessageBox::Yes) {
-        m_uninstallEngine->uninstallApplications(selectedApps);
+    // 执行的就是预演得到的计划，不再重新枚举
+    if (box.clickedButton() == box.button(QMessageBox::Yes)) {
+        m_uninstallEngine->uninstallWithPlans(plans);
     }
 }
 
@@ -463,27 +546,17 @@ void BTUMainWindow::onScanStarted() {
     m_statusLabel->setText("正在扫描已安装应用...");
     setUIEnabled(false);
     
-    // 清空表格
-    m_appTable->setRowCount(0);
-    m_allApplications.clear();
-    m_filteredApplications.clear();
-    
     LOG_INFO("开始扫描应用程序列表");
 }
 
 void BTUMainWindow::onScanFinished() {
     m_isScanning = false;
     m_progressBar->setVisible(false);
-    m_statusLabel->setText(QString("扫描完成，找到 %1 个应用程序").arg(m_allApplications.size()));
+    m_statusLabel->setText(QString("扫描完成，找到 %1 个应用程序").arg(m_appModel->catalogSize()));
     setUIEnabled(true);
     
     updateSelectionInfo();
-    LOG_INFO(QString("应用程序扫描完成，共找到 %1 个应用").arg(m_allApplications.size()));
-}
-
-void BTUMainWindow::onApplicationFound(const ApplicationInfo& appInfo) {
-    m_allApplications.append(appInfo);
-    addApplicationToTable(appInfo);
+    LOG_INFO(QString("应用程序扫描完成，共找到 %1 个应用").arg(m_appModel->catalogSize()));
 }
 
 void BTUMainWindow::onScanProgress(int current, int total) {
@@ -499,80 +572,59 @@ void BTUMainWindow::onScanError(const QString& error) {
     LOG_ERROR(QString("扫描错误: %1").arg(error));
 }
 
-void BTUMainWindow::addApplicationToTable(const ApplicationInfo& appInfo) {
-    // 应用过滤器
-    if (!m_currentFilter.isEmpty()) {
-        if (!appInfo.name.contains(m_currentFilter, Qt::CaseInsensitive) &&
-            !appInfo.publisher.contains(m_currentFilter, Qt::CaseInsensitive)) {
-            return;
-        }
-    }
+void BTUMainWindow::filterApplications() {
+    const quint64 generation = ++*m_filterGeneration;
+    const QString keyword = m_currentFilter.trimmed();
     
-    int row = m_appTable->rowCount();
-    m_appTable->insertRow(row);
-    
-    // 复选框
-    QTableWidgetItem* checkItem = new QTableWidgetItem();
-    checkItem->setCheckState(Qt::Unchecked);
-    checkItem->setFlags(Qt::ItemIsUserCheckable | Qt::ItemIsEnabled);
-    m_appTable->setItem(row, ColumnCheckBox, checkItem);
-    
-    // 应用名称
-    QTableWidgetItem* nameItem = new QTableWidgetItem(appInfo.displayName);
-    nameItem->setData(Qt::UserRole, QVariant::fromValue(appInfo));
-    if (appInfo.isSystemApp) {
-        nameItem->setForeground(QBrush(QColor(255, 87, 34))); // 橙色表示系统应用
-        nameItem->setToolTip("系统关键应用，建议不要卸载");
+    if (keyword.isEmpty()) {
+        m_appModel->setFilterResult(QString(), QStringList(), m_scanner->searchRevision());
+        updateSelectionInfo();
+        return;
     }
-    m_appTable->setItem(row, ColumnName, nameItem);
-    
-    // 版本
-    m_appTable->setItem(row, ColumnVersion, new QTableWidgetItem(appInfo.version));
-    
-    // 发布商
-    m_appTable->setItem(row, ColumnPublisher, new QTableWidgetItem(appInfo.publisher));
     
-    // 大小
-    m_appTable->setItem(row, ColumnSize, new QTableWidgetItem(appInfo.estimatedSize));
+    const quint64 searchRevision = m_scanner->searchRevision();
+    std::shared_ptr<std::atomic<quint64>> currentGeneration = m_filterGeneration;
+    const AppScanner* scanner = m_scanner;
+    QPointer<BTUMainWindow> window(this);
     
-    // 安装日期
-    m_appTable->setItem(row, ColumnInstallDate, new QTableWidgetItem(appInfo.installDate));
-    
-    // 安装位置
-    m_appTable->setItem(row, ColumnLocation, new QTableWidgetItem(appInfo.installLocation));
+    // 在工作线程中查询扫描器的搜索索引，开始前已有更新的查询时放弃
+    m_filterPool.start([=]() {
+        if (currentGeneration->load() != generation) {
+            return;
+        }
+        const QStringList keys = scanner->searchKeys(keyword);
+        
+        if (currentGeneration->load() != generation || !window) {
+            return;
+        }
+        
+        QMetaObject::invokeMethod(window, [=]() {
+            if (window) {
+                window->applyFilterResult(generation, keyword, searchRevision, keys);
+            }
+        }, Qt::QueuedConnection);
+    });
 }
 
-void BTUMainWindow::filterApplications() {
-    m_appTable->setRowCount(0);
-    
-    for (const ApplicationInfo& appInfo : m_allApplications) {
-        addApplicationToTable(appInfo);
+void BTUMainWindow::applyFilterResult(quint64 generation, const QString& keyword, quint64 searchRevision,
+                                      const QStringList& keys) {
+    if (generation != m_filterGeneration->load()) {
+        return;
     }
     
+    m_appModel->setFilterResult(keyword, keys, searchRevision);
+    
     updateSelectionInfo();
 }
 
 QList<ApplicationInfo> BTUMainWindow::getSelectedApplications() const {
-    QList<ApplicationInfo> selectedApps;
-    
-    for (int row = 0; row < m_appTable->rowCount(); ++row) {
-        QTableWidgetItem* checkItem = m_appTable->item(row, ColumnCheckBox);
-        if (checkItem && checkItem->checkState() == Qt::Checked) {
-            QTableWidgetItem* nameItem = m_appTable->item(row, ColumnName);
-            if (nameItem) {
-                ApplicationInfo appInfo = nameItem->data(Qt::UserRole).value<ApplicationInfo>();
-                selectedApps.append(appInfo);
-            }
-        }
-    }
-    
-    return selectedApps;
+    return m_appModel->checkedApplications();
 }
 
 void BTUMainWindow::updateSelectionInfo() {
-    QList<ApplicationInfo> selectedApps = getSelectedApplications();
-    m_selectionLabel->setText(QString("已选择 %1 个应用").arg(selectedApps.size()));
-    m_uninstallButton->setEnabled(!selectedApps.isEmpty() && !m_isUninstalling);
+    int selectedCount = m_appModel->checkedCount();
+    m_selectionLabel->setText(QString("已选择 %1 个应用").arg(selectedCount));
+    m_uninstallButton->setEnabled(selectedCount > 0 && !m_isUninstalling);
 }
 
 void BTUMainWindow::setUIEnabled(bool enabled) {
@@ -580,27 +632,22 @@ void BTUMainWindow::setUIEnabled(bool enabled) {
     m_refreshButton->setEnabled(enabled);
     m_selectAllCheckBox->setEnabled(enabled);
     m_unselectAllButton->setEnabled(enabled);
-    m_uninstallButton->setEnabled(enabled && !getSelectedApplications().isEmpty());
+    m_uninstallButton->setEnabled(enabled && m_appModel->checkedCount() > 0);
     m_appTable->setEnabled(enabled);
 }
 
-void BTUMainWindow::onTableItemChanged(QTableWidgetItem* item) {
-    if (item && item->column() == ColumnCheckBox) {
-        updateSelectionInfo();
-    }
+void BTUMainWindow::onCheckedCountChanged(int count) {
+    Q_UNUSED(count);
+    updateSelectionInfo();
 }
 
 void BTUMainWindow::onTableSelectionChanged() {
     // 这个方法可以用于处理表格选择变化
 }
 
-void BTUMainWindow::onTableItemDoubleClicked(QTableWidgetItem* item) {
-    if (item) {
-        QTableWidgetItem* nameItem = m_appTable->item(item->row(), ColumnName);
-        if (nameItem) {
-            ApplicationInfo appInfo = nameItem->data(Qt::UserRole).value<ApplicationInfo>();
-            showApplicationDetails(appInfo);
-        }
+void BTUMainWindow::onTableDoubleClicked(const QModelIndex& index) {
+    if (index.isValid()) {
+        showApplicationDetails(m_appModel->applicationAt(index.row()));
     }
 }
 
@@ -617,15 +664,15 @@ void BTUMainWindow::showApplicationDetails(const ApplicationInfo& appInfo) {
         "卸载命令: %7\n"
         "注册表键: %8\n"
         "系统应用: %9"
-    ).arg(appInfo.displayName)
+    ).arg(appInfo.name)
      .arg(appInfo.version.isEmpty() ? "未知" : appInfo.version)
      .arg(appInfo.publisher.isEmpty() ? "未知" : appInfo.publisher)
-     .arg(appInfo.estimatedSize)
-     .arg(appInfo.installDate.isEmpty() ? "未知" : appInfo.installDate)
+     .arg(appInfo.sizeText())
+     .arg(appInfo.installDate == 0 ? "未知" : appInfo.installDateText())
      .arg(appInfo.installLocation.isEmpty() ? "未知" : appInfo.installLocation)
      .arg(appInfo.uninstallString.isEmpty() ? "无" : appInfo.uninstallString)
-     .arg(appInfo.registryKey)
-     .arg(appInfo.isSystemApp ? "是" : "否");
+     .arg(appInfo.registryKey())
+     .arg(appInfo.isSystemApp() ? "是" : "否");
     
     QMessageBox::information(this, "应用程序详情", details);
 }
@@ -644,6 +691,18 @@ void BTUMainWindow::onUninstallFinished(const QString& appName, UninstallResult
 
 void BTUMainWindow::onUninstallProgress(const QString& appName, const UninstallProgress& progress) {
     m_statusLabel->setText(QString("卸载 %1: %2").arg(appName, progress.currentOperation));
+    
+    // 文件和注册表项一起计入进度，规划完成前总量未知
+    const int total = progress.totalFiles + progress.totalRegistryKeys;
+    const int processed = progress.filesProcessed + progress.registryKeysProcessed;
+    m_progressBar->setVisible(true);
+    if (total > 0) {
+        m_progressBar->setRange(0, total);
+        m_progressBar->setValue(qMin(processed, total));
+        m_progressBar->setFormat(QString("%p% (%1)").arg(ApplicationInfo::formatSize(progress.bytesFreed)));
+    } else {
+        m_progressBar->setRange(0, 0);
+    }
 }
 
 void BTUMainWindow::onUninstallError(const QString& appName, const QString& error) {
@@ -652,13 +711,13 @@ void BTUMainWindow::onUninstallError(const QString& appName, const QString& erro
 
 void BTUMainWindow::onAllUninstallsFinished() {
     m_isUninstalling = false;
+    m_progressBar->setVisible(false);
+    m_progressBar->resetFormat();
     m_statusLabel->setText("所有卸载操作完成");
     setUIEnabled(true);
     
-    // 刷新应用列表
-    QTimer::singleShot(1000, this, [this]() {
-        onRefreshClicked();
-    });
+    // 后台对账移除已卸载的应用，监视器也会捕获后续的延迟变化
+    m_scanner->reconcile();
     
     QMessageBox::information(this, "卸载完成", "所有选中的应用程序已处理完毕！");
 }
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "AppScanner.h"
+#include "ApplicationTableModel.h"
+#include "CatalogWatcher.h"
 #include "UninstallEngine.h"
 #include "SafetyChecker.h"
 #include "Version.h"
@@ -9,8 +11,7 @@
 #include <QtWidgets/QHBoxLayout>
 #include <QtWidgets/QLineEdit>
 #include <QtWidgets/QPushButton>
-#include <QtWidgets/QTableWidget>
-#include <QtWidgets/QTableWidgetItem>
+#include <QtWidgets/QTableView>
 #include <QtWidgets/QHeaderView>
 #include <QtWidgets/QProgressBar>
 #include <QtWidgets/QLabel>
@@ -25,7 +26,10 @@
 #include <QtWidgets/QTextEdit>
 #include <QtWidgets/QGroupBox>
 #include <QTimer>
+#include <QThreadPool>
 #include <QSettings>
+#include <atomic>
+#include <memory>
 
 class BTUMainWindow : public QMainWindow {
     Q_OBJECT
@@ -40,6 +44,7 @@ protected:
 private slots:
     // 界面操作
     void onSearchTextChanged(const QString& text);
+    void onFilterInvalidated();
     void onRefreshClicked();
     void onSelectAllClicked();
     void onUnselectAllClicked();
@@ -49,7 +54,6 @@ private slots:
     // 应用扫描相关
     void onScanStarted();
     void onScanFinished();
-    void onApplicationFound(const ApplicationInfo& appInfo);
     void onScanProgress(int current, int total);
     void onScanError(const QString& error);
     
@@ -59,11 +63,12 @@ private slots:
     void onUninstallProgress(const QString& appName, const UninstallProgress& progress);
     void onUninstallError(const QString& appName, const QString& error);
     void onAllUninstallsFinished();
+    void onUninstallPreviewFinished(const QList<UninstallPlan>& plans);
     
     // 表格操作
-    void onTableItemChanged(QTableWidgetItem* item);
+    void onCheckedCountChanged(int count);
     void onTableSelectionChanged();
-    void onTableItemDoubleClicked(QTableWidgetItem* item);
+    void onTableDoubleClicked(const QModelIndex& index);
     
     // 菜单操作
     void onAboutClicked();
@@ -83,9 +88,10 @@ private:
     void saveSettings();
     
     void populateApplicationTable();
-    void addApplicationToTable(const ApplicationInfo& appInfo);
     void updateApplicationTable();
     void filterApplications();
+    void applyFilterResult(quint64 generation, const QString& keyword, quint64 searchRevision,
+                           const QStringList& keys);
     
     QList<ApplicationInfo> getSelectedApplications() const;
     void updateSelectionInfo();
@@ -105,7 +111,8 @@ private:
     QPushButton* m_refreshButton;
     
     // 应用列表
-    QTableWidget* m_appTable;
+    QTableView* m_appTable;
+    ApplicationTableModel* m_appModel;
     
     // 操作按钮
     QCheckBox* m_selectAllCheckBox;
@@ -135,30 +142,20 @@ private:
     
     // 核心组件
     AppScanner* m_scanner;
+    CatalogWatcher* m_catalogWatcher;
     UninstallEngine* m_uninstallEngine;
     
-    // 数据
-    QList<ApplicationInfo> m_allApplications;
-    QList<ApplicationInfo> m_filteredApplications;
-    
     // 状态
     bool m_isScanning;
     bool m_isUninstalling;
     QString m_currentFilter;
     
+    // 后台过滤：输入防抖，新的查询使旧查询失效
+    QTimer* m_filterTimer;
+    std::shared_ptr<std::atomic<quint64>> m_filterGeneration;
+    QThreadPool m_filterPool;   // 析构时等待进行中的查询，先于扫描器销毁
+    
     // 设置
     QSettings* m_settings;
     QTimer* m_statusTimer;
-    
-    // 表格列枚举
-    enum TableColumn {
-        ColumnCheckBox = 0,
-        ColumnName = 1,
-        ColumnVersion = 2,
-        ColumnPublisher = 3,
-        ColumnSize = 4,
-        ColumnInstallDate = 5,
-        ColumnLocation = 6,
-        ColumnCount
-    };
 };
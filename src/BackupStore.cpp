@@ -0,0 +1,315 @@
+#include "BackupStore.h"
+#include "Logger.h"
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QRegularExpression>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QThread>
+#include <QThreadPool>
+#include <array>
+
+namespace {
+
+// 块大小：最小16KB，平均约64KB，最大256KB
+const qsizetype kMinChunkSize = 16 * 1024;
+const qsizetype kMaxChunkSize = 256 * 1024;
+const quint64 kChunkMask = 0xFFFF000000000000ULL;  // 高16位为0时切分
+
+// 注册表导出的最大深度，防止异常的循环结构
+const int kMaxRegistryDepth = 32;
+
+// gear表：每个字节值对应一个固定的64位随机数，由splitmix64生成以保证各次运行一致
+const std::array<quint64, 256>& gearTable() {
+    static const std::array<quint64, 256> table = []() {
+        std::array<quint64, 256> values{};
+        quint64 state = 0x42545542414B5550ULL;  // "BTUBAKUP"
+        for (quint64& value : values) {
+            state += 0x9E3779B97F4A7C15ULL;
+            quint64 z = state;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            value = z ^ (z >> 31);
+        }
+        return values;
+    }();
+    return table;
+}
+
+// 清单文件名中不能出现的字符
+QString safeFileName(const QString& name) {
+    static const QRegularExpression invalid("[\\\\/:*?\"<>|\\s]+");
+    QString result = name;
+    result.replace(invalid, "_");
+    return result.isEmpty() ? QString("app") : result;
+}
+
+} // namespace
+
+BackupStore::BackupStore(const QString& root)
+    : m_root(root)
+    , m_stopFlag(nullptr)
+{
+}
+
+QString BackupStore::defaultRoot() {
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/backups";
+}
+
+void BackupStore::setStopFlag(const std::atomic<bool>* stopFlag) {
+    m_stopFlag = stopFlag;
+}
+
+qsizetype BackupStore::chunkLength(const char* data, qsizetype length) {
+    if (length <= kMinChunkSize) {
+        return length;
+    }
+    
+    const std::array<quint64, 256>& gear = gearTable();
+    const qsizetype limit = qMin(length, kMaxChunkSize);
+    quint64 hash = 0;
+    
+    // 最小块长度以内不可能切分，跳过以减少计算
+    for (qsizetype i = kMinChunkSize; i < limit; ++i) {
+        hash = (hash << 1) + gear[static_cast<uchar>(data[i])];
+        if ((hash & kChunkMask) == 0) {
+            return i + 1;
+        }
+    }
+    return limit;
+}
+
+BackupStore::Result BackupStore::backup(const ApplicationInfo& appInfo, const RegistryBackend& registry) {
+    Result result;
+    Counters counters;
+    
+    if (!QDir().mkpath(m_root + "/chunks") || !QDir().mkpath(m_root + "/manifests")) {
+        result.error = QString("无法创建备份目录: %1").arg(m_root);
+        return result;
+    }
+    
+    // 1. 列出安装目录中的文件（不跟随符号链接）
+    QVector<FileEntry> files;
+    const QString installDir = appInfo.installLocation.isEmpty() ? QString() : QDir::cleanPath(appInfo.installLocation);
+    if (!installDir.isEmpty() && QFileInfo(installDir).isDir()) {
+        const QDir base(installDir);
+        QDirIterator it(installDir, QDir::Files | QDir::Hidden | QDir::System | QDir::NoSymLinks,
+                        QDirIterator::Subdirectories);
+        while (it.hasNext()) {
+            FileEntry entry;
+            entry.path = base.relativeFilePath(it.next());
+            files.append(entry);
+        }
+    }
+    
+    // 2. 文件并行读取、分块、哈希和压缩；各任务只写自己的条目
+    FileEntry* entries = files.data();
+    QThreadPool pool;
+    pool.setMaxThreadCount(QThread::idealThreadCount());
+    for (int i = 0; i < files.size(); ++i) {
+        pool.start([this, &counters, entries, i, &installDir]() {
+            if (counters.failed || (m_stopFlag && *m_stopFlag)) {
+                return;
+            }
+            if (!storeFile(installDir + "/" + entries[i].path, entries[i], counters)) {
+                counters.failed = true;
+            }
+        });
+    }
+    
+    // 3. 注册表导出在当前线程中与文件同时进行
+    QStringList registryChunks;
+    const QByteArray registryExport = QJsonDocument(
+        exportRegistryKey(registry, appInfo.registryKey(), 0)).toJson(QJsonDocument::Compact);
+    if (!storeData(registryExport, registryChunks, counters)) {
+        counters.failed = true;
+    }
+    
+    pool.waitForDone();
+    
+    if (m_stopFlag && *m_stopFlag) {
+        result.error = "备份已取消";
+        return result;
+    }
+    if (counters.failed) {
+        result.error = QString("无法写入备份存储: %1").arg(m_root);
+        return result;
+    }
+    
+    // 4. 写清单
+    QJsonArray fileArray;
+    for (const FileEntry& entry : files) {
+        if (!entry.readable) {
+            ++result.skippedFiles;
+            LOG_WARNING(QString("无法读取，未备份: %1").arg(QDir(installDir).filePath(entry.path)));
+            continue;
+        }
+        QJsonObject fileObject;
+        fileObject["path"] = entry.path;
+        fileObject["size"] = entry.size;
+        fileObject["chunks"] = QJsonArray::fromStringList(entry.chunks);
+        fileArray.append(fileObject);
+        
+        ++result.files;
+        result.totalBytes += entry.size;
+    }
+    
+    QJsonObject registryObject;
+    registryObject["key"] = appInfo.registryKey();
+    registryObject["size"] = registryExport.size();
+    registryObject["chunks"] = QJsonArray::fromStringList(registryChunks);
+    result.totalBytes += registryExport.size();
+    
+    const QDateTime now = QDateTime::currentDateTime();
+    QJsonObject manifest;
+    manifest["application"] = appInfo.name;
+    manifest["version"] = appInfo.version;
+    manifest["publisher"] = appInfo.publisher;
+    manifest["installLocation"] = installDir;
+    manifest["created"] = now.toString(Qt::ISODate);
+    manifest["hash"] = "sha256";
+    manifest["files"] = fileArray;
+    manifest["registry"] = registryObject;
+    
+    result.manifestPath = QString("%1/manifests/%2_%3.json")
+                              .arg(m_root, safeFileName(appInfo.name), now.toString("yyyyMMdd_hhmmss_zzz"));
+    QSaveFile file(result.manifestPath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        result.error = QString("无法写入备份清单: %1").arg(result.manifestPath);
+        return result;
+    }
+    file.write(QJsonDocument(manifest).toJson(QJsonDocument::Indented));
+    if (!file.commit()) {
+        result.error = QString("无法写入备份清单: %1").arg(result.manifestPath);
+        return result;
+    }
+    
+    result.chunks = counters.chunks;
+    result.newChunks = counters.newChunks;
+    result.storedBytes = counters.storedBytes;
+    result.success = true;
+    return result;
+}
+
+bool BackupStore::storeFile(const QString& filePath, FileEntry& entry, Counters& counters) {
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        // 被占用或无权限的文件记入清单之外，不使整个备份失败
+        entry.readable = false;
+        return true;
+    }
+    
+    // 缓冲区始终补满到最大块长度，切点之后的剩余部分留给下一块
+    QByteArray buffer;
+    bool atEnd = false;
+    for (;;) {
+        if (m_stopFlag && *m_stopFlag) {
+            return true;
+        }
+        if (!atEnd) {
+            const QByteArray data = file.read(kMaxChunkSize - buffer.size());
+            if (data.isEmpty()) {
+                atEnd = true;
+            } else {
+                buffer += data;
+            }
+        }
+        if (!atEnd && buffer.size() < kMaxChunkSize) {
+            continue;
+        }
+        if (buffer.isEmpty()) {
+            break;
+        }
+        
+        const qsizetype length = chunkLength(buffer.constData(), buffer.size());
+        QString hash;
+        if (!storeChunk(buffer.left(length), hash, counters)) {
+            return false;
+        }
+        entry.chunks.append(hash);
+        entry.size += length;
+        buffer.remove(0, length);
+    }
+    
+    if (file.error() != QFileDevice::NoError) {
+        entry.readable = false;
+    }
+    return true;
+}
+
+bool BackupStore::storeData(const QByteArray& data, QStringList& hashes, Counters& counters) {
+    qsizetype offset = 0;
+    while (offset < data.size()) {
+        const qsizetype length = chunkLength(data.constData() + offset, data.size() - offset);
+        QString hash;
+        if (!storeChunk(data.mid(offset, length), hash, counters)) {
+            return false;
+        }
+        hashes.append(hash);
+        offset += length;
+    }
+    return true;
+}
+
+bool BackupStore::storeChunk(const QByteArray& chunk, QString& hash, Counters& counters) {
+    hash = QString::fromLatin1(QCryptographicHash::hash(chunk, QCryptographicHash::Sha256).toHex());
+    ++counters.chunks;
+    
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_knownChunks.contains(hash)) {
+            return true;
+        }
+    }
+    
+    const QString path = chunkPath(hash);
+    if (!QFile::exists(path)) {
+        // 两个线程同时写入同一块时内容相同，后提交的覆盖先提交的，不影响结果
+        QDir().mkpath(QFileInfo(path).path());
+        const QByteArray compressed = qCompress(chunk);
+        QSaveFile file(path);
+        if (!file.open(QIODevice::WriteOnly) || file.write(compressed) != compressed.size() || !file.commit()) {
+            LOG_ERROR(QString("无法写入备份块: %1").arg(path));
+            return false;
+        }
+        ++counters.newChunks;
+        counters.storedBytes += compressed.size();
+    }
+    
+    QMutexLocker locker(&m_mutex);
+    m_knownChunks.insert(hash);
+    return true;
+}
+
+QString BackupStore::chunkPath(const QString& hash) const {
+    return QString("%1/chunks/%2/%3").arg(m_root, hash.left(2), hash);
+}
+
+QJsonObject BackupStore::exportRegistryKey(const RegistryBackend& registry, const QString& keyPath, int depth) {
+    QJsonObject object;
+    object["key"] = keyPath;
+    
+    QJsonObject values;
+    const QVariantHash keyValues = registry.values(keyPath);
+    for (auto it = keyValues.constBegin(); it != keyValues.constEnd(); ++it) {
+        values[it.key()] = QJsonValue::fromVariant(it.value());
+    }
+    object["values"] = values;
+    
+    if (depth < kMaxRegistryDepth) {
+        QJsonArray children;
+        for (const QString& child : registry.childKeys(keyPath)) {
+            children.append(exportRegistryKey(registry, keyPath + "\\" + child, depth + 1));
+        }
+        if (!children.isEmpty()) {
+            object["children"] = children;
+        }
+    }
+    return object;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "AppScanner.h"
+#include "RegistryBackend.h"
+#include <QByteArray>
+#include <QJsonObject>
+#include <QMutex>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <atomic>
+
+// 内容寻址的备份存储：安装目录中的文件和卸载键的注册表导出按内容定义分块，
+// 每块以SHA-256命名、压缩后只存一份，所有应用和所有次备份共享，
+// 共用运行库的应用重复备份时只写入新内容。每次备份写一个清单，
+// 按顺序列出每个文件的块哈希，据此可以还原。
+//
+// 目录结构：<root>/chunks/<哈希前两位>/<哈希>，<root>/manifests/<应用>_<时间>.json
+class BackupStore {
+public:
+    struct Result {
+        bool success = false;
+        QString manifestPath;
+        QString error;
+        int files = 0;
+        int skippedFiles = 0;     // 无法读取（如被占用）而未备份的文件
+        qint64 totalBytes = 0;    // 备份内容的原始大小
+        int chunks = 0;           // 引用的块数
+        int newChunks = 0;        // 本次新写入的块数
+        qint64 storedBytes = 0;   // 本次新写入的压缩后大小
+    };
+    
+    explicit BackupStore(const QString& root = defaultRoot());
+    
+    // 置位后不再开始新的文件，备份以失败结束
+    void setStopFlag(const std::atomic<bool>* stopFlag);
+    
+    // 备份应用的安装目录和卸载键，可从多个线程同时调用
+    Result backup(const ApplicationInfo& appInfo, const RegistryBackend& registry);
+    
+    QString root() const { return m_root; }
+    
+    // AppData下的backups目录
+    static QString defaultRoot();
+    
+    // 内容定义分块（gear滚动哈希）：返回data开头第一块的长度。
+    // 切点只由附近的内容决定，文件中间插入或删除数据不影响其他块的边界
+    static qsizetype chunkLength(const char* data, qsizetype length);
+
+private:
+    struct FileEntry {
+        QString path;             // 相对安装目录的路径
+        qint64 size = 0;
+        QStringList chunks;
+        bool readable = true;
+    };
+    
+    struct Counters {
+        std::atomic<int> chunks{0};
+        std::atomic<int> newChunks{0};
+        std::atomic<qint64> storedBytes{0};
+        std::atomic<bool> failed{false};
+    };
+    
+    // 分块存储一段数据，返回块哈希列表
+    bool storeData(const QByteArray& data, QStringList& hashes, Counters& counters);
+    bool storeFile(const QString& filePath, FileEntry& entry, Counters& counters);
+    
+    // 压缩并写入一块，已存在时跳过
+    bool storeChunk(const QByteArray& chunk, QString& hash, Counters& counters);
+    QString chunkPath(const QString& hash) const;
+    
+    // 将键及其所有子键的值导出为JSON
+    static QJsonObject exportRegistryKey(const RegistryBackend& registry, const QString& keyPath, int depth);
+    
+    QString m_root;
+    const std::atomic<bool>* m_stopFlag;
+    
+    QMutex m_mutex;
+    QSet<QString> m_knownChunks;  // 确认已在存储中的块
+};
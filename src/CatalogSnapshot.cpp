@@ -0,0 +1,145 @@
+#include "CatalogSnapshot.h"
+#include "Logger.h"
+#include <QFile>
+#include <QSaveFile>
+#include <QDataStream>
+#include <QCryptographicHash>
+#include <QStandardPaths>
+#include <cstring>
+
+namespace {
+
+const quint32 kSnapshotMagic = 0x42545543; // "BTUC"
+const quint32 kSnapshotVersion = 3;
+const int kChecksumSize = 20;              // SHA-1
+
+// 文件头：魔数、版本、负载长度、负载校验和
+const int kHeaderSize = 4 + 4 + 8 + kChecksumSize;
+
+QDataStream& operator<<(QDataStream& out, const ApplicationInfo& appInfo) {
+    out << appInfo.name << appInfo.version << appInfo.publisher
+        << appInfo.installLocation << appInfo.uninstallString << appInfo.subKey
+        << appInfo.estimatedSize << appInfo.diskSize << appInfo.allocatedSize << appInfo.installDate << appInfo.hive << appInfo.flags;
+    return out;
+}
+
+QDataStream& operator>>(QDataStream& in, ApplicationInfo& appInfo) {
+    in >> appInfo.name >> appInfo.version >> appInfo.publisher
+       >> appInfo.installLocation >> appInfo.uninstallString >> appInfo.subKey
+       >> appInfo.estimatedSize >> appInfo.diskSize >> appInfo.allocatedSize >> appInfo.installDate >> appInfo.hive >> appInfo.flags;
+    return in;
+}
+
+} // namespace
+
+CatalogSnapshot::CatalogSnapshot(const QString& filePath)
+    : m_filePath(filePath)
+{
+}
+
+QString CatalogSnapshot::defaultPath() {
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/catalog.snapshot";
+}
+
+bool CatalogSnapshot::save(const QList<ApplicationInfo>& applications,
+                           const QHash<QString, quint64>& fingerprints) const {
+    QByteArray payload;
+    {
+        QDataStream out(&payload, QIODevice::WriteOnly);
+        out.setVersion(QDataStream::Qt_6_0);
+        out << static_cast<quint32>(applications.size());
+        for (const ApplicationInfo& appInfo : applications) {
+            out << appInfo;
+        }
+        out << fingerprints;
+    }
+    
+    QByteArray header;
+    {
+        QDataStream out(&header, QIODevice::WriteOnly);
+        out.setVersion(QDataStream::Qt_6_0);
+        out << kSnapshotMagic << kSnapshotVersion << static_cast<quint64>(payload.size());
+    }
+    header += QCryptographicHash::hash(payload, QCryptographicHash::Sha1);
+    
+    // 先写临时文件再原子替换，避免中断时留下损坏的快照
+    QSaveFile file(m_filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        LOG_WARNING(QString("无法写入应用快照: %1").arg(m_filePath));
+        return false;
+    }
+    file.write(header);
+    file.write(payload);
+    
+    return file.commit();
+}
+
+bool CatalogSnapshot::load(QList<ApplicationInfo>& applications,
+                           QHash<QString, quint64>& fingerprints) const {
+    QFile file(m_filePath);
+    if (!file.open(QIODevice::ReadOnly) || file.size() < kHeaderSize) {
+        return false;
+    }
+    
+    uchar* data = file.map(0, file.size());
+    if (!data) {
+        return false;
+    }
+    
+    bool success = false;
+    do {
+        const char* bytes = reinterpret_cast<const char*>(data);
+        
+        QDataStream headerStream(QByteArray::fromRawData(bytes, kHeaderSize));
+        headerStream.setVersion(QDataStream::Qt_6_0);
+        quint32 magic = 0;
+        quint32 version = 0;
+        quint64 payloadSize = 0;
+        headerStream >> magic >> version >> payloadSize;
+        
+        if (magic != kSnapshotMagic || version != kSnapshotVersion) {
+            LOG_INFO("应用快照版本不匹配，忽略");
+            break;
+        }
+        if (payloadSize != static_cast<quint64>(file.size() - kHeaderSize)) {
+            LOG_WARNING("应用快照长度不正确，忽略");
+            break;
+        }
+        
+        // 直接在映射内存上校验和反序列化，不复制负载
+        QByteArray payload = QByteArray::fromRawData(bytes + kHeaderSize, static_cast<qsizetype>(payloadSize));
+        QByteArray checksum = QCryptographicHash::hash(payload, QCryptographicHash::Sha1);
+        if (std::memcmp(checksum.constData(), bytes + kHeaderSize - kChecksumSize, kChecksumSize) != 0) {
+            LOG_WARNING("应用快照校验失败，忽略");
+            break;
+        }
+        
+        QDataStream in(payload);
+        in.setVersion(QDataStream::Qt_6_0);
+        quint32 count = 0;
+        in >> count;
+        
+        QList<ApplicationInfo> loaded;
+        loaded.reserve(count);
+        for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+            ApplicationInfo appInfo;
+            in >> appInfo;
+            loaded.append(appInfo);
+        }
+        
+        QHash<QString, quint64> loadedFingerprints;
+        in >> loadedFingerprints;
+        
+        if (in.status() != QDataStream::Ok) {
+            LOG_WARNING("应用快照内容损坏，忽略");
+            break;
+        }
+        
+        applications = loaded;
+        fingerprints = loadedFingerprints;
+        success = true;
+    } while (false);
+    
+    file.unmap(data);
+    return success;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "AppScanner.h"
+#include <QString>
+#include <QList>
+#include <QHash>
+
+// 应用目录快照：将扫描结果保存为带版本号和校验和的二进制文件，
+// 下次启动时通过内存映射直接加载，无需等待注册表扫描
+class CatalogSnapshot {
+public:
+    explicit CatalogSnapshot(const QString& filePath);
+    
+    // 默认快照路径（位于AppDataLocation）
+    static QString defaultPath();
+    
+    // 保存应用列表及子键指纹
+    bool save(const QList<ApplicationInfo>& applications,
+              const QHash<QString, quint64>& fingerprints) const;
+    
+    // 加载快照，文件缺失、版本不符或校验失败时返回false
+    bool load(QList<ApplicationInfo>& applications,
+              QHash<QString, quint64>& fingerprints) const;
+
+private:
+    QString m_filePath;
+};
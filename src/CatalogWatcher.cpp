@@ -0,0 +1,184 @@
+#include "CatalogWatcher.h"
+#include "Logger.h"
+#include <QDir>
+#include <QFileInfo>
+
+CatalogWatcher::CatalogWatcher(AppScanner* scanner, QObject* parent)
+    : QObject(parent)
+    , m_scanner(scanner)
+    , m_storeNotifier(nullptr)
+    , m_locationNotifier(ChangeNotifier::createFileNotifier(this))
+    , m_debounceTimer(new QTimer(this))
+    , m_isActive(false)
+{
+    m_debounceTimer->setSingleShot(true);
+    m_debounceTimer->setInterval(500);
+    
+    connect(m_debounceTimer, &QTimer::timeout, this, &CatalogWatcher::flushPendingChanges);
+    connect(m_locationNotifier, &ChangeNotifier::changed, this, &CatalogWatcher::onLocationChanged);
+    connect(m_scanner, &AppScanner::catalogChanged, this, &CatalogWatcher::onCatalogChanged);
+}
+
+void CatalogWatcher::start() {
+    if (m_isActive) {
+        return;
+    }
+    m_isActive = true;
+    
+    // 通知方式取决于扫描器当前使用的注册表实现
+    const std::shared_ptr<RegistryBackend> registry = m_scanner->registryBackend();
+    delete m_storeNotifier;
+    m_storeNotifier = registry->isNative() ? ChangeNotifier::createRegistryNotifier(this)
+                                           : ChangeNotifier::createFileNotifier(this);
+    connect(m_storeNotifier, &ChangeNotifier::changed, this, &CatalogWatcher::onStoreChanged);
+    m_storeTargets.clear();
+    
+    syncStoreWatches();
+    syncLocationWatches();
+    LOG_INFO(QString("开始监视应用目录变化: %1 个卸载信息位置, %2 个安装目录")
+             .arg(m_storeNotifier->paths().size()).arg(m_locationNotifier->paths().size()));
+}
+
+void CatalogWatcher::stop() {
+    m_isActive = false;
+    m_debounceTimer->stop();
+    
+    delete m_storeNotifier;
+    m_storeNotifier = nullptr;
+    for (const QString& path : m_locationNotifier->paths()) {
+        m_locationNotifier->removePath(path);
+    }
+    m_keysByLocation.clear();
+    m_storeTargets.clear();
+    m_dirtyLocations.clear();
+    m_dirtyStorePaths.clear();
+}
+
+void CatalogWatcher::setDebounceInterval(int ms) {
+    m_debounceTimer->setInterval(ms);
+}
+
+void CatalogWatcher::onCatalogChanged() {
+    if (m_isActive) {
+        syncStoreWatches();
+        syncLocationWatches();
+    }
+}
+
+void CatalogWatcher::syncStoreWatches() {
+    const std::shared_ptr<RegistryBackend> registry = m_scanner->registryBackend();
+    
+    // 根路径的变化意味着子键增删，子键自身的变化意味着值被修改（含无效条目，它们可能变为有效）
+    QHash<QString, StoreTarget> targets;
+    const QStringList& hivePaths = ApplicationInfo::hivePaths();
+    for (int hive = 0; hive < hivePaths.size(); ++hive) {
+        const QString path = registry->watchPath(hivePaths[hive]);
+        if (!path.isEmpty()) {
+            targets[path].hives.append(hive);
+        }
+    }
+    for (const QString& key : m_scanner->knownRegistryKeys()) {
+        const QString path = registry->watchPath(key);
+        if (!path.isEmpty()) {
+            targets[path].keys.append(key);
+        }
+    }
+    
+    for (auto it = m_storeTargets.constBegin(); it != m_storeTargets.constEnd(); ++it) {
+        if (!targets.contains(it.key())) {
+            m_storeNotifier->removePath(it.key());
+        }
+    }
+    for (auto it = targets.constBegin(); it != targets.constEnd(); ++it) {
+        if (!m_storeTargets.contains(it.key())) {
+            m_storeNotifier->addPath(it.key());
+        }
+    }
+    
+    m_storeTargets = std::move(targets);
+}
+
+void CatalogWatcher::syncLocationWatches() {
+    QHash<QString, QStringList> keysByLocation;
+    const QList<ApplicationInfo> applications = m_scanner->getApplications();
+    for (const ApplicationInfo& appInfo : applications) {
+        if (appInfo.installLocation.isEmpty()) {
+            continue;
+        }
+        
+        const QString location = QDir::cleanPath(appInfo.installLocation);
+        if (QDir(location).isRoot()) {
+            continue;
+        }
+        keysByLocation[location].append(appInfo.registryKey());
+    }
+    
+    for (auto it = m_keysByLocation.constBegin(); it != m_keysByLocation.constEnd(); ++it) {
+        if (!keysByLocation.contains(it.key())) {
+            m_locationNotifier->removePath(it.key());
+        }
+    }
+    for (auto it = keysByLocation.constBegin(); it != keysByLocation.constEnd(); ++it) {
+        if (!m_keysByLocation.contains(it.key()) && QFileInfo::exists(it.key())) {
+            m_locationNotifier->addPath(it.key());
+        }
+    }
+    
+    m_keysByLocation = std::move(keysByLocation);
+}
+
+void CatalogWatcher::onStoreChanged(const QString& path) {
+    m_dirtyStorePaths.insert(path);
+    m_debounceTimer->start();
+}
+
+void CatalogWatcher::onLocationChanged(const QString& path) {
+    m_dirtyLocations.insert(path);
+    m_debounceTimer->start();
+}
+
+void CatalogWatcher::flushPendingChanges() {
+    if (!m_isActive) {
+        return;
+    }
+    
+    QSet<QString> reconcileKeys;
+    QSet<int> reconcileHives;
+    for (const QString& path : std::as_const(m_dirtyStorePaths)) {
+        auto it = m_storeTargets.constFind(path);
+        if (it == m_storeTargets.constEnd()) {
+            continue;
+        }
+        for (int hive : it->hives) {
+            reconcileHives.insert(hive);
+        }
+        for (const QString& key : it->keys) {
+            reconcileKeys.insert(key);
+        }
+    }
+    m_dirtyStorePaths.clear();
+    
+    QStringList resizeKeys;
+    for (const QString& location : std::as_const(m_dirtyLocations)) {
+        const QStringList keys = m_keysByLocation.value(location);
+        if (QFileInfo::exists(location)) {
+            resizeKeys.append(keys);
+        } else {
+            // 安装目录被删除通常意味着应用已卸载，与注册表对账确认
+            m_locationNotifier->removePath(location);
+            m_keysByLocation.remove(location);
+            for (const QString& key : keys) {
+                reconcileKeys.insert(key);
+            }
+        }
+    }
+    m_dirtyLocations.clear();
+    
+    if (!reconcileKeys.isEmpty() || !reconcileHives.isEmpty()) {
+        m_scanner->reconcileKeys(QStringList(reconcileKeys.cbegin(), reconcileKeys.cend()),
+                                 QList<int>(reconcileHives.cbegin(), reconcileHives.cend()));
+    }
+    if (!resizeKeys.isEmpty()) {
+        m_scanner->refreshSizes(resizeKeys);
+    }
+}
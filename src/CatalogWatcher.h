@@ -0,0 +1,56 @@
+#pragma once
+
+#include "AppScanner.h"
+#include "ChangeNotifier.h"
+#include <QObject>
+#include <QTimer>
+#include <QHash>
+#include <QSet>
+
+// 目录监视器：监视卸载信息存储和各应用的安装目录，
+// 事件经防抖合并后只对受影响的子键发起对账或重新计算目录占用，避免完整重新扫描。
+class CatalogWatcher : public QObject {
+    Q_OBJECT
+
+public:
+    explicit CatalogWatcher(AppScanner* scanner, QObject* parent = nullptr);
+    
+    void start();
+    void stop();
+    
+    // 防抖间隔：最后一个事件之后等待多久再处理
+    void setDebounceInterval(int ms);
+
+private slots:
+    void onCatalogChanged();
+    void onStoreChanged(const QString& path);
+    void onLocationChanged(const QString& path);
+    void flushPendingChanges();
+
+private:
+    // 监视位置对应的对账范围
+    struct StoreTarget {
+        QList<int> hives;         // 需要重新枚举子键的根路径
+        QStringList keys;         // 需要比较指纹的子键
+    };
+    
+    void syncStoreWatches();
+    void syncLocationWatches();
+    
+    AppScanner* m_scanner;
+    ChangeNotifier* m_storeNotifier;
+    ChangeNotifier* m_locationNotifier;
+    QTimer* m_debounceTimer;
+    bool m_isActive;
+    
+    // 待处理的变化
+    QSet<QString> m_dirtyStorePaths;
+    QSet<QString> m_dirtyLocations;
+    
+    // 卸载信息的监视位置 -> 该位置变化时的对账范围。系统注册表下每个根路径和子键各自监视，
+    // 以文件模拟时所有键共用配置文件所在目录
+    QHash<QString, StoreTarget> m_storeTargets;
+    
+    // 安装目录 -> 使用该目录的注册表键
+    QHash<QString, QStringList> m_keysByLocation;
+};
@@ -0,0 +1,284 @@
+#include "ChangeNotifier.h"
+#include "Logger.h"
+#include <QFileSystemWatcher>
+#include <QHash>
+#include <QSet>
+
+#ifdef Q_OS_WIN
+#include <QWinEventNotifier>
+#include <windows.h>
+#include <winreg.h>
+#endif
+
+#ifdef Q_OS_LINUX
+#include <QFile>
+#include <QSocketNotifier>
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+namespace {
+
+// 基于QFileSystemWatcher的通用实现
+class FileSystemWatcherNotifier : public ChangeNotifier {
+public:
+    explicit FileSystemWatcherNotifier(QObject* parent)
+        : ChangeNotifier(parent)
+        , m_watcher(new QFileSystemWatcher(this))
+    {
+        connect(m_watcher, &QFileSystemWatcher::directoryChanged, this, &ChangeNotifier::changed);
+        connect(m_watcher, &QFileSystemWatcher::fileChanged, this, &ChangeNotifier::changed);
+    }
+    
+    bool addPath(const QString& path) override {
+        return m_watcher->addPath(path);
+    }
+    
+    void removePath(const QString& path) override {
+        m_watcher->removePath(path);
+    }
+    
+    QStringList paths() const override {
+        return m_watcher->directories() + m_watcher->files();
+    }
+
+private:
+    QFileSystemWatcher* m_watcher;
+};
+
+#ifdef Q_OS_LINUX
+
+// inotify实现：一个描述符监视所有路径，事件在主线程的事件循环中读取。
+// 只监视路径本身及其直接子项，不递归。
+class InotifyNotifier : public ChangeNotifier {
+public:
+    explicit InotifyNotifier(QObject* parent)
+        : ChangeNotifier(parent)
+        , m_fd(inotify_init1(IN_NONBLOCK | IN_CLOEXEC))
+        , m_notifier(nullptr)
+    {
+        if (m_fd < 0) {
+            LOG_WARNING(QString("inotify初始化失败: %1").arg(errno));
+            return;
+        }
+        
+        m_notifier = new QSocketNotifier(m_fd, QSocketNotifier::Read, this);
+        connect(m_notifier, &QSocketNotifier::activated, this, [this]() { readEvents(); });
+    }
+    
+    ~InotifyNotifier() override {
+        if (m_fd >= 0) {
+            close(m_fd);
+        }
+    }
+    
+    bool isValid() const {
+        return m_fd >= 0;
+    }
+    
+    bool addPath(const QString& path) override {
+        if (m_fd < 0 || m_watchByPath.contains(path)) {
+            return m_watchByPath.contains(path);
+        }
+        
+        const uint32_t mask = IN_CREATE | IN_DELETE | IN_MODIFY | IN_CLOSE_WRITE
+                            | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF;
+        const int wd = inotify_add_watch(m_fd, QFile::encodeName(path).constData(), mask);
+        if (wd < 0) {
+            return false;
+        }
+        
+        m_watchByPath.insert(path, wd);
+        m_pathByWatch.insert(wd, path);
+        return true;
+    }
+    
+    void removePath(const QString& path) override {
+        auto it = m_watchByPath.find(path);
+        if (it == m_watchByPath.end()) {
+            return;
+        }
+        
+        inotify_rm_watch(m_fd, it.value());
+        m_pathByWatch.remove(it.value());
+        m_watchByPath.erase(it);
+    }
+    
+    QStringList paths() const override {
+        return m_watchByPath.keys();
+    }
+
+private:
+    void readEvents() {
+        alignas(struct inotify_event) char buffer[4096];
+        QSet<QString> changedPaths;
+        bool overflow = false;
+        
+        for (;;) {
+            const ssize_t length = read(m_fd, buffer, sizeof(buffer));
+            if (length <= 0) {
+                break;
+            }
+            
+            for (ssize_t offset = 0; offset < length;) {
+                const auto* event = reinterpret_cast<const struct inotify_event*>(buffer + offset);
+                offset += sizeof(struct inotify_event) + event->len;
+                
+                if (event->mask & IN_Q_OVERFLOW) {
+                    overflow = true;
+                    continue;
+                }
+                
+                const QString path = m_pathByWatch.value(event->wd);
+                if (path.isEmpty()) {
+                    continue;
+                }
+                changedPaths.insert(path);
+                
+                // 被监视的路径本身已删除，内核会自动移除监视
+                if (event->mask & IN_IGNORED) {
+                    m_pathByWatch.remove(event->wd);
+                    m_watchByPath.remove(path);
+                }
+            }
+        }
+        
+        // 事件队列溢出时无法确定具体路径，视为全部变化
+        if (overflow) {
+            for (const QString& path : m_watchByPath.keys()) {
+                changedPaths.insert(path);
+            }
+        }
+        
+        for (const QString& path : changedPaths) {
+            emit changed(path);
+        }
+    }
+    
+    int m_fd;
+    QSocketNotifier* m_notifier;
+    QHash<QString, int> m_watchByPath;
+    QHash<int, QString> m_pathByWatch;
+};
+
+#endif
+
+#ifdef Q_OS_WIN
+
+// 注册表实现：每个键一个事件句柄，RegNotifyChangeKeyValue为一次性通知，触发后重新注册
+class RegistryNotifier : public ChangeNotifier {
+public:
+    explicit RegistryNotifier(QObject* parent)
+        : ChangeNotifier(parent)
+    {
+    }
+    
+    ~RegistryNotifier() override {
+        const QStringList watched = paths();
+        for (const QString& path : watched) {
+            removePath(path);
+        }
+    }
+    
+    bool addPath(const QString& path) override {
+        if (m_watches.contains(path)) {
+            return true;
+        }
+        
+        HKEY root = nullptr;
+        QString subKey;
+        const int separator = path.indexOf('\\');
+        const QString rootName = path.left(separator);
+        if (rootName == "HKEY_LOCAL_MACHINE") {
+            root = HKEY_LOCAL_MACHINE;
+        } else if (rootName == "HKEY_CURRENT_USER") {
+            root = HKEY_CURRENT_USER;
+        } else {
+            return false;
+        }
+        subKey = path.mid(separator + 1);
+        
+        Watch watch;
+        if (RegOpenKeyExW(root, reinterpret_cast<LPCWSTR>(subKey.utf16()), 0, KEY_NOTIFY, &watch.key) != ERROR_SUCCESS) {
+            return false;
+        }
+        
+        watch.event = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+        if (!watch.event || !arm(watch)) {
+            if (watch.event) {
+                CloseHandle(watch.event);
+            }
+            RegCloseKey(watch.key);
+            return false;
+        }
+        
+        watch.notifier = new QWinEventNotifier(watch.event, this);
+        connect(watch.notifier, &QWinEventNotifier::activated, this, [this, path]() {
+            auto it = m_watches.find(path);
+            if (it != m_watches.end()) {
+                arm(it.value());
+                emit changed(path);
+            }
+        });
+        
+        m_watches.insert(path, watch);
+        return true;
+    }
+    
+    void removePath(const QString& path) override {
+        auto it = m_watches.find(path);
+        if (it == m_watches.end()) {
+            return;
+        }
+        
+        delete it->notifier;
+        RegCloseKey(it->key);
+        CloseHandle(it->event);
+        m_watches.erase(it);
+    }
+    
+    QStringList paths() const override {
+        return m_watches.keys();
+    }
+
+private:
+    struct Watch {
+        HKEY key = nullptr;
+        HANDLE event = nullptr;
+        QWinEventNotifier* notifier = nullptr;
+    };
+    
+    // 只监视键自身的值和直接子键的增删，与目录监视的范围一致，通知的路径即为变化的键
+    static bool arm(const Watch& watch) {
+        return RegNotifyChangeKeyValue(watch.key, FALSE,
+                                       REG_NOTIFY_CHANGE_NAME | REG_NOTIFY_CHANGE_LAST_SET,
+                                       watch.event, TRUE) == ERROR_SUCCESS;
+    }
+    
+    QHash<QString, Watch> m_watches;
+};
+
+#endif
+
+} // namespace
+
+ChangeNotifier* ChangeNotifier::createFileNotifier(QObject* parent) {
+#ifdef Q_OS_LINUX
+    auto* notifier = new InotifyNotifier(parent);
+    if (notifier->isValid()) {
+        return notifier;
+    }
+    delete notifier;
+#endif
+    return new FileSystemWatcherNotifier(parent);
+}
+
+ChangeNotifier* ChangeNotifier::createRegistryNotifier(QObject* parent) {
+#ifdef Q_OS_WIN
+    return new RegistryNotifier(parent);
+#else
+    // 其他平台的注册表由配置文件模拟，监视文件所在目录即可
+    return createFileNotifier(parent);
+#endif
+}
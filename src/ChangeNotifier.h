@@ -0,0 +1,30 @@
+#pragma once
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+
+// 变更通知接口：监视一组路径，路径本身或其直接子项发生变化时发出changed（不递归）。
+// 具体实现按平台选择：Linux使用inotify，Windows注册表使用RegNotifyChangeKeyValue，
+// 其他情况退回QFileSystemWatcher。
+class ChangeNotifier : public QObject {
+    Q_OBJECT
+
+public:
+    explicit ChangeNotifier(QObject* parent = nullptr) : QObject(parent) {}
+    virtual ~ChangeNotifier() = default;
+    
+    // 开始监视路径，失败（不存在或超出系统限制）时返回false
+    virtual bool addPath(const QString& path) = 0;
+    virtual void removePath(const QString& path) = 0;
+    virtual QStringList paths() const = 0;
+    
+    // 监视目录的通知器
+    static ChangeNotifier* createFileNotifier(QObject* parent = nullptr);
+    
+    // 监视卸载信息存储的通知器：Windows下路径为注册表键，其他平台为配置文件所在目录
+    static ChangeNotifier* createRegistryNotifier(QObject* parent = nullptr);
+
+signals:
+    void changed(const QString& path);
+};
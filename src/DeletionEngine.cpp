@@ -0,0 +1,841 @@
+#include "DeletionEngine.h"
+#include "WorkStealingPool.h"
+#include "Logger.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QPair>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#else
+#include <cerrno>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef Q_OS_LINUX
+#include <sys/syscall.h>
+#endif
+#endif
+
+namespace {
+
+#ifdef Q_OS_WIN
+
+LPCWSTR nativePath(const QString& path) {
+    return reinterpret_cast<LPCWSTR>(path.utf16());
+}
+
+// 只读属性会导致删除失败，先清除
+void clearReadOnly(const QString& native, DWORD attributes) {
+    if (attributes & FILE_ATTRIBUTE_READONLY) {
+        SetFileAttributesW(nativePath(native), attributes & ~FILE_ATTRIBUTE_READONLY);
+    }
+}
+
+#else
+
+#ifdef Q_OS_LINUX
+// 一次getdents64系统调用读取的目录项缓冲区大小
+const size_t kDirentBufferSize = 256 * 1024;
+
+struct LinuxDirent64 {
+    quint64 d_ino;
+    qint64 d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[1];
+};
+#endif
+
+// 枚举目录描述符中的条目，对每个条目调用visitor(name)。
+// 在枚举过程中删除条目是安全的
+template <typename Visitor>
+bool forEachEntry(int directoryFd, Visitor visitor) {
+#ifdef Q_OS_LINUX
+    thread_local QByteArray buffer(static_cast<qsizetype>(kDirentBufferSize), Qt::Uninitialized);
+    for (;;) {
+        const long bytes = syscall(SYS_getdents64, directoryFd, buffer.data(), kDirentBufferSize);
+        if (bytes < 0) {
+            return false;
+        }
+        if (bytes == 0) {
+            return true;
+        }
+        
+        for (long offset = 0; offset < bytes;) {
+            const auto* entry = reinterpret_cast<const LinuxDirent64*>(buffer.constData() + offset);
+            offset += entry->d_reclen;
+            visitor(entry->d_name);
+        }
+    }
+#else
+    // fdopendir接管描述符，复制一份以便继续用于unlinkat
+    const int duplicate = fcntl(directoryFd, F_DUPFD_CLOEXEC, 0);
+    DIR* dir = duplicate >= 0 ? fdopendir(duplicate) : nullptr;
+    if (!dir) {
+        if (duplicate >= 0) {
+            ::close(duplicate);
+        }
+        return false;
+    }
+    
+    while (struct dirent* entry = readdir(dir)) {
+        visitor(entry->d_name);
+    }
+    closedir(dir);
+    return true;
+#endif
+}
+
+bool isDotEntry(const char* name) {
+    return name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'));
+}
+
+#endif
+
+} // namespace
+
+struct DeletionEngine::Directory {
+    std::shared_ptr<Directory> parent;
+    QByteArray name;      // 在父目录中的名称；根目录为编码后的完整路径
+    QString path;         // 用于安全检查和报告
+    bool clear = false;   // 子树已确认不涉及受保护路径
+    int index = -1;       // 在计划中的条目下标
+    int fd = -1;
+    bool missing = false; // 执行时目录已不存在
+    std::atomic<int> outstanding{1};   // 自身的处理加上尚未完成的子目录
+    std::atomic<bool> incomplete{false};
+};
+
+DeletionEngine::DeletionEngine(const SafetyPolicy& policy, int threadCount)
+    : m_policy(policy)
+    , m_threadCount(qMax(1, threadCount))
+    , m_progressInterval(256)
+    , m_stopFlag(nullptr)
+    , m_mode(Mode::Remove)
+    , m_plan(nullptr)
+    , m_executePlan(nullptr)
+    , m_rootDevice(0)
+    , m_filesRemoved(0)
+    , m_directoriesRemoved(0)
+    , m_linksRemoved(0)
+    , m_bytesFreed(0)
+{
+}
+
+DeletionEngine::~DeletionEngine() = default;
+
+void DeletionEngine::setProgressCallback(ProgressCallback callback, int interval) {
+    m_progress = std::move(callback);
+    m_progressInterval = qMax(1, interval);
+}
+
+void DeletionEngine::setStopFlag(const std::atomic<bool>* stopFlag) {
+    m_stopFlag = stopFlag;
+}
+
+void DeletionEngine::reset(Mode mode) {
+    m_mode = mode;
+    m_plan = nullptr;
+    m_executePlan = nullptr;
+    m_result = Result();
+    m_filesRemoved = 0;
+    m_directoriesRemoved = 0;
+    m_linksRemoved = 0;
+    m_bytesFreed = 0;
+}
+
+DeletionEngine::Result DeletionEngine::finishResult() {
+    m_result.filesRemoved = m_filesRemoved;
+    m_result.directoriesRemoved = m_directoriesRemoved;
+    m_result.linksRemoved = m_linksRemoved;
+    m_result.bytesFreed = m_bytesFreed;
+    if (m_progress && m_mode != Mode::Plan) {
+        m_progress(m_result.filesRemoved, m_result.bytesFreed);
+    }
+    return m_result;
+}
+
+void DeletionEngine::recordRemovedFile(qint64 bytes) {
+    const qint64 bytesFreed = m_bytesFreed.fetch_add(bytes) + bytes;
+    const qint64 files = m_filesRemoved.fetch_add(1) + 1;
+    if (m_progress && files % m_progressInterval == 0) {
+        m_progress(files, bytesFreed);
+    }
+}
+
+void DeletionEngine::recordBlocked(const QString& path, const char* reason) {
+    LOG_WARNING(QString("%1: %2").arg(QString::fromUtf8(reason), path));
+    QMutexLocker locker(&m_resultMutex);
+    m_result.blocked.append(path);
+}
+
+void DeletionEngine::recordFailed(const QString& path) {
+    QMutexLocker locker(&m_resultMutex);
+    m_result.failed.append(path);
+}
+
+#ifdef Q_OS_WIN
+
+DeletionEngine::Result DeletionEngine::remove(const QString& rootPath) {
+    reset(Mode::Remove);
+    SafeDeleteWalker walker(m_policy);
+    m_result = walker.remove(rootPath);
+    m_filesRemoved = m_result.filesRemoved;
+    m_directoriesRemoved = m_result.directoriesRemoved;
+    m_linksRemoved = m_result.linksRemoved;
+    m_bytesFreed = m_result.bytesFreed;
+    return finishResult();
+}
+
+DeletionPlan DeletionEngine::plan(const QString& rootPath) {
+    reset(Mode::Plan);
+    
+    DeletionPlan plan;
+    const QFileInfo rootInfo(QDir::cleanPath(QFileInfo(rootPath).absoluteFilePath()));
+    plan.root = rootInfo.filePath();
+    
+    WIN32_FILE_ATTRIBUTE_DATA data;
+    if (!GetFileAttributesExW(nativePath(QDir::toNativeSeparators(plan.root)), GetFileExInfoStandard, &data)) {
+        return plan; // 不存在
+    }
+    
+    DeletionPlan::Entry root;
+    root.name = plan.root;
+    const bool isDirectory = data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY;
+    const bool isLink = data.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT;
+    root.type = isLink ? DeletionPlan::Link : (isDirectory ? DeletionPlan::Directory : DeletionPlan::File);
+    
+    if (m_policy.isEntryBlocked(rootInfo.path(), rootInfo.fileName(), root.type == DeletionPlan::Directory, false)) {
+        recordBlocked(plan.root);
+        root.keep = true;
+        plan.entries.append(root);
+        plan.blocked = m_result.blocked;
+        return plan;
+    }
+    
+    if (root.type == DeletionPlan::File) {
+        root.size = (static_cast<qint64>(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+    }
+    plan.entries.append(root);
+    
+    if (root.type == DeletionPlan::Directory) {
+        if (!planDirectory(plan, 0, plan.root, m_policy.isSubtreeClear(plan.root))) {
+            plan.entries[0].keep = true;
+        }
+    } else {
+        plan.fileCount = 1;
+        plan.totalBytes = root.size;
+    }
+    
+    plan.blocked = m_result.blocked;
+    plan.failed = m_result.failed;
+    return plan;
+}
+
+bool DeletionEngine::planDirectory(DeletionPlan& plan, int index, const QString& path, bool clear) {
+    if (m_stopFlag && m_stopFlag->load()) {
+        return false;
+    }
+    
+    const QString pattern = QDir::toNativeSeparators(path) + QLatin1String("\\*");
+    WIN32_FIND_DATAW data;
+    HANDLE handle = FindFirstFileExW(nativePath(pattern), FindExInfoBasic, &data,
+                                     FindExSearchNameMatch, nullptr, FIND_FIRST_EX_LARGE_FETCH);
+    if (handle == INVALID_HANDLE_VALUE) {
+        recordFailed(path);
+        return false;
+    }
+    
+    bool complete = true;
+    QVector<DeletionPlan::Entry> batch;
+    QVector<int> subdirectories;
+    do {
+        const QString name = QString::fromWCharArray(data.cFileName);
+        if (name == QLatin1String(".") || name == QLatin1String("..")) {
+            continue;
+        }
+        
+        DeletionPlan::Entry entry;
+        entry.name = name;
+        entry.parent = index;
+        const bool isDirectory = data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY;
+        const bool isLink = data.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT;
+        entry.type = isLink ? DeletionPlan::Link : (isDirectory ? DeletionPlan::Directory : DeletionPlan::File);
+        
+        if (m_policy.isEntryBlocked(path, name, entry.type == DeletionPlan::Directory, clear)) {
+            recordBlocked(path + QLatin1Char('/') + name);
+            entry.keep = true;
+            complete = false;
+        } else if (entry.type == DeletionPlan::Directory) {
+            subdirectories.append(static_cast<int>(batch.size()));
+        } else if (entry.type == DeletionPlan::File) {
+            // 枚举结果不含链接计数，按完整大小计算
+            entry.size = (static_cast<qint64>(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+        }
+        batch.append(entry);
+    } while (FindNextFileW(handle, &data));
+    FindClose(handle);
+    
+    const int base = static_cast<int>(plan.entries.size());
+    plan.entries[index].firstChild = base;
+    plan.entries[index].childCount = static_cast<int>(batch.size());
+    for (const DeletionPlan::Entry& entry : batch) {
+        if (!entry.keep && entry.type != DeletionPlan::Directory) {
+            ++plan.fileCount;
+            plan.totalBytes += entry.size;
+        }
+        plan.entries.append(entry);
+    }
+    
+    for (int position : subdirectories) {
+        const int childIndex = base + position;
+        const QString childPath = path + QLatin1Char('/') + plan.entries[childIndex].name;
+        if (!planDirectory(plan, childIndex, childPath, clear || m_policy.isSubtreeClear(childPath))) {
+            plan.entries[childIndex].keep = true;
+            complete = false;
+        }
+    }
+    return complete;
+}
+
+DeletionEngine::Result DeletionEngine::execute(const DeletionPlan& plan) {
+    reset(Mode::Execute);
+    const int count = static_cast<int>(plan.entries.size());
+    if (count == 0) {
+        return finishResult();
+    }
+    
+    // 目录的完整路径和子树判定，父目录总在子目录之前，一次正向遍历即可得到
+    const QFileInfo rootInfo(plan.root);
+    QVector<QString> paths(count);
+    QVector<bool> clear(count, false);
+    for (int i = 0; i < count; ++i) {
+        const DeletionPlan::Entry& entry = plan.entries[i];
+        if (entry.type != DeletionPlan::Directory) {
+            continue;
+        }
+        paths[i] = entry.parent < 0 ? plan.root : paths[entry.parent] + QLatin1Char('/') + entry.name;
+        clear[i] = (entry.parent >= 0 && clear[entry.parent]) || m_policy.isSubtreeClear(paths[i]);
+    }
+    
+    // 删除目录内容前确认其仍是真实目录：1为是，0为已不存在，-1为已被替换为链接
+    QVector<qint8> verified(count, 2);
+    std::function<qint8(int)> verifyDirectory = [&](int index) -> qint8 {
+        if (verified[index] != 2) {
+            return verified[index];
+        }
+        qint8 state = 1;
+        const int parent = plan.entries[index].parent;
+        if (parent >= 0) {
+            state = verifyDirectory(parent);
+        }
+        if (state == 1) {
+            const DWORD attributes = GetFileAttributesW(nativePath(QDir::toNativeSeparators(paths[index])));
+            if (attributes == INVALID_FILE_ATTRIBUTES) {
+                state = 0;
+            } else if (!(attributes & FILE_ATTRIBUTE_DIRECTORY) || (attributes & FILE_ATTRIBUTE_REPARSE_POINT)) {
+                state = -1;
+            }
+        }
+        verified[index] = state;
+        return state;
+    };
+    
+    // 逆序遍历：子孙总是先于其所在目录被处理
+    QVector<bool> incomplete(count, false);
+    for (int i = count - 1; i >= 0; --i) {
+        if (m_stopFlag && m_stopFlag->load()) {
+            break;
+        }
+        
+        const DeletionPlan::Entry& entry = plan.entries[i];
+        const int parent = entry.parent;
+        auto markIncomplete = [&]() {
+            if (parent >= 0) {
+                incomplete[parent] = true;
+            }
+        };
+        
+        if (entry.keep || incomplete[i]) {
+            markIncomplete();
+            continue;
+        }
+        
+        const bool isDirectory = entry.type == DeletionPlan::Directory;
+        const QString parentPath = parent >= 0 ? paths[parent] : rootInfo.path();
+        const QString name = parent >= 0 ? entry.name : rootInfo.fileName();
+        const QString fullPath = parent >= 0 ? parentPath + QLatin1Char('/') + entry.name : plan.root;
+        
+        // 策略可能在规划之后更新，按当前策略重新检查
+        if (m_policy.isEntryBlocked(parentPath, name, isDirectory, parent >= 0 && clear[parent])) {
+            recordBlocked(fullPath);
+            markIncomplete();
+            continue;
+        }
+        
+        if (parent >= 0) {
+            const qint8 state = verifyDirectory(parent);
+            if (state == 0) {
+                continue; // 所在目录已不存在
+            }
+            if (state < 0) {
+                recordBlocked(paths[parent], "目录已被替换为链接");
+                markIncomplete();
+                continue;
+            }
+        }
+        
+        const QString native = QDir::toNativeSeparators(fullPath);
+        const DWORD attributes = GetFileAttributesW(nativePath(native));
+        if (attributes == INVALID_FILE_ATTRIBUTES) {
+            continue; // 已不存在
+        }
+        
+        const bool nowDirectory = attributes & FILE_ATTRIBUTE_DIRECTORY;
+        const bool nowLink = attributes & FILE_ATTRIBUTE_REPARSE_POINT;
+        if ((isDirectory && (nowLink || !nowDirectory)) || (entry.type == DeletionPlan::File && nowDirectory)) {
+            recordBlocked(fullPath, "条目类型在规划后发生变化");
+            markIncomplete();
+            continue;
+        }
+        
+        clearReadOnly(native, attributes);
+        const bool removed = nowDirectory ? RemoveDirectoryW(nativePath(native)) : DeleteFileW(nativePath(native));
+        if (!removed) {
+            recordFailed(fullPath);
+            markIncomplete();
+        } else if (isDirectory) {
+            ++m_directoriesRemoved;
+        } else if (entry.type == DeletionPlan::Link) {
+            ++m_linksRemoved;
+        } else {
+            recordRemovedFile(entry.size);
+        }
+    }
+    
+    return finishResult();
+}
+
+#else
+
+DeletionEngine::Result DeletionEngine::remove(const QString& rootPath) {
+    reset(Mode::Remove);
+    
+    const QFileInfo rootInfo(QDir::cleanPath(QFileInfo(rootPath).absoluteFilePath()));
+    const QString root = rootInfo.filePath();
+    const QByteArray encoded = QFile::encodeName(root);
+    
+    struct stat st;
+    if (lstat(encoded.constData(), &st) != 0) {
+        if (errno != ENOENT) {
+            recordFailed(root);
+        }
+        return finishResult();
+    }
+    
+    const bool isDirectory = S_ISDIR(st.st_mode);
+    if (m_policy.isEntryBlocked(rootInfo.path(), rootInfo.fileName(), isDirectory, false)) {
+        recordBlocked(root);
+        return finishResult();
+    }
+    
+    if (!isDirectory) {
+        if (::unlink(encoded.constData()) != 0) {
+            recordFailed(root);
+        } else if (S_ISLNK(st.st_mode)) {
+            ++m_linksRemoved;
+        } else {
+            recordRemovedFile(st.st_nlink <= 1 ? static_cast<qint64>(st.st_size) : 0);
+        }
+        return finishResult();
+    }
+    
+    m_rootDevice = static_cast<quint64>(st.st_dev);
+    auto directory = std::make_shared<Directory>();
+    directory->name = encoded;
+    directory->path = root;
+    directory->clear = m_policy.isSubtreeClear(root);
+    run(std::move(directory));
+    
+    return finishResult();
+}
+
+DeletionPlan DeletionEngine::plan(const QString& rootPath) {
+    reset(Mode::Plan);
+    
+    DeletionPlan plan;
+    const QFileInfo rootInfo(QDir::cleanPath(QFileInfo(rootPath).absoluteFilePath()));
+    plan.root = rootInfo.filePath();
+    const QByteArray encoded = QFile::encodeName(plan.root);
+    
+    struct stat st;
+    if (lstat(encoded.constData(), &st) != 0) {
+        if (errno != ENOENT) {
+            plan.failed.append(plan.root);
+        }
+        return plan;
+    }
+    
+    DeletionPlan::Entry root;
+    root.name = plan.root;
+    root.type = S_ISDIR(st.st_mode) ? DeletionPlan::Directory
+              : (S_ISLNK(st.st_mode) ? DeletionPlan::Link : DeletionPlan::File);
+    
+    if (m_policy.isEntryBlocked(rootInfo.path(), rootInfo.fileName(), root.type == DeletionPlan::Directory, false)) {
+        recordBlocked(plan.root);
+        root.keep = true;
+        plan.entries.append(root);
+        plan.blocked = m_result.blocked;
+        return plan;
+    }
+    
+    if (root.type == DeletionPlan::File) {
+        root.size = st.st_nlink <= 1 ? static_cast<qint64>(st.st_size) : 0;
+    }
+    plan.entries.append(root);
+    
+    if (root.type == DeletionPlan::Directory) {
+        m_plan = &plan;
+        m_rootDevice = static_cast<quint64>(st.st_dev);
+        
+        auto directory = std::make_shared<Directory>();
+        directory->name = encoded;
+        directory->path = plan.root;
+        directory->clear = m_policy.isSubtreeClear(plan.root);
+        directory->index = 0;
+        run(std::move(directory));
+        
+        m_plan = nullptr;
+    } else {
+        plan.fileCount = 1;
+        plan.totalBytes = root.size;
+    }
+    
+    plan.blocked = m_result.blocked;
+    plan.failed = m_result.failed;
+    return plan;
+}
+
+DeletionEngine::Result DeletionEngine::execute(const DeletionPlan& plan) {
+    reset(Mode::Execute);
+    if (plan.entries.isEmpty()) {
+        return finishResult();
+    }
+    
+    const DeletionPlan::Entry& rootEntry = plan.entries.first();
+    const QFileInfo rootInfo(plan.root);
+    const QByteArray encoded = QFile::encodeName(plan.root);
+    const bool isDirectory = rootEntry.type == DeletionPlan::Directory;
+    
+    if (m_policy.isEntryBlocked(rootInfo.path(), rootInfo.fileName(), isDirectory, false)) {
+        recordBlocked(plan.root);
+        return finishResult();
+    }
+    if (rootEntry.keep && !isDirectory) {
+        return finishResult();
+    }
+    
+    struct stat st;
+    if (lstat(encoded.constData(), &st) != 0) {
+        if (errno != ENOENT) {
+            recordFailed(plan.root);
+        }
+        return finishResult();
+    }
+    
+    // 规划之后类型发生变化（例如目录被替换为链接）的根路径不做处理
+    if (S_ISDIR(st.st_mode) != isDirectory) {
+        recordBlocked(plan.root, "条目类型在规划后发生变化");
+        return finishResult();
+    }
+    
+    if (!isDirectory) {
+        if (::unlink(encoded.constData()) != 0) {
+            if (errno != ENOENT) {
+                recordFailed(plan.root);
+            }
+        } else if (rootEntry.type == DeletionPlan::Link) {
+            ++m_linksRemoved;
+        } else {
+            recordRemovedFile(rootEntry.size);
+        }
+        return finishResult();
+    }
+    
+    m_executePlan = &plan;
+    m_rootDevice = static_cast<quint64>(st.st_dev);
+    
+    auto directory = std::make_shared<Directory>();
+    directory->name = encoded;
+    directory->path = plan.root;
+    directory->clear = m_policy.isSubtreeClear(plan.root);
+    directory->index = 0;
+    run(std::move(directory));
+    
+    m_executePlan = nullptr;
+    return finishResult();
+}
+
+void DeletionEngine::run(std::shared_ptr<Directory> root) {
+    // 根目录在调用线程中处理，遇到子目录才启动线程池
+    processDirectory(root);
+    root.reset();
+    if (m_pool) {
+        m_pool->waitForDone();
+        m_pool.reset();
+    }
+}
+
+void DeletionEngine::submit(std::shared_ptr<Directory> directory) {
+    if (!m_pool) {
+        m_pool.reset(new WorkStealingPool(m_threadCount));
+    }
+    m_pool->submit([this, directory = std::move(directory)](int) {
+        processDirectory(directory);
+    });
+}
+
+std::shared_ptr<DeletionEngine::Directory> DeletionEngine::createChild(const std::shared_ptr<Directory>& parent,
+                                                                       const QByteArray& name,
+                                                                       const QString& childName) {
+    auto child = std::make_shared<Directory>();
+    child->parent = parent;
+    child->name = name;
+    child->path = parent->path + QLatin1Char('/') + childName;
+    child->clear = parent->clear || m_policy.isSubtreeClear(child->path);
+    
+    parent->outstanding.fetch_add(1);
+    return child;
+}
+
+void DeletionEngine::processDirectory(const std::shared_ptr<Directory>& directory) {
+    if (m_stopFlag && m_stopFlag->load()) {
+        directory->incomplete = true;
+        finishDirectory(directory);
+        return;
+    }
+    
+    // O_NOFOLLOW：检查之后被替换为链接的目录不会被跟随
+    const int parentFd = directory->parent ? directory->parent->fd : AT_FDCWD;
+    directory->fd = openat(parentFd, directory->name.constData(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+    if (directory->fd < 0) {
+        if (errno == ENOENT && m_mode == Mode::Execute) {
+            directory->missing = true;
+        } else {
+            recordFailed(directory->path);
+            directory->incomplete = true;
+        }
+        finishDirectory(directory);
+        return;
+    }
+    
+    // 不跨越挂载点
+    struct stat st;
+    if (fstat(directory->fd, &st) != 0 || static_cast<quint64>(st.st_dev) != m_rootDevice) {
+        recordBlocked(directory->path, "跳过挂载点");
+        directory->incomplete = true;
+        finishDirectory(directory);
+        return;
+    }
+    
+    if (m_mode == Mode::Execute) {
+        executeDirectory(directory);
+    } else {
+        enumerateDirectory(directory);
+    }
+    finishDirectory(directory);
+}
+
+void DeletionEngine::enumerateDirectory(const std::shared_ptr<Directory>& directory) {
+    const int fd = directory->fd;
+    const bool planning = m_mode == Mode::Plan;
+    
+    // 规划时本目录的条目先收集在本地，最后一次性追加到计划中
+    QVector<DeletionPlan::Entry> batch;
+    QVector<QPair<int, std::shared_ptr<Directory>>> subdirectories;
+    
+    const bool enumerated = forEachEntry(fd, [&](const char* name) {
+        if (isDotEntry(name)) {
+            return;
+        }
+        
+        // 相对于目录描述符操作，且不跟随符号链接
+        struct stat st;
+        if (fstatat(fd, name, &st, AT_SYMLINK_NOFOLLOW) != 0) {
+            if (errno != ENOENT) {
+                recordFailed(directory->path + QLatin1Char('/') + QFile::decodeName(name));
+                directory->incomplete = true;
+            }
+            return;
+        }
+        
+        const QString childName = QFile::decodeName(name);
+        DeletionPlan::Entry entry;
+        entry.name = childName;
+        entry.type = S_ISDIR(st.st_mode) ? DeletionPlan::Directory
+                   : (S_ISLNK(st.st_mode) ? DeletionPlan::Link : DeletionPlan::File);
+        // 仍有其他硬链接时空间并未释放
+        if (entry.type == DeletionPlan::File && st.st_nlink <= 1) {
+            entry.size = static_cast<qint64>(st.st_size);
+        }
+        
+        const bool isDirectory = entry.type == DeletionPlan::Directory;
+        if (m_policy.isEntryBlocked(directory->path, childName, isDirectory, directory->clear)) {
+            recordBlocked(directory->path + QLatin1Char('/') + childName);
+            directory->incomplete = true;
+            if (planning) {
+                entry.keep = true;
+                batch.append(entry);
+            }
+            return;
+        }
+        
+        if (isDirectory) {
+            std::shared_ptr<Directory> child = createChild(directory, QByteArray(name), childName);
+            if (planning) {
+                subdirectories.append(qMakePair(static_cast<int>(batch.size()), std::move(child)));
+                batch.append(entry);
+            } else {
+                submit(std::move(child));
+            }
+            return;
+        }
+        
+        if (planning) {
+            batch.append(entry);
+            return;
+        }
+        
+        // 符号链接只删除链接本身
+        if (unlinkat(fd, name, 0) != 0) {
+            recordFailed(directory->path + QLatin1Char('/') + childName);
+            directory->incomplete = true;
+        } else if (entry.type == DeletionPlan::Link) {
+            ++m_linksRemoved;
+        } else {
+            recordRemovedFile(entry.size);
+        }
+    });
+    
+    if (!enumerated) {
+        recordFailed(directory->path);
+        directory->incomplete = true;
+    }
+    
+    if (!planning) {
+        return;
+    }
+    
+    int base = 0;
+    {
+        QMutexLocker locker(&m_planMutex);
+        base = static_cast<int>(m_plan->entries.size());
+        m_plan->entries[directory->index].firstChild = base;
+        m_plan->entries[directory->index].childCount = static_cast<int>(batch.size());
+        for (DeletionPlan::Entry& entry : batch) {
+            entry.parent = directory->index;
+            if (!entry.keep && entry.type != DeletionPlan::Directory) {
+                ++m_plan->fileCount;
+                m_plan->totalBytes += entry.size;
+            }
+            m_plan->entries.append(std::move(entry));
+        }
+    }
+    
+    for (auto& subdirectory : subdirectories) {
+        subdirectory.second->index = base + subdirectory.first;
+        submit(std::move(subdirectory.second));
+    }
+}
+
+void DeletionEngine::executeDirectory(const std::shared_ptr<Directory>& directory) {
+    const DeletionPlan& plan = *m_executePlan;
+    const DeletionPlan::Entry& self = plan.entries[directory->index];
+    const int fd = directory->fd;
+    
+    // 需要保留的目录仍然处理其中可以删除的条目，只是自身不删除
+    if (self.keep) {
+        directory->incomplete = true;
+    }
+    
+    const int end = self.firstChild + self.childCount;
+    for (int i = self.firstChild; i < end; ++i) {
+        const DeletionPlan::Entry& entry = plan.entries[i];
+        const bool isDirectory = entry.type == DeletionPlan::Directory;
+        
+        // 策略可能在规划之后更新，按当前策略重新检查
+        if (m_policy.isEntryBlocked(directory->path, entry.name, isDirectory, directory->clear)) {
+            recordBlocked(directory->path + QLatin1Char('/') + entry.name);
+            directory->incomplete = true;
+            continue;
+        }
+        
+        const QByteArray name = QFile::encodeName(entry.name);
+        if (isDirectory) {
+            std::shared_ptr<Directory> child = createChild(directory, name, entry.name);
+            child->index = i;
+            submit(std::move(child));
+            continue;
+        }
+        
+        if (entry.keep) {
+            directory->incomplete = true;
+            continue;
+        }
+        
+        // 文件在规划后被替换为目录时unlinkat失败，不会误删目录
+        if (unlinkat(fd, name.constData(), 0) != 0) {
+            if (errno != ENOENT) {
+                recordFailed(directory->path + QLatin1Char('/') + entry.name);
+                directory->incomplete = true;
+            }
+        } else if (entry.type == DeletionPlan::Link) {
+            ++m_linksRemoved;
+        } else {
+            recordRemovedFile(entry.size);
+        }
+    }
+}
+
+void DeletionEngine::finishDirectory(std::shared_ptr<Directory> directory) {
+    // 最后一个完成的任务负责结算目录，并继续向上结算父目录
+    while (directory && directory->outstanding.fetch_sub(1) == 1) {
+        if (directory->fd >= 0) {
+            ::close(directory->fd);
+            directory->fd = -1;
+        }
+        
+        std::shared_ptr<Directory> parent = directory->parent;
+        if (m_mode == Mode::Plan) {
+            // 有条目需要保留的目录在计划中标记为保留
+            if (directory->incomplete) {
+                QMutexLocker locker(&m_planMutex);
+                m_plan->entries[directory->index].keep = true;
+                if (parent) {
+                    parent->incomplete = true;
+                }
+            }
+        } else if (directory->missing) {
+            // 执行时目录已不存在
+        } else if (directory->incomplete) {
+            // 有条目被保留，上级目录也不能删除
+            if (parent) {
+                parent->incomplete = true;
+            }
+        } else if (unlinkat(parent ? parent->fd : AT_FDCWD, directory->name.constData(), AT_REMOVEDIR) == 0) {
+            ++m_directoriesRemoved;
+        } else if (errno != ENOENT) {
+            recordFailed(directory->path);
+            if (parent) {
+                parent->incomplete = true;
+            }
+        }
+        
+        directory = std::move(parent);
+    }
+}
+
+#endif
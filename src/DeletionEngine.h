@@ -0,0 +1,103 @@
+#pragma once
+
+#include "DeletionPlan.h"
+#include "SafeDeleteWalker.h"
+#include "SafetyPolicy.h"
+#include <QString>
+#include <QMutex>
+#include <QThread>
+#include <atomic>
+#include <functional>
+#include <memory>
+
+class WorkStealingPool;
+
+// 高吞吐量的目录删除引擎。POSIX下全程基于目录描述符：
+// fstatat/openat/unlinkat都相对于父目录描述符执行，不为每个条目解析完整路径；
+// Linux下用getdents64以大缓冲区批量读取目录项；每个子目录作为独立任务
+// 分发到工作窃取线程池，目录在其所有子目录删除完成后由最后完成的任务删除。
+// 安全语义与SafeDeleteWalker一致：逐项检查策略、不跟随链接、不跨越挂载点。
+//
+// 除直接删除外也可以分两步：plan只枚举不修改，得到完整的条目清单和总量；
+// execute按清单删除，不再读取目录内容。执行时仍按当前策略检查每个条目，
+// 并逐级以O_NOFOLLOW打开目录，规划之后被替换为链接的目录不会被跟随。
+// Windows下顺序执行，直接删除使用SafeDeleteWalker。
+class DeletionEngine {
+public:
+    using Result = SafeDeleteWalker::Result;
+
+    // 参数为累计删除的文件数和释放的字节数；可能在任意工作线程中并发调用
+    using ProgressCallback = std::function<void(qint64 filesRemoved, qint64 bytesFreed)>;
+
+    explicit DeletionEngine(const SafetyPolicy& policy, int threadCount = QThread::idealThreadCount());
+    ~DeletionEngine();
+
+    DeletionEngine(const DeletionEngine&) = delete;
+    DeletionEngine& operator=(const DeletionEngine&) = delete;
+
+    // 每删除interval个文件回调一次，删除结束时再回调一次
+    void setProgressCallback(ProgressCallback callback, int interval = 256);
+
+    // 置位后不再进入新的目录，已进入的目录照常收尾
+    void setStopFlag(const std::atomic<bool>* stopFlag);
+
+    // 删除rootPath及其内容；rootPath本身是链接时只删除链接。
+    // 根目录下没有子目录时不启动线程
+    Result remove(const QString& rootPath);
+
+    // 枚举rootPath下将被删除的条目，不做任何修改
+    DeletionPlan plan(const QString& rootPath);
+
+    // 按计划删除。规划之后已不存在的条目视为已删除
+    Result execute(const DeletionPlan& plan);
+
+private:
+    enum class Mode {
+        Remove,
+        Plan,
+        Execute
+    };
+
+    struct Directory;
+
+    void reset(Mode mode);
+    Result finishResult();
+
+#ifdef Q_OS_WIN
+    bool planDirectory(DeletionPlan& plan, int index, const QString& path, bool clear);
+#else
+    void run(std::shared_ptr<Directory> root);
+    void processDirectory(const std::shared_ptr<Directory>& directory);
+    void enumerateDirectory(const std::shared_ptr<Directory>& directory);
+    void executeDirectory(const std::shared_ptr<Directory>& directory);
+    void finishDirectory(std::shared_ptr<Directory> directory);
+    void submit(std::shared_ptr<Directory> directory);
+    std::shared_ptr<Directory> createChild(const std::shared_ptr<Directory>& parent, const QByteArray& name,
+                                           const QString& childName);
+#endif
+    void recordRemovedFile(qint64 bytes);
+    void recordBlocked(const QString& path, const char* reason = "安全检查拦截删除");
+    void recordFailed(const QString& path);
+
+    const SafetyPolicy& m_policy;
+    int m_threadCount;
+    std::unique_ptr<WorkStealingPool> m_pool;  // 第一次遇到子目录时创建
+
+    ProgressCallback m_progress;
+    int m_progressInterval;
+    const std::atomic<bool>* m_stopFlag;
+
+    Mode m_mode;
+    DeletionPlan* m_plan;               // Plan模式下正在生成的计划
+    const DeletionPlan* m_executePlan;  // Execute模式下正在执行的计划
+    QMutex m_planMutex;
+
+    quint64 m_rootDevice;
+    std::atomic<qint64> m_filesRemoved;
+    std::atomic<qint64> m_directoriesRemoved;
+    std::atomic<qint64> m_linksRemoved;
+    std::atomic<qint64> m_bytesFreed;
+
+    QMutex m_resultMutex;  // 保护blocked和failed列表
+    Result m_result;
+};
@@ -0,0 +1,58 @@
+#include "DeletionPlan.h"
+#include <QJsonArray>
+
+namespace {
+
+QString typeName(DeletionPlan::EntryType type) {
+    switch (type) {
+        case DeletionPlan::File: return QStringLiteral("file");
+        case DeletionPlan::Link: return QStringLiteral("link");
+        case DeletionPlan::Directory: return QStringLiteral("directory");
+    }
+    return QString();
+}
+
+} // namespace
+
+QString DeletionPlan::path(int index) const {
+    QStringList parts;
+    for (int i = index; i >= 0; i = entries[i].parent) {
+        parts.prepend(entries[i].name);
+    }
+    return parts.join(QLatin1Char('/'));
+}
+
+QJsonObject DeletionPlan::toJson() const {
+    // 父条目总在子孙之前，一次正向遍历即可得到完整路径
+    QStringList paths;
+    paths.reserve(entries.size());
+    QJsonArray items;
+    for (const Entry& entry : entries) {
+        const QString entryPath = entry.parent < 0 ? entry.name : paths[entry.parent] + QLatin1Char('/') + entry.name;
+        paths.append(entryPath);
+        
+        QJsonObject item;
+        item.insert("path", entryPath);
+        item.insert("type", typeName(entry.type));
+        if (entry.type == File) {
+            item.insert("size", entry.size);
+        }
+        if (entry.keep) {
+            item.insert("keep", true);
+        }
+        items.append(item);
+    }
+    
+    QJsonObject object;
+    object.insert("root", root);
+    object.insert("fileCount", fileCount);
+    object.insert("totalBytes", totalBytes);
+    object.insert("entries", items);
+    if (!blocked.isEmpty()) {
+        object.insert("blocked", QJsonArray::fromStringList(blocked));
+    }
+    if (!failed.isEmpty()) {
+        object.insert("failed", QJsonArray::fromStringList(failed));
+    }
+    return object;
+}
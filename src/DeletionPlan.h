@@ -0,0 +1,42 @@
+#pragma once
+
+#include <QJsonObject>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// 删除计划：一个根路径下将被删除的完整条目清单，由DeletionEngine::plan生成、
+// DeletionEngine::execute执行，执行时不再枚举目录。
+// 同一目录的子条目连续存放，父目录总是排在其所有子孙之前。
+struct DeletionPlan {
+    enum EntryType : quint8 {
+        File,
+        Link,       // 符号链接、联接点，只删除链接本身
+        Directory
+    };
+    
+    struct Entry {
+        QString name;          // 在父目录中的名称；根条目为完整路径
+        qint64 size = 0;       // 文件大小；仍有其他硬链接的文件为0
+        int parent = -1;
+        int firstChild = -1;   // 目录的子条目为[firstChild, firstChild + childCount)
+        int childCount = 0;
+        EntryType type = File;
+        bool keep = false;     // 自身或子孙未通过安全检查或无法读取，执行时保留
+    };
+    
+    QString root;
+    QVector<Entry> entries;  // 根路径不存在时为空
+    QStringList blocked;     // 规划时被安全检查拦截的条目
+    QStringList failed;      // 规划时无法读取的条目
+    qint64 fileCount = 0;    // 将删除的文件和链接数
+    qint64 totalBytes = 0;   // 将释放的字节数
+    
+    bool isEmpty() const { return entries.isEmpty(); }
+    
+    // 条目的完整路径
+    QString path(int index) const;
+    
+    // 导出为JSON：汇总信息和每个条目的完整路径、类型、大小
+    QJsonObject toJson() const;
+};
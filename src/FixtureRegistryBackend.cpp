@@ -0,0 +1,255 @@
+#include "FixtureRegistryBackend.h"
+#include "Logger.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+FixtureRegistryBackend::FixtureRegistryBackend() = default;
+
+QString FixtureRegistryBackend::normalize(const QString& keyPath) {
+    QString normalized = keyPath.toLower();
+    normalized.replace('/', '\\');
+    while (normalized.endsWith('\\')) {
+        normalized.chop(1);
+    }
+    return normalized;
+}
+
+bool FixtureRegistryBackend::load(const QString& filePath) {
+    // 在读取之前记录文件状态，读取期间发生的修改会在下次refresh时发现
+    const QFileInfo info(filePath);
+    const QDateTime modified = info.lastModified();
+    const qint64 size = info.size();
+    
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    
+    QJsonParseError error;
+    const QJsonDocument document = QJsonDocument::fromJson(file.readAll(), &error);
+    if (error.error != QJsonParseError::NoError || !document.isObject()) {
+        LOG_WARNING(QString("模拟注册表文件格式错误: %1 (%2)").arg(filePath, error.errorString()));
+        return false;
+    }
+    
+    const QJsonObject keys = document.object().value("keys").toObject();
+    
+    QWriteLocker locker(&m_lock);
+    m_keys.clear();
+    m_keys.reserve(keys.size() * 2);
+    for (auto it = keys.constBegin(); it != keys.constEnd(); ++it) {
+        assignValues(it.key(), it.value().toObject().toVariantHash());
+    }
+    m_filePath = info.absoluteFilePath();
+    m_fileModified = modified;
+    m_fileSize = size;
+    return true;
+}
+
+bool FixtureRegistryBackend::save(const QString& filePath) const {
+    QJsonObject keys;
+    {
+        QReadLocker locker(&m_lock);
+        for (const Key& key : m_keys) {
+            // 只保存有值的键和叶子键，中间键在加载时自动重建
+            if (!key.values.isEmpty() || key.children.isEmpty()) {
+                keys.insert(key.path, QJsonObject::fromVariantHash(key.values));
+            }
+        }
+    }
+    
+    QJsonObject root;
+    root.insert("keys", keys);
+    
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    return file.commit();
+}
+
+void FixtureRegistryBackend::setValue(const QString& keyPath, const QString& name, const QVariant& value) {
+    QWriteLocker locker(&m_lock);
+    Key& key = ensureKey(keyPath);
+    key.values.insert(name, value);
+    key.fingerprint = hashValues(key.values);
+}
+
+void FixtureRegistryBackend::setValues(const QString& keyPath, const QVariantHash& values) {
+    QWriteLocker locker(&m_lock);
+    assignValues(keyPath, values);
+}
+
+void FixtureRegistryBackend::assignValues(const QString& keyPath, const QVariantHash& values) {
+    Key& key = ensureKey(keyPath);
+    for (auto it = values.constBegin(); it != values.constEnd(); ++it) {
+        key.values.insert(it.key(), it.value());
+    }
+    key.fingerprint = hashValues(key.values);
+}
+
+void FixtureRegistryBackend::clear() {
+    QWriteLocker locker(&m_lock);
+    m_keys.clear();
+}
+
+int FixtureRegistryBackend::keyCount() const {
+    QReadLocker locker(&m_lock);
+    return static_cast<int>(m_keys.size());
+}
+
+FixtureRegistryBackend::Key& FixtureRegistryBackend::ensureKey(const QString& keyPath) {
+    const QString normalized = normalize(keyPath);
+    auto it = m_keys.find(normalized);
+    if (it != m_keys.end()) {
+        return it.value();
+    }
+    
+    // 逐级创建缺失的上级键
+    const int separator = normalized.lastIndexOf('\\');
+    QString path = keyPath;
+    path.replace('/', '\\');
+    while (path.endsWith('\\')) {
+        path.chop(1);
+    }
+    
+    if (separator > 0) {
+        Key& parent = ensureKey(path.left(separator));
+        parent.children.append(path.mid(separator + 1));
+    }
+    
+    Key& key = m_keys[normalized];
+    key.path = path;
+    return key;
+}
+
+void FixtureRegistryBackend::removeTree(const QString& normalizedPath) {
+    auto it = m_keys.find(normalizedPath);
+    if (it == m_keys.end()) {
+        return;
+    }
+    
+    const QStringList children = it->children;
+    m_keys.erase(it);
+    for (const QString& child : children) {
+        removeTree(normalizedPath + '\\' + child.toLower());
+    }
+}
+
+QStringList FixtureRegistryBackend::childKeys(const QString& keyPath) const {
+    QReadLocker locker(&m_lock);
+    auto it = m_keys.constFind(normalize(keyPath));
+    return it == m_keys.constEnd() ? QStringList() : it->children;
+}
+
+quint64 FixtureRegistryBackend::fingerprint(const QString& keyPath, const QString& subKey) const {
+    QReadLocker locker(&m_lock);
+    auto it = m_keys.constFind(normalize(keyPath + '\\' + subKey));
+    return it == m_keys.constEnd() ? 0 : it->fingerprint;
+}
+
+bool FixtureRegistryBackend::readEntry(const QString& keyPath, const QString& subKey, RegistryEntry& entry) const {
+    QReadLocker locker(&m_lock);
+    auto it = m_keys.constFind(normalize(keyPath + '\\' + subKey));
+    if (it == m_keys.constEnd()) {
+        return false;
+    }
+    
+    entry.subKey = subKey;
+    entry.values = it->values;
+    entry.fingerprint = it->fingerprint;
+    return true;
+}
+
+QVariantHash FixtureRegistryBackend::values(const QString& keyPath) const {
+    QReadLocker locker(&m_lock);
+    auto it = m_keys.constFind(normalize(keyPath));
+    return it == m_keys.constEnd() ? QVariantHash() : it->values;
+}
+
+int FixtureRegistryBackend::deleteTrees(const QStringList& keyPaths) {
+    QWriteLocker locker(&m_lock);
+    
+    // 先删除所有子树，再按父键统一更新子键列表，批量删除同一父键下的大量子键时只需遍历一次
+    QHash<QString, QSet<QString>> removedByParent;
+    int deleted = 0;
+    for (const QString& keyPath : keyPaths) {
+        const QString normalized = normalize(keyPath);
+        if (!m_keys.contains(normalized)) {
+            continue;
+        }
+        
+        removeTree(normalized);
+        ++deleted;
+        
+        const int separator = normalized.lastIndexOf('\\');
+        if (separator > 0) {
+            removedByParent[normalized.left(separator)].insert(normalized.mid(separator + 1));
+        }
+    }
+    
+    for (auto it = removedByParent.constBegin(); it != removedByParent.constEnd(); ++it) {
+        auto parent = m_keys.find(it.key());
+        if (parent == m_keys.end()) {
+            continue;
+        }
+        const QSet<QString>& removed = it.value();
+        parent->children.removeIf([&removed](const QString& child) {
+            return removed.contains(child.toLower());
+        });
+    }
+    
+    return deleted;
+}
+
+int FixtureRegistryBackend::deleteValues(const QString& keyPath, const QStringList& valueNames) {
+    QWriteLocker locker(&m_lock);
+    auto it = m_keys.find(normalize(keyPath));
+    if (it == m_keys.end()) {
+        return 0;
+    }
+    
+    int deleted = 0;
+    for (const QString& name : valueNames) {
+        deleted += it->values.remove(name) ? 1 : 0;
+    }
+    it->fingerprint = hashValues(it->values);
+    return deleted;
+}
+
+bool FixtureRegistryBackend::isNative() const {
+    return false;
+}
+
+QString FixtureRegistryBackend::watchPath(const QString& keyPath) const {
+    Q_UNUSED(keyPath);
+    
+    // 模拟注册表的所有键都来自同一个文件
+    QReadLocker locker(&m_lock);
+    return m_filePath.isEmpty() ? QString() : QFileInfo(m_filePath).absolutePath();
+}
+
+void FixtureRegistryBackend::refresh() {
+    QString filePath;
+    {
+        QReadLocker locker(&m_lock);
+        if (m_filePath.isEmpty()) {
+            return;
+        }
+        const QFileInfo info(m_filePath);
+        if (!info.exists() || (info.lastModified() == m_fileModified && info.size() == m_fileSize)) {
+            return;
+        }
+        filePath = m_filePath;
+    }
+    
+    // 文件被外部替换或改写，丢弃内存中的内容；格式错误（如正在写入）时保留旧内容
+    if (load(filePath)) {
+        LOG_INFO(QString("模拟注册表文件已变化，重新加载: %1").arg(filePath));
+    }
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "RegistryBackend.h"
+#include <QDateTime>
+#include <QHash>
+#include <QReadWriteLock>
+#include <QSet>
+
+// 内存中的模拟注册表，可从JSON文件加载和保存，
+// 用于在非Windows平台上测试和基准测量扫描与清理逻辑。
+//
+// 文件格式：{"keys": {"HKEY_...\\Sub\\Key": {"值名": 值, ...}, ...}}
+class FixtureRegistryBackend : public RegistryBackend {
+public:
+    FixtureRegistryBackend();
+    
+    bool load(const QString& filePath);
+    bool save(const QString& filePath) const;
+    
+    // 写入值，缺失的上级键会自动创建
+    void setValue(const QString& keyPath, const QString& name, const QVariant& value);
+    void setValues(const QString& keyPath, const QVariantHash& values);
+    void clear();
+    int keyCount() const;
+    
+    QStringList childKeys(const QString& keyPath) const override;
+    quint64 fingerprint(const QString& keyPath, const QString& subKey) const override;
+    bool readEntry(const QString& keyPath, const QString& subKey, RegistryEntry& entry) const override;
+    QVariantHash values(const QString& keyPath) const override;
+    int deleteTrees(const QStringList& keyPaths) override;
+    int deleteValues(const QString& keyPath, const QStringList& valueNames) override;
+    bool isNative() const override;
+    QString watchPath(const QString& keyPath) const override;
+    
+    // 文件的修改时间或大小与加载时不同则重新加载
+    void refresh() override;
+
+private:
+    struct Key {
+        QString path;            // 保留原始大小写的完整路径
+        QVariantHash values;
+        QStringList children;
+        quint64 fingerprint = 0;
+    };
+    
+    // 注册表路径不区分大小写
+    static QString normalize(const QString& keyPath);
+    Key& ensureKey(const QString& keyPath);
+    void assignValues(const QString& keyPath, const QVariantHash& values);
+    void removeTree(const QString& normalizedPath);
+    
+    mutable QReadWriteLock m_lock;
+    QHash<QString, Key> m_keys; // 规范化路径 -> 键
+    QString m_filePath;
+    QDateTime m_fileModified;   // 加载时文件的修改时间和大小
+    qint64 m_fileSize = -1;
+};
@@ -0,0 +1,473 @@
+#include "LeftoverScanner.h"
+#include "PathPrefixTrie.h"
+#include "Logger.h"
+#include <QDir>
+#include <QFileInfo>
+#include <QMutex>
+#include <QRegularExpression>
+#include <QSet>
+#include <QStandardPaths>
+#include <QThreadPool>
+#include <algorithm>
+
+namespace {
+
+// 在大量无关条目名中也会出现的词，不作为匹配依据
+bool isGenericWord(const QString& word) {
+    static const QSet<QString> genericWords = {
+        "app", "application", "apps", "client", "common", "data", "desktop", "edition",
+        "files", "free", "helper", "install", "installer", "launcher", "manager", "plugin",
+        "plugins", "program", "programs", "runtime", "service", "services", "settings",
+        "setup", "shared", "software", "studio", "system", "temp", "tool", "tools",
+        "update", "updater", "user", "version", "windows", "x64", "x86"
+    };
+    return genericWords.contains(word.toLower());
+}
+
+// 去掉名称末尾的版本号和括号说明，如"Foo 2.1 (x64)" -> "Foo"
+QString productBaseName(const QString& name) {
+    static const QRegularExpression suffix(QStringLiteral("\\s*(\\(.*\\)|\\bv?\\d+(\\.\\d+)+\\b).*$"));
+    return QString(name).remove(suffix).trimmed();
+}
+
+// 去掉发布商名称中的公司类型后缀，如"Foo Software, Inc." -> "Foo Software"
+QString publisherBaseName(const QString& publisher) {
+    static const QRegularExpression suffix(QStringLiteral("[,\\s]+(inc|ltd|llc|corp|corporation|co|gmbh|limited|ag|s\\.a)\\.?$"),
+                                           QRegularExpression::CaseInsensitiveOption);
+    QString base = publisher.trimmed();
+    for (;;) {
+        const QString stripped = QString(base).remove(suffix).trimmed();
+        if (stripped == base) {
+            return base;
+        }
+        base = stripped;
+    }
+}
+
+// 折叠大小写和分隔符，用于比较路径
+QString foldedPath(const QString& path) {
+    QString folded = QDir::cleanPath(path);
+    for (QChar& ch : folded) {
+        ch = QChar(PathPrefixTrie::fold(ch.unicode()));
+    }
+    while (folded.size() > 1 && folded.endsWith(QLatin1Char('\\'))) {
+        folded.chop(1);
+    }
+    return folded;
+}
+
+// 安装目录顶层的可执行文件名，卸载和安装程序除外
+QStringList executableNames(const ApplicationInfo& appInfo) {
+    QStringList names;
+    if (appInfo.installLocation.isEmpty()) {
+        return names;
+    }
+    
+    const QFileInfoList executables = QDir(appInfo.installLocation).entryInfoList({"*.exe"}, QDir::Files);
+    for (const QFileInfo& info : executables) {
+        const QString name = info.completeBaseName();
+        if (name.startsWith(QLatin1String("unins"), Qt::CaseInsensitive) ||
+            name.startsWith(QLatin1String("uninst"), Qt::CaseInsensitive)) {
+            continue;
+        }
+        names.append(name);
+    }
+    return names;
+}
+
+// 这些键下的子键数量巨大或属于系统组件，不展开第二层
+bool isOpaqueRegistryKey(const QString& name) {
+    static const QSet<QString> opaqueKeys = {
+        "classes", "clients", "microsoft", "policies", "registeredapplications", "wow6432node"
+    };
+    return opaqueKeys.contains(name.toLower());
+}
+
+} // namespace
+
+LeftoverScanner::LeftoverScanner(std::shared_ptr<RegistryBackend> registry)
+    : m_registry(std::move(registry))
+    , m_directoryRoots(defaultDirectoryRoots())
+    , m_stopFlag(nullptr)
+    , m_applicationCount(0)
+{
+}
+
+void LeftoverScanner::setDirectoryRoots(const QStringList& roots) {
+    m_directoryRoots = roots;
+}
+
+void LeftoverScanner::setInstalledApplications(const QList<ApplicationInfo>& applications) {
+    m_installedApplications = applications;
+}
+
+void LeftoverScanner::setStopFlag(const std::atomic<bool>* stopFlag) {
+    m_stopFlag = stopFlag;
+}
+
+QStringList LeftoverScanner::defaultDirectoryRoots() {
+    QStringList roots;
+#ifdef Q_OS_WIN
+    for (const char* variable : {"LOCALAPPDATA", "APPDATA", "ProgramData"}) {
+        const QString value = qEnvironmentVariable(variable);
+        if (!value.isEmpty()) {
+            roots << QDir::fromNativeSeparators(value);
+        }
+    }
+#else
+    roots << QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation)
+          << QStandardPaths::writableLocation(QStandardPaths::GenericConfigLocation)
+          << QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation);
+#endif
+    roots << QStandardPaths::writableLocation(QStandardPaths::TempLocation);
+    roots.removeAll(QString());
+    roots.removeDuplicates();
+    return roots;
+}
+
+QStringList LeftoverScanner::defaultRegistryRoots() {
+    return {
+        "HKEY_CURRENT_USER\\SOFTWARE",
+        "HKEY_LOCAL_MACHINE\\SOFTWARE",
+        "HKEY_LOCAL_MACHINE\\SOFTWARE\\WOW6432Node"
+    };
+}
+
+void LeftoverScanner::buildPatterns(const QList<ApplicationInfo>& applications) {
+    QStringList patterns;
+    QStringList installPatterns;
+    m_tokens.clear();
+    m_installPathOwners.clear();
+    m_installPaths.clear();
+    
+    auto addToken = [&](int application, const QString& text, Evidence evidence, int minimumLength) {
+        const QString token = text.trimmed();
+        if (token.size() < minimumLength || isGenericWord(token)) {
+            return;
+        }
+        patterns.append(token);
+        m_tokens.append({application, static_cast<int>(token.size()), evidence});
+    };
+    
+    static const QRegularExpression separators(QStringLiteral("[^\\w]+"));
+    static const QRegularExpression digits(QStringLiteral("^\\d+$"));
+    
+    // 其他已安装的应用排在待卸载的应用之后，与其匹配的位置不归属任何应用
+    QList<ApplicationInfo> owners = applications;
+    QSet<QString> selectedKeys;
+    for (const ApplicationInfo& appInfo : applications) {
+        selectedKeys.insert(appInfo.registryKey().toLower());
+    }
+    m_applicationCount = static_cast<int>(applications.size());
+    for (const ApplicationInfo& appInfo : m_installedApplications) {
+        if (!selectedKeys.contains(appInfo.registryKey().toLower())) {
+            owners.append(appInfo);
+        }
+    }
+    
+    for (int i = 0; i < owners.size(); ++i) {
+        const ApplicationInfo& appInfo = owners[i];
+        const bool selected = i < m_applicationCount;
+        
+        // 产品名称及去掉空格的写法
+        const QString product = productBaseName(appInfo.name);
+        addToken(i, product, ProductName, 3);
+        QString compact = product;
+        compact.remove(QLatin1Char(' '));
+        if (compact != product) {
+            addToken(i, compact, ProductName, 3);
+        }
+        
+        // 多个词组成的名称再按单词匹配
+        const QStringList words = product.split(separators, Qt::SkipEmptyParts);
+        if (words.size() > 1) {
+            for (const QString& word : words) {
+                if (!digits.match(word).hasMatch()) {
+                    addToken(i, word, ProductWord, 4);
+                }
+            }
+        }
+        
+        // 列出可执行文件需要读取安装目录，其他已安装的应用数量多，只按名称和发布商排除
+        const QStringList executables = selected ? executableNames(appInfo) : QStringList();
+        for (const QString& executable : executables) {
+            if (executable.compare(product, Qt::CaseInsensitive) != 0) {
+                addToken(i, executable, ExecutableName, 4);
+            }
+        }
+        
+        addToken(i, publisherBaseName(appInfo.publisher), Publisher, 3);
+        
+        if (!appInfo.installLocation.isEmpty()) {
+            const QString installPath = QDir::cleanPath(appInfo.installLocation);
+            m_installPaths.insert(foldedPath(installPath), i);
+            
+            // 注册表值中的路径可能使用任一种分隔符
+            if (selected) {
+                installPatterns << installPath << QDir::toNativeSeparators(installPath);
+                m_installPathOwners << i << i;
+            }
+        }
+    }
+    
+    m_nameAutomaton.build(patterns);
+    m_installPathAutomaton.build(installPatterns);
+}
+
+QVector<LeftoverScanner::Match> LeftoverScanner::matchName(QStringView name) const {
+    QVector<Match> matches;
+    m_nameAutomaton.forEachMatch(name, [&](int pattern, qsizetype) {
+        const Token& token = m_tokens[pattern];
+        const bool exact = token.length == name.size();
+        
+        int score = 0;
+        const char* reason = nullptr;
+        switch (token.evidence) {
+            case ProductName:
+                score = exact ? 90 : 70;
+                reason = exact ? "与产品名称相同" : "名称包含产品名称";
+                break;
+            case ExecutableName:
+                score = exact ? 75 : 60;
+                reason = exact ? "与可执行文件同名" : "名称包含可执行文件名";
+                break;
+            case ProductWord:
+                score = exact ? 55 : 35;
+                reason = exact ? "与产品名称中的词相同" : "名称包含产品名称中的词";
+                break;
+            case Publisher:
+                score = exact ? 55 : 30;
+                reason = exact ? "与发布商名称相同" : "名称包含发布商名称";
+                break;
+        }
+        
+        // 同一应用只保留得分最高的依据
+        for (Match& match : matches) {
+            if (match.application == token.application) {
+                if (score > match.score) {
+                    match = {token.application, score, token.evidence, exact, reason};
+                }
+                return;
+            }
+        }
+        matches.append({token.application, score, token.evidence, exact, reason});
+    });
+    return matches;
+}
+
+void LeftoverScanner::collect(const QString& location, LeftoverCandidate::Kind kind, const QVector<Match>& matches,
+                              const QVector<Match>& parentMatches, QList<LeftoverCandidate>& results) const {
+    LeftoverCandidate best;
+    bool tied = false;
+    for (const Match& match : matches) {
+        if (match.application >= m_applicationCount) {
+            continue;
+        }
+        
+        int score = match.score;
+        QString reason = QString::fromUtf8(match.reason);
+        
+        // 位于同一应用发布商目录下的产品匹配更可信
+        if (match.evidence != Publisher) {
+            for (const Match& parent : parentMatches) {
+                if (parent.application == match.application && parent.evidence == Publisher) {
+                    score = qMin(95, score + 20);
+                    reason += QString::fromUtf8("，位于发布商目录下");
+                    break;
+                }
+            }
+        }
+        
+        // 只有与产品名称完全相同才足以自动删除，可执行文件名、部分名称和发布商目录只作佐证
+        if (match.evidence != ProductName || !match.exact) {
+            score = qMin(score, 79);
+        }
+        
+        if (score > best.score) {
+            best.application = match.application;
+            best.score = score;
+            best.reason = reason;
+            tied = false;
+        } else if (score == best.score) {
+            tied = true;
+        }
+    }
+    
+    if (best.application < 0) {
+        return;
+    }
+    
+    // 无法确定归属的位置不自动删除
+    if (tied) {
+        best.score = qMin(best.score, 50);
+        best.reason += QString::fromUtf8("（多个应用匹配）");
+    } else if (matchesOtherApplication(matches)) {
+        best.score = qMin(best.score, 50);
+        best.reason += QString::fromUtf8("（也匹配其他已安装的应用）");
+    }
+    best.location = location;
+    best.kind = kind;
+    results.append(best);
+}
+
+void LeftoverScanner::scanDirectory(const QString& path, const QVector<Match>& parentMatches,
+                                    QList<LeftoverCandidate>& results, QVector<Child>* children) const {
+    const QFileInfoList entries = QDir(path).entryInfoList(QDir::AllEntries | QDir::Hidden | QDir::System |
+                                                           QDir::NoDotAndDotDot);
+    for (const QFileInfo& info : entries) {
+        if (m_stopFlag && m_stopFlag->load()) {
+            return;
+        }
+        
+        const QString entryPath = info.absoluteFilePath();
+        const bool isDirectory = info.isDir() && !info.isSymLink();
+        
+        auto owner = m_installPaths.constFind(foldedPath(entryPath));
+        if (owner != m_installPaths.constEnd()) {
+            // 其他已安装应用的安装目录既不是残留，也不再展开
+            if (owner.value() >= m_applicationCount) {
+                continue;
+            }
+            LeftoverCandidate candidate;
+            candidate.location = entryPath;
+            candidate.reason = QString::fromUtf8("安装目录");
+            candidate.application = owner.value();
+            candidate.score = 100;
+            candidate.kind = LeftoverCandidate::Directory;
+            results.append(candidate);
+            continue;
+        }
+        
+        // 文件按去掉扩展名后的名称判断是否同名
+        const QVector<Match> matches = matchName(isDirectory ? info.fileName() : info.completeBaseName());
+        const qsizetype before = results.size();
+        collect(entryPath, isDirectory ? LeftoverCandidate::Directory : LeftoverCandidate::File,
+                matches, parentMatches, results);
+        
+        const bool claimed = results.size() > before && results.last().confidence() == LeftoverCandidate::High;
+        if (children && isDirectory && !claimed) {
+            children->append({entryPath, matches});
+        }
+    }
+}
+
+void LeftoverScanner::scanRegistryKey(const QString& keyPath, const QVector<Match>& parentMatches,
+                                      QList<LeftoverCandidate>& results, QVector<Child>* children) const {
+    const QStringList childKeys = m_registry->childKeys(keyPath);
+    for (const QString& child : childKeys) {
+        if (m_stopFlag && m_stopFlag->load()) {
+            return;
+        }
+        
+        const QString childPath = keyPath + "\\" + child;
+        const QVector<Match> matches = matchName(child);
+        const qsizetype before = results.size();
+        collect(childPath, LeftoverCandidate::RegistryKey, matches, parentMatches, results);
+        
+        bool claimed = false;
+        if (results.size() > before) {
+            // 键值引用了该应用的安装目录
+            LeftoverCandidate& candidate = results.last();
+            if (candidate.score < 95 && !matchesOtherApplication(matches) &&
+                referencesInstallPath(childPath, candidate.application)) {
+                candidate.score = 95;
+                candidate.reason = QString::fromUtf8("键值引用安装目录");
+            }
+            claimed = candidate.confidence() == LeftoverCandidate::High;
+        }
+        
+        if (children && !claimed && !isOpaqueRegistryKey(child)) {
+            children->append({childPath, matches});
+        }
+    }
+}
+
+bool LeftoverScanner::referencesInstallPath(const QString& keyPath, int application) const {
+    if (m_installPathAutomaton.isEmpty()) {
+        return false;
+    }
+    
+    const QVariantHash values = m_registry->values(keyPath);
+    for (auto it = values.constBegin(); it != values.constEnd(); ++it) {
+        bool found = false;
+        m_installPathAutomaton.forEachMatch(it.value().toString(), [&](int pattern, qsizetype) {
+            found = found || m_installPathOwners[pattern] == application;
+        });
+        if (found) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool LeftoverScanner::matchesOtherApplication(const QVector<Match>& matches) const {
+    for (const Match& match : matches) {
+        if (match.application >= m_applicationCount && match.score >= 50) {
+            return true;
+        }
+    }
+    return false;
+}
+
+QList<LeftoverCandidate> LeftoverScanner::scan(const QList<ApplicationInfo>& applications, int targets) {
+    QList<LeftoverCandidate> results;
+    buildPatterns(applications);
+    if (m_nameAutomaton.isEmpty() && m_installPaths.isEmpty()) {
+        return results;
+    }
+    
+    QMutex resultMutex;
+    auto publish = [&](const QList<LeftoverCandidate>& local) {
+        if (!local.isEmpty()) {
+            QMutexLocker locker(&resultMutex);
+            results.append(local);
+        }
+    };
+    
+    // 每个根作为一个任务匹配第一层，未被高置信度认领的子目录和子键再各自作为任务匹配第二层
+    QThreadPool pool;
+    auto visitRoot = [this, &pool, &publish](const QString& root, bool registry) {
+        QList<LeftoverCandidate> local;
+        QVector<Child> children;
+        if (registry) {
+            scanRegistryKey(root, QVector<Match>(), local, &children);
+        } else {
+            scanDirectory(root, QVector<Match>(), local, &children);
+        }
+        publish(local);
+        
+        for (const Child& child : children) {
+            pool.start([this, child, registry, &publish]() {
+                if (m_stopFlag && m_stopFlag->load()) {
+                    return;
+                }
+                QList<LeftoverCandidate> nested;
+                if (registry) {
+                    scanRegistryKey(child.location, child.matches, nested, nullptr);
+                } else {
+                    scanDirectory(child.location, child.matches, nested, nullptr);
+                }
+                publish(nested);
+            });
+        }
+    };
+    
+    if (targets & Files) {
+        for (const QString& root : m_directoryRoots) {
+            pool.start([&visitRoot, root]() { visitRoot(root, false); });
+        }
+    }
+    if ((targets & Registry) && m_registry) {
+        for (const QString& root : defaultRegistryRoots()) {
+            pool.start([&visitRoot, root]() { visitRoot(root, true); });
+        }
+    }
+    pool.waitForDone();
+    
+    std::stable_sort(results.begin(), results.end(), [](const LeftoverCandidate& a, const LeftoverCandidate& b) {
+        return a.score > b.score;
+    });
+    
+    LOG_INFO(QString("残留扫描完成: %1 个应用，发现 %2 处候选").arg(applications.size()).arg(results.size()));
+    return results;
+}
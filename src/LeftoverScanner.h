@@ -0,0 +1,128 @@
+#pragma once
+
+#include "AppScanner.h"
+#include "PatternAutomaton.h"
+#include "RegistryBackend.h"
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <atomic>
+#include <memory>
+
+// 发现的一处残留
+struct LeftoverCandidate {
+    enum Kind : quint8 {
+        File,
+        Directory,
+        RegistryKey
+    };
+    
+    enum Confidence : quint8 {
+        Low,      // 只是名称中出现了某个词，仅供参考
+        Medium,   // 与可执行文件或发布商同名、多个应用都匹配或也属于其他已安装的应用，需要人工确认
+        High      // 与产品同名或引用安装目录，可随深度清理删除
+    };
+    
+    QString location;      // 文件系统路径或完整注册表键路径
+    QString reason;
+    int application = -1;  // 在扫描的应用列表中的下标
+    int score = 0;         // 0-100
+    Kind kind = File;
+    
+    Confidence confidence() const {
+        return score >= 80 ? High : (score >= 50 ? Medium : Low);
+    }
+};
+
+// 残留发现：一次并行遍历AppData、ProgramData、Temp下两层条目以及各Software键下两层子键，
+// 同时为所有待卸载的应用匹配。所有应用的产品名、可执行文件名、发布商和名称中的词
+// 编入一个多模式匹配自动机，每个条目名只扫描一遍，耗时与遍历的条目数成正比而与应用数无关。
+// 一处位置只归属得分最高的应用；两个应用得分相同，或同时匹配未被卸载的已安装应用时降为中等置信度。
+class LeftoverScanner {
+public:
+    enum Target {
+        Files = 0x1,
+        Registry = 0x2,
+        All = Files | Registry
+    };
+    
+    explicit LeftoverScanner(std::shared_ptr<RegistryBackend> registry);
+    
+    // 替换遍历的目录（默认为defaultDirectoryRoots()）
+    void setDirectoryRoots(const QStringList& roots);
+    
+    // 其他已安装的应用，不参与归属，只用于排除共享的位置（默认为空）
+    void setInstalledApplications(const QList<ApplicationInfo>& applications);
+    
+    // 置位后不再开始新的目录
+    void setStopFlag(const std::atomic<bool>* stopFlag);
+    
+    // 为所有应用查找残留，结果按得分从高到低排列
+    QList<LeftoverCandidate> scan(const QList<ApplicationInfo>& applications, int targets = All);
+    
+    // 本地和漫游AppData、ProgramData、临时目录
+    static QStringList defaultDirectoryRoots();
+    
+    // HKCU和HKLM的Software键（含32位视图）
+    static QStringList defaultRegistryRoots();
+
+private:
+    enum Evidence : quint8 {
+        ProductName,
+        ExecutableName,
+        ProductWord,
+        Publisher
+    };
+    
+    struct Token {
+        int application;
+        int length;
+        Evidence evidence;
+    };
+    
+    // 一个名称对一个应用的最佳匹配
+    struct Match {
+        int application;
+        int score;
+        Evidence evidence;
+        bool exact;          // 整个名称与模式相同
+        const char* reason;
+    };
+    
+    // 需要展开下一层的条目及其名称的匹配
+    struct Child {
+        QString location;
+        QVector<Match> matches;
+    };
+    
+    void buildPatterns(const QList<ApplicationInfo>& applications);
+    QVector<Match> matchName(QStringView name) const;
+    
+    // parentMatches为父条目的匹配，在发布商目录下与产品匹配的条目得分更高
+    void collect(const QString& location, LeftoverCandidate::Kind kind, const QVector<Match>& matches,
+                 const QVector<Match>& parentMatches, QList<LeftoverCandidate>& results) const;
+    
+    // 匹配一层条目；children非空时收集未被高置信度认领、需要继续展开的子目录或子键
+    void scanDirectory(const QString& path, const QVector<Match>& parentMatches,
+                       QList<LeftoverCandidate>& results, QVector<Child>* children) const;
+    void scanRegistryKey(const QString& keyPath, const QVector<Match>& parentMatches,
+                         QList<LeftoverCandidate>& results, QVector<Child>* children) const;
+    bool referencesInstallPath(const QString& keyPath, int application) const;
+    
+    // 是否有未被卸载的已安装应用也以中等以上的得分匹配
+    bool matchesOtherApplication(const QVector<Match>& matches) const;
+    
+    std::shared_ptr<RegistryBackend> m_registry;
+    QStringList m_directoryRoots;
+    const std::atomic<bool>* m_stopFlag;
+    QList<ApplicationInfo> m_installedApplications;
+    
+    int m_applicationCount;                  // 下标不小于此值的是其他已安装的应用
+    PatternAutomaton m_nameAutomaton;
+    QVector<Token> m_tokens;                 // 与自动机中的模式一一对应
+    PatternAutomaton m_installPathAutomaton;
+    QVector<int> m_installPathOwners;        // 安装目录模式 -> 应用下标
+    QHash<QString, int> m_installPaths;      // 折叠后的安装目录 -> 应用下标（含其他已安装的应用）
+};
@@ -28,6 +28,8 @@ Logger::~Logger() {
 }
 
 void Logger::setLogFile(const QString& filename) {
+    QMutexLocker locker(&m_mutex);
+    
     if (m_logFile) {
         m_logFile->close();
         delete m_logFile;
@@ -48,6 +50,7 @@ void Logger::setLogFile(const QString& filename) {
 
 void Logger::log(LogLevel level, const QString& message) {
     QString formattedMessage = formatMessage(level, message);
+    QMutexLocker locker(&m_mutex);
     
     // 输出到控制台
     qDebug() << formattedMessage;
@@ -88,6 +91,8 @@ QString Logger::getLogContent() const {
 }
 
 void Logger::clearLog() {
+    QMutexLocker locker(&m_mutex);
+    
     if (m_logFile) {
         m_logFile->close();
         m_logFile->remove();
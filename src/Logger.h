@@ -6,6 +6,7 @@
 #include <QFile>
 #include <QDir>
 #include <QStandardPaths>
+#include <QMutex>
 
 enum class LogLevel {
     Debug,
@@ -32,6 +33,7 @@ private:
     QFile* m_logFile;
     QString m_logPath;
     QTextStream* m_logStream;
+    QMutex m_mutex;  // 多个工作线程同时写日志
 };
 
 // 便利宏
@@ -0,0 +1,107 @@
+#include "PathPrefixTrie.h"
+#include <QChar>
+
+PathPrefixTrie::PathPrefixTrie() {
+    clear();
+}
+
+char16_t PathPrefixTrie::fold(char16_t ch) {
+    if (ch == u'/') {
+        return u'\\';
+    }
+    return static_cast<char16_t>(QChar::toCaseFolded(static_cast<char32_t>(ch)));
+}
+
+void PathPrefixTrie::insert(QStringView prefix) {
+    int node = 0;
+    for (QChar ch : prefix) {
+        const quint64 key = edgeKey(node, fold(ch.unicode()));
+        auto it = m_edges.constFind(key);
+        if (it != m_edges.constEnd()) {
+            node = it.value();
+            continue;
+        }
+        
+        const int child = static_cast<int>(m_terminal.size());
+        m_terminal.append(false);
+        m_edges.insert(key, child);
+        node = child;
+    }
+    m_terminal[node] = true;
+}
+
+void PathPrefixTrie::clear() {
+    m_edges.clear();
+    m_terminal.clear();
+    m_terminal.append(false); // 根节点
+}
+
+bool PathPrefixTrie::isEmpty() const {
+    return m_edges.isEmpty() && !m_terminal[0];
+}
+
+bool PathPrefixTrie::matchesPrefix(QStringView path) const {
+    int node = 0;
+    if (m_terminal[node]) {
+        return true;
+    }
+    
+    for (QChar ch : path) {
+        auto it = m_edges.constFind(edgeKey(node, fold(ch.unicode())));
+        if (it == m_edges.constEnd()) {
+            return false;
+        }
+        node = it.value();
+        if (m_terminal[node]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool PathPrefixTrie::hasPrefixBelow(QStringView directory) const {
+    // 每个节点都位于某个前缀的路径上，能走完"目录+分隔符"即说明其下存在前缀
+    int node = 0;
+    for (QChar ch : directory) {
+        auto it = m_edges.constFind(edgeKey(node, fold(ch.unicode())));
+        if (it == m_edges.constEnd()) {
+            return false;
+        }
+        node = it.value();
+    }
+    
+    if (directory.endsWith(u'/') || directory.endsWith(u'\\')) {
+        return true;
+    }
+    return m_edges.contains(edgeKey(node, u'\\'));
+}
+
+quint64 FoldedNameSet::foldedHash(QStringView name) {
+    // FNV-1a，逐字符折叠后计算
+    quint64 hash = 14695981039346656037ULL;
+    for (QChar ch : name) {
+        hash ^= PathPrefixTrie::fold(ch.unicode());
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+void FoldedNameSet::insert(QStringView name) {
+    if (!contains(name)) {
+        m_names.insert(foldedHash(name), name.toString());
+    }
+}
+
+void FoldedNameSet::clear() {
+    m_names.clear();
+}
+
+bool FoldedNameSet::contains(QStringView name) const {
+    const quint64 hash = foldedHash(name);
+    for (auto it = m_names.constFind(hash); it != m_names.constEnd() && it.key() == hash; ++it) {
+        if (QStringView(it.value()).compare(name, Qt::CaseInsensitive) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
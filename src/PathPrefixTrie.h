@@ -0,0 +1,48 @@
+#pragma once
+
+#include <QHash>
+#include <QString>
+#include <QStringView>
+#include <QVector>
+
+// 路径前缀树：插入时预先折叠大小写并统一分隔符（'/'与'\\'等价），
+// 查询逐字符沿树前进，耗时与路径长度成正比且不分配内存。
+// 匹配语义与折叠后的QString::startsWith一致。
+class PathPrefixTrie {
+public:
+    PathPrefixTrie();
+    
+    void insert(QStringView prefix);
+    void clear();
+    bool isEmpty() const;
+    
+    // 路径是否以任一已插入的前缀开头
+    bool matchesPrefix(QStringView path) const;
+    
+    // 是否有已插入的前缀位于目录directory之下（以directory加分隔符开头）
+    bool hasPrefixBelow(QStringView directory) const;
+    
+    // 折叠单个UTF-16码元：转为小写折叠形式，'/'统一为'\\'
+    static char16_t fold(char16_t ch);
+
+private:
+    static quint64 edgeKey(int node, char16_t ch) {
+        return (static_cast<quint64>(node) << 16) | ch;
+    }
+    
+    QVector<bool> m_terminal;     // 节点是否为某个前缀的结尾
+    QHash<quint64, int> m_edges;  // (节点, 字符) -> 子节点
+};
+
+// 大小写不敏感的名称集合：按折叠后的哈希值存储，查询时不构造临时字符串
+class FoldedNameSet {
+public:
+    void insert(QStringView name);
+    void clear();
+    bool contains(QStringView name) const;
+
+private:
+    static quint64 foldedHash(QStringView name);
+    
+    QMultiHash<quint64, QString> m_names;
+};
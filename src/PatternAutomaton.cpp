@@ -0,0 +1,114 @@
+#include "PatternAutomaton.h"
+#include <QChar>
+#include <QQueue>
+
+char16_t PatternAutomaton::fold(char16_t ch) {
+    return static_cast<char16_t>(QChar::toCaseFolded(static_cast<char32_t>(ch)));
+}
+
+PatternAutomaton::PatternAutomaton()
+    : m_patternCount(0)
+{
+    m_nodes.append(Node());
+}
+
+void PatternAutomaton::build(const QStringList& patterns) {
+    m_nodes.clear();
+    m_edges.clear();
+    m_nodes.append(Node());
+    m_samePattern.fill(-1, patterns.size());
+    m_patternCount = 0;
+    
+    // 1. 插入所有模式构成字典树
+    QHash<int, QVector<QPair<char16_t, int>>> children;
+    for (int index = 0; index < patterns.size(); ++index) {
+        const QString& pattern = patterns[index];
+        if (pattern.isEmpty()) {
+            continue;
+        }
+        
+        int node = 0;
+        for (QChar ch : pattern) {
+            const char16_t folded = fold(ch.unicode());
+            auto it = m_edges.constFind(edgeKey(node, folded));
+            if (it != m_edges.constEnd()) {
+                node = it.value();
+                continue;
+            }
+            
+            const int child = static_cast<int>(m_nodes.size());
+            m_nodes.append(Node());
+            m_edges.insert(edgeKey(node, folded), child);
+            children[node].append(qMakePair(folded, child));
+            node = child;
+        }
+        
+        if (m_nodes[node].output < 0) {
+            m_nodes[node].output = index;
+        }
+        m_samePattern[index] = m_nodes[node].terminal;
+        m_nodes[node].terminal = index;
+        ++m_patternCount;
+    }
+    
+    // 2. 按层次遍历计算失配链接，并沿失配链合并输出
+    QQueue<int> queue;
+    for (const auto& edge : children.value(0)) {
+        m_nodes[edge.second].fail = 0;
+        queue.enqueue(edge.second);
+    }
+    
+    while (!queue.isEmpty()) {
+        const int node = queue.dequeue();
+        for (const auto& edge : children.value(node)) {
+            const int child = edge.second;
+            const int fail = step(m_nodes[node].fail, edge.first);
+            m_nodes[child].fail = fail;
+            m_nodes[child].dictionary = m_nodes[fail].terminal >= 0 ? fail : m_nodes[fail].dictionary;
+            if (m_nodes[child].output < 0) {
+                m_nodes[child].output = m_nodes[fail].output;
+            }
+            queue.enqueue(child);
+        }
+    }
+}
+
+bool PatternAutomaton::isEmpty() const {
+    return m_patternCount == 0;
+}
+
+int PatternAutomaton::patternCount() const {
+    return m_patternCount;
+}
+
+int PatternAutomaton::step(int node, char16_t ch) const {
+    for (;;) {
+        auto it = m_edges.constFind(edgeKey(node, ch));
+        if (it != m_edges.constEnd()) {
+            return it.value();
+        }
+        if (node == 0) {
+            return 0;
+        }
+        node = m_nodes[node].fail;
+    }
+}
+
+bool PatternAutomaton::matches(QStringView text) const {
+    return firstMatch(text) >= 0;
+}
+
+int PatternAutomaton::firstMatch(QStringView text) const {
+    if (m_patternCount == 0) {
+        return -1;
+    }
+    
+    int node = 0;
+    for (QChar ch : text) {
+        node = step(node, fold(ch.unicode()));
+        if (m_nodes[node].output >= 0) {
+            return m_nodes[node].output;
+        }
+    }
+    return -1;
+}
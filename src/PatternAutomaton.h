@@ -0,0 +1,65 @@
+#pragma once
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QStringView>
+#include <QVector>
+
+// 多模式匹配自动机（Aho-Corasick）：在大小写折叠后的文本中查找任一模式的出现。
+// 构建后只读，可被多线程同时查询；单次查询耗时与文本长度成正比，与模式数量无关。
+class PatternAutomaton {
+public:
+    PatternAutomaton();
+    
+    // 用一组模式重新构建自动机，空模式被忽略
+    void build(const QStringList& patterns);
+    
+    bool isEmpty() const;
+    int patternCount() const;
+    
+    // 文本中是否包含任一模式（等价于逐个contains(pattern, Qt::CaseInsensitive)）
+    bool matches(QStringView text) const;
+    
+    // 文本中最先结束的匹配对应的模式下标，无匹配时返回-1
+    int firstMatch(QStringView text) const;
+    
+    // 报告文本中的每一处匹配：visitor(模式下标, 匹配结束位置)。
+    // 重叠的匹配和内容相同的多个模式都会分别报告，耗时与文本长度加匹配数成正比
+    template <typename Visitor>
+    void forEachMatch(QStringView text, Visitor visitor) const {
+        if (m_patternCount == 0) {
+            return;
+        }
+        
+        int node = 0;
+        for (qsizetype i = 0; i < text.size(); ++i) {
+            node = step(node, fold(text[i].unicode()));
+            for (int n = node; n > 0; n = m_nodes[n].dictionary) {
+                for (int pattern = m_nodes[n].terminal; pattern >= 0; pattern = m_samePattern[pattern]) {
+                    visitor(pattern, i + 1);
+                }
+            }
+        }
+    }
+
+private:
+    struct Node {
+        int fail = 0;         // 失配时跳转的节点
+        int output = -1;      // 在此节点结束的模式（含经失配链可达的），-1表示无
+        int terminal = -1;    // 恰好在此节点结束的模式，-1表示无
+        int dictionary = 0;   // 失配链上最近的有模式恰好结束的节点，0表示无
+    };
+    
+    static quint64 edgeKey(int node, char16_t ch) {
+        return (static_cast<quint64>(node) << 16) | ch;
+    }
+    
+    static char16_t fold(char16_t ch);
+    int step(int node, char16_t ch) const;
+    
+    QVector<Node> m_nodes;
+    QHash<quint64, int> m_edges;  // (节点, 折叠字符) -> 子节点
+    QVector<int> m_samePattern;   // 与该模式结束于同一节点的下一个模式，-1表示无
+    int m_patternCount;
+};
@@ -0,0 +1,383 @@
+#include "ProcessSupervisor.h"
+#include "Logger.h"
+#include <QProcess>
+#include <QSemaphore>
+#include <QTimer>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#include <vector>
+#else
+#include <signal.h>
+#include <unistd.h>
+#endif
+
+struct ProcessSupervisor::Job {
+    QString command;
+    Options options;
+    QString program;
+    QStringList arguments;
+    
+    QProcess* process = nullptr;
+    QTimer* idleTimer = nullptr;
+    QByteArray outputBuffer;  // 尚未构成完整一行的输出
+    QByteArray errorBuffer;
+    
+    Result result;
+    bool done = false;
+    QSemaphore finished;      // 任务结束时释放，run在此等待
+    
+#ifdef Q_OS_WIN
+    HANDLE jobObject = nullptr;            // 进程及其启动的所有子进程
+    std::vector<char> attributeList;       // 创建进程时指定作业对象的属性列表
+    STARTUPINFOEXW startupInfo;
+#endif
+};
+
+namespace {
+
+#ifdef Q_OS_WIN
+
+// 作业对象的最后一个句柄关闭时结束其中所有进程，本程序异常退出时卸载程序也不会遗留
+HANDLE createKillOnCloseJob() {
+    HANDLE jobObject = CreateJobObjectW(nullptr, nullptr);
+    if (!jobObject) {
+        return nullptr;
+    }
+    
+    JOBOBJECT_EXTENDED_LIMIT_INFORMATION limits = {};
+    limits.BasicLimitInformation.LimitFlags = JOB_OBJECT_LIMIT_KILL_ON_JOB_CLOSE;
+    if (!SetInformationJobObject(jobObject, JobObjectExtendedLimitInformation, &limits, sizeof(limits))) {
+        CloseHandle(jobObject);
+        return nullptr;
+    }
+    return jobObject;
+}
+
+#endif
+
+} // namespace
+
+ProcessSupervisor::ProcessSupervisor()
+    : m_maxConcurrent(2)
+{
+    const QStringList shell = defaultShell();
+    m_shellProgram = shell.first();
+    m_shellArguments = shell.mid(1);
+    
+    m_thread.setObjectName("ProcessSupervisor");
+    moveToThread(&m_thread);
+    m_thread.start();
+}
+
+ProcessSupervisor::~ProcessSupervisor() {
+    cancelAll();
+    m_thread.quit();
+    m_thread.wait();
+}
+
+void ProcessSupervisor::setMaxConcurrent(int count) {
+    {
+        QMutexLocker locker(&m_mutex);
+        m_maxConcurrent = qMax(1, count);
+    }
+    // 上限提高后可能有排队的任务可以开始
+    QMetaObject::invokeMethod(this, &ProcessSupervisor::startPending, Qt::QueuedConnection);
+}
+
+void ProcessSupervisor::setShell(const QString& program, const QStringList& arguments) {
+    QMutexLocker locker(&m_mutex);
+    m_shellProgram = program;
+    m_shellArguments = arguments;
+}
+
+QStringList ProcessSupervisor::defaultShell() {
+    const QStringList configured = qEnvironmentVariable("BTU_UNINSTALL_SHELL").split(' ', Qt::SkipEmptyParts);
+    if (!configured.isEmpty()) {
+        return configured;
+    }
+#ifdef Q_OS_WIN
+    return {"cmd.exe", "/c"};
+#else
+    return {"/bin/sh", "-c"};
+#endif
+}
+
+ProcessSupervisor::Result ProcessSupervisor::run(const QString& command, const Options& options) {
+    Q_ASSERT(QThread::currentThread() != &m_thread);
+    
+    auto job = std::make_shared<Job>();
+    job->command = command;
+    job->options = options;
+    {
+        QMutexLocker locker(&m_mutex);
+        job->program = m_shellProgram;
+        job->arguments = m_shellArguments;
+        job->arguments << command;
+        m_pending.enqueue(job);
+    }
+    
+    QMetaObject::invokeMethod(this, &ProcessSupervisor::startPending, Qt::QueuedConnection);
+    job->finished.acquire();
+    return job->result;
+}
+
+void ProcessSupervisor::cancelAll() {
+    // 排队的任务直接取消
+    QQueue<std::shared_ptr<Job>> pending;
+    {
+        QMutexLocker locker(&m_mutex);
+        pending.swap(m_pending);
+    }
+    for (const std::shared_ptr<Job>& job : pending) {
+        job->result.status = Result::Cancelled;
+        job->done = true;
+        job->finished.release();
+    }
+    
+    // 运行中的进程在监管线程中结束，等待其完成
+    if (QThread::currentThread() == &m_thread) {
+        cancelRunning();
+    } else if (m_thread.isRunning()) {
+        QMetaObject::invokeMethod(this, &ProcessSupervisor::cancelRunning, Qt::BlockingQueuedConnection);
+    }
+}
+
+void ProcessSupervisor::cancelRunning() {
+    const QList<std::shared_ptr<Job>> running = m_running;
+    for (const std::shared_ptr<Job>& job : running) {
+        finish(job, Result::Cancelled);
+    }
+}
+
+void ProcessSupervisor::startPending() {
+    for (;;) {
+        std::shared_ptr<Job> job;
+        {
+            QMutexLocker locker(&m_mutex);
+            if (m_pending.isEmpty() || m_running.size() >= m_maxConcurrent) {
+                return;
+            }
+            job = m_pending.dequeue();
+        }
+        launch(job);
+    }
+}
+
+void ProcessSupervisor::launch(const std::shared_ptr<Job>& job) {
+    QProcess* process = new QProcess(this);
+    process->setProgram(job->program);
+    process->setArguments(job->arguments);
+    job->process = process;
+    
+    // shell只是启动卸载程序，结束时必须连同它启动的整个进程树一起结束
+#ifdef Q_OS_WIN
+    job->jobObject = createKillOnCloseJob();
+#ifdef PROC_THREAD_ATTRIBUTE_JOB_LIST
+    if (job->jobObject) {
+        // 创建时即加入作业，子进程没有在加入之前逃逸的机会（Windows 10起）
+        process->setCreateProcessArgumentsModifier([job](QProcess::CreateProcessArguments* args) {
+            SIZE_T size = 0;
+            InitializeProcThreadAttributeList(nullptr, 1, 0, &size);
+            job->attributeList.assign(size, 0);
+            auto* attributes = reinterpret_cast<LPPROC_THREAD_ATTRIBUTE_LIST>(job->attributeList.data());
+            if (!InitializeProcThreadAttributeList(attributes, 1, 0, &size)) {
+                job->attributeList.clear();
+                return;
+            }
+            if (!UpdateProcThreadAttribute(attributes, 0, PROC_THREAD_ATTRIBUTE_JOB_LIST, &job->jobObject,
+                                           sizeof(HANDLE), nullptr, nullptr)) {
+                DeleteProcThreadAttributeList(attributes);
+                job->attributeList.clear();
+                return;
+            }
+            
+            ZeroMemory(&job->startupInfo, sizeof(job->startupInfo));
+            job->startupInfo.StartupInfo = *args->startupInfo;
+            job->startupInfo.StartupInfo.cb = sizeof(STARTUPINFOEXW);
+            job->startupInfo.lpAttributeList = attributes;
+            args->startupInfo = &job->startupInfo.StartupInfo;
+            args->flags |= EXTENDED_STARTUPINFO_PRESENT;
+        });
+    }
+#endif
+#else
+    // 新的进程组以shell为组长，结束时向整个组发送信号
+    process->setChildProcessModifier([]() {
+        ::setpgid(0, 0);
+    });
+#endif
+    m_running.append(job);
+    
+    connect(process, &QProcess::readyReadStandardOutput, this, [this, job]() {
+        readOutput(job, false);
+    });
+    connect(process, &QProcess::readyReadStandardError, this, [this, job]() {
+        readOutput(job, true);
+    });
+    connect(process, &QProcess::finished, this, [this, job](int exitCode, QProcess::ExitStatus exitStatus) {
+        job->result.exitCode = exitCode;
+        finish(job, exitStatus == QProcess::NormalExit ? Result::Finished : Result::Crashed);
+    });
+    connect(process, &QProcess::errorOccurred, this, [this, job](QProcess::ProcessError error) {
+        if (error == QProcess::FailedToStart) {
+            finish(job, Result::FailedToStart);
+        }
+    });
+    
+    // 计时器以进程为父对象，随进程一起释放
+    if (job->options.timeoutMs > 0) {
+        QTimer* timer = new QTimer(process);
+        timer->setSingleShot(true);
+        connect(timer, &QTimer::timeout, this, [this, job]() {
+            finish(job, Result::TimedOut);
+        });
+        timer->start(job->options.timeoutMs);
+    }
+    if (job->options.idleTimeoutMs > 0) {
+        job->idleTimer = new QTimer(process);
+        job->idleTimer->setSingleShot(true);
+        connect(job->idleTimer, &QTimer::timeout, this, [this, job]() {
+            finish(job, Result::IdleTimedOut);
+        });
+        job->idleTimer->start(job->options.idleTimeoutMs);
+    }
+    
+    LOG_INFO(QString("[%1] 启动进程: %2").arg(job->options.label, job->command));
+    process->start();
+    
+#ifdef Q_OS_WIN
+    // 进程已创建，属性列表不再需要；不支持创建时指定作业的系统上在此补加入
+    if (!job->attributeList.empty()) {
+        DeleteProcThreadAttributeList(reinterpret_cast<LPPROC_THREAD_ATTRIBUTE_LIST>(job->attributeList.data()));
+        job->attributeList.clear();
+    }
+    if (job->jobObject && process->processId() != 0) {
+        HANDLE handle = OpenProcess(PROCESS_SET_QUOTA | PROCESS_TERMINATE, FALSE,
+                                    static_cast<DWORD>(process->processId()));
+        if (handle) {
+            AssignProcessToJobObject(job->jobObject, handle);
+            CloseHandle(handle);
+        }
+    }
+#endif
+}
+
+void ProcessSupervisor::killProcessTree(const std::shared_ptr<Job>& job) {
+#ifdef Q_OS_WIN
+    if (job->jobObject) {
+        TerminateJobObject(job->jobObject, 1);
+    }
+#else
+    const qint64 pid = job->process ? job->process->processId() : 0;
+    if (pid > 0) {
+        ::kill(-static_cast<pid_t>(pid), SIGKILL);
+    }
+#endif
+    if (job->process) {
+        job->process->kill();
+    }
+}
+
+void ProcessSupervisor::releaseProcessTree(const std::shared_ptr<Job>& job) {
+#ifdef Q_OS_WIN
+    if (!job->jobObject) {
+        return;
+    }
+    // 正常结束时卸载程序可能留下仍在工作的子进程（如复制到临时目录后继续运行的NSIS卸载程序），
+    // 先取消关闭时结束的限制再释放作业
+    JOBOBJECT_EXTENDED_LIMIT_INFORMATION limits = {};
+    SetInformationJobObject(job->jobObject, JobObjectExtendedLimitInformation, &limits, sizeof(limits));
+    CloseHandle(job->jobObject);
+    job->jobObject = nullptr;
+#else
+    Q_UNUSED(job);
+#endif
+}
+
+void ProcessSupervisor::readOutput(const std::shared_ptr<Job>& job, bool isError) {
+    if (!job->process) {
+        return;
+    }
+    if (job->idleTimer) {
+        job->idleTimer->start();
+    }
+    
+    QByteArray& buffer = isError ? job->errorBuffer : job->outputBuffer;
+    buffer += isError ? job->process->readAllStandardError() : job->process->readAllStandardOutput();
+    
+    // 只记录完整的行，剩余部分留到下次或进程结束时
+    int newline;
+    while ((newline = buffer.indexOf('\n')) >= 0) {
+        const QString line = QString::fromLocal8Bit(buffer.constData(), newline).trimmed();
+        buffer.remove(0, newline + 1);
+        if (line.isEmpty()) {
+            continue;
+        }
+        if (isError) {
+            LOG_WARNING(QString("[%1] %2").arg(job->options.label, line));
+        } else {
+            LOG_INFO(QString("[%1] %2").arg(job->options.label, line));
+        }
+    }
+}
+
+void ProcessSupervisor::finish(const std::shared_ptr<Job>& job, Result::Status status) {
+    if (job->done) {
+        return;
+    }
+    job->done = true;
+    job->result.status = status;
+    
+    QProcess* process = job->process;
+    if (process) {
+        // 先读完已到达的输出，再断开信号并结束仍在运行的进程
+        readOutput(job, false);
+        readOutput(job, true);
+        job->result.errorString = process->errorString();
+        
+        process->disconnect(this);
+        if (process->state() != QProcess::NotRunning) {
+            killProcessTree(job);
+            process->waitForFinished(1000);
+        }
+        releaseProcessTree(job);
+        process->deleteLater();
+        job->process = nullptr;
+        job->idleTimer = nullptr;
+    }
+    
+    // 没有换行结尾的最后一段输出
+    for (const QByteArray* buffer : {&job->outputBuffer, &job->errorBuffer}) {
+        const QString rest = QString::fromLocal8Bit(*buffer).trimmed();
+        if (!rest.isEmpty()) {
+            LOG_INFO(QString("[%1] %2").arg(job->options.label, rest));
+        }
+    }
+    
+    switch (status) {
+        case Result::Finished:
+            LOG_INFO(QString("[%1] 进程退出码: %2").arg(job->options.label).arg(job->result.exitCode));
+            break;
+        case Result::FailedToStart:
+            LOG_ERROR(QString("[%1] 无法启动进程: %2").arg(job->options.label, job->result.errorString));
+            break;
+        case Result::Crashed:
+            LOG_ERROR(QString("[%1] 进程异常退出").arg(job->options.label));
+            break;
+        case Result::TimedOut:
+            LOG_ERROR(QString("[%1] 进程超时，已结束").arg(job->options.label));
+            break;
+        case Result::IdleTimedOut:
+            LOG_ERROR(QString("[%1] 进程长时间无输出，已结束").arg(job->options.label));
+            break;
+        case Result::Cancelled:
+            LOG_WARNING(QString("[%1] 进程已取消").arg(job->options.label));
+            break;
+    }
+    
+    m_running.removeOne(job);
+    job->finished.release();
+    
+    startPending();
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <QObject>
+#include <QMutex>
+#include <QQueue>
+#include <QString>
+#include <QStringList>
+#include <QThread>
+#include <memory>
+
+// 外部进程监管：所有子进程在一个专用线程的事件循环中以信号驱动，
+// 调用线程只等待自己的任务结束，不占用事件循环。
+// 同时运行的进程数有上限，超出的排队；输出按行实时写入日志；
+// 总时长和无输出时长超限时结束进程；cancelAll立即结束所有运行中和排队的进程。
+// 结束时连同shell启动的整个进程树一起结束（Windows为作业对象，其他平台为进程组）。
+// 命令通过可配置的shell执行（默认Windows为cmd.exe /c，其他平台为/bin/sh -c），
+// 设置BTU_UNINSTALL_SHELL环境变量可替换为测试用的桩脚本。
+class ProcessSupervisor : public QObject {
+    Q_OBJECT
+
+public:
+    struct Options {
+        QString label;            // 日志前缀，通常为应用名
+        int timeoutMs = 300000;   // 总时长上限，0表示不限
+        int idleTimeoutMs = 0;    // 连续无输出的时长上限，0表示不限
+    };
+    
+    struct Result {
+        enum Status {
+            Finished,
+            FailedToStart,
+            Crashed,
+            TimedOut,
+            IdleTimedOut,
+            Cancelled
+        };
+        
+        Status status = FailedToStart;
+        int exitCode = -1;
+        QString errorString;
+        
+        bool succeeded() const { return status == Finished && exitCode == 0; }
+    };
+    
+    ProcessSupervisor();
+    ~ProcessSupervisor();
+    
+    void setMaxConcurrent(int count);
+    
+    // 执行命令的程序和位于命令之前的参数
+    void setShell(const QString& program, const QStringList& arguments);
+    
+    // BTU_UNINSTALL_SHELL（以空格分隔程序和参数），未设置时为平台默认shell
+    static QStringList defaultShell();
+    
+    // 排队执行命令并等待结束。可从任意工作线程调用，不能在监管线程中调用
+    Result run(const QString& command, const Options& options);
+    
+    // 结束所有运行中的进程并取消排队的任务，返回时这些任务都已结束
+    void cancelAll();
+
+private:
+    struct Job;
+    
+    void startPending();
+    void launch(const std::shared_ptr<Job>& job);
+    void readOutput(const std::shared_ptr<Job>& job, bool isError);
+    void finish(const std::shared_ptr<Job>& job, Result::Status status);
+    
+    // 结束进程及其所有子进程
+    void killProcessTree(const std::shared_ptr<Job>& job);
+    // 进程已退出，释放进程树的跟踪，不影响仍在运行的子进程
+    void releaseProcessTree(const std::shared_ptr<Job>& job);
+    void cancelRunning();
+    
+    QThread m_thread;
+    
+    QMutex m_mutex;  // 保护以下排队状态和配置
+    QQueue<std::shared_ptr<Job>> m_pending;
+    int m_maxConcurrent;
+    QString m_shellProgram;
+    QStringList m_shellArguments;
+    
+    QList<std::shared_ptr<Job>> m_running;  // 只在监管线程中访问
+};
@@ -0,0 +1,337 @@
+#include "RegistryBackend.h"
+#include "FixtureRegistryBackend.h"
+#include "Logger.h"
+#include <QFileInfo>
+#include <QSettings>
+#include <QVector>
+#include <algorithm>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#include <winreg.h>
+#endif
+
+namespace {
+
+#ifdef Q_OS_WIN
+
+// 直接调用Win32注册表API：每个子键只打开一次，RegEnumValueW一次枚举全部值
+class NativeRegistryBackend : public RegistryBackend {
+public:
+    QStringList childKeys(const QString& keyPath) const override {
+        QStringList children;
+        HKEY key = openKey(keyPath, KEY_READ);
+        if (!key) {
+            return children;
+        }
+        
+        DWORD subKeyCount = 0;
+        DWORD maxSubKeyLength = 0;
+        if (RegQueryInfoKeyW(key, nullptr, nullptr, nullptr, &subKeyCount, &maxSubKeyLength,
+                             nullptr, nullptr, nullptr, nullptr, nullptr, nullptr) == ERROR_SUCCESS) {
+            QVector<wchar_t> name(static_cast<int>(maxSubKeyLength) + 1);
+            children.reserve(static_cast<int>(subKeyCount));
+            for (DWORD index = 0;; ++index) {
+                DWORD nameLength = static_cast<DWORD>(name.size());
+                const LSTATUS status = RegEnumKeyExW(key, index, name.data(), &nameLength,
+                                                     nullptr, nullptr, nullptr, nullptr);
+                if (status != ERROR_SUCCESS) {
+                    break;
+                }
+                children.append(QString::fromWCharArray(name.constData(), static_cast<int>(nameLength)));
+            }
+        }
+        
+        RegCloseKey(key);
+        return children;
+    }
+    
+    quint64 fingerprint(const QString& keyPath, const QString& subKey) const override {
+        // 使用子键的最后写入时间作为指纹，无需读取任何值
+        HKEY key = openKey(keyPath + "\\" + subKey, KEY_QUERY_VALUE);
+        if (!key) {
+            return 0;
+        }
+        
+        quint64 result = 0;
+        FILETIME lastWrite;
+        if (RegQueryInfoKeyW(key, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+                             nullptr, nullptr, nullptr, nullptr, &lastWrite) == ERROR_SUCCESS) {
+            result = (static_cast<quint64>(lastWrite.dwHighDateTime) << 32) | lastWrite.dwLowDateTime;
+        }
+        RegCloseKey(key);
+        return result;
+    }
+    
+    bool readEntry(const QString& keyPath, const QString& subKey, RegistryEntry& entry) const override {
+        HKEY key = openKey(keyPath + "\\" + subKey, KEY_READ);
+        if (!key) {
+            return false;
+        }
+        
+        entry.subKey = subKey;
+        const bool ok = readValues(key, entry.values, &entry.fingerprint);
+        RegCloseKey(key);
+        return ok;
+    }
+    
+    QVariantHash values(const QString& keyPath) const override {
+        QVariantHash result;
+        HKEY key = openKey(keyPath, KEY_READ);
+        if (key) {
+            readValues(key, result, nullptr);
+            RegCloseKey(key);
+        }
+        return result;
+    }
+    
+    int deleteTrees(const QStringList& keyPaths) override {
+        int deleted = 0;
+        for (const QString& keyPath : keyPaths) {
+            const int separator = keyPath.lastIndexOf('\\');
+            if (separator <= 0) {
+                continue;
+            }
+            
+            HKEY parent = openKey(keyPath.left(separator), KEY_READ | KEY_SET_VALUE | DELETE);
+            if (!parent) {
+                continue;
+            }
+            
+            const QString child = keyPath.mid(separator + 1);
+            const LSTATUS status = RegDeleteTreeW(parent, reinterpret_cast<LPCWSTR>(child.utf16()));
+            if (status == ERROR_SUCCESS) {
+                ++deleted;
+            } else if (status != ERROR_FILE_NOT_FOUND) {
+                LOG_WARNING(QString("删除注册表键失败(%1): %2").arg(status).arg(keyPath));
+            }
+            RegCloseKey(parent);
+        }
+        return deleted;
+    }
+    
+    int deleteValues(const QString& keyPath, const QStringList& valueNames) override {
+        HKEY key = openKey(keyPath, KEY_SET_VALUE);
+        if (!key) {
+            return 0;
+        }
+        
+        int deleted = 0;
+        for (const QString& name : valueNames) {
+            if (RegDeleteValueW(key, reinterpret_cast<LPCWSTR>(name.utf16())) == ERROR_SUCCESS) {
+                ++deleted;
+            }
+        }
+        RegCloseKey(key);
+        return deleted;
+    }
+    
+    bool isNative() const override {
+        return true;
+    }
+    
+    QString watchPath(const QString& keyPath) const override {
+        return keyPath;
+    }
+
+private:
+    static HKEY openKey(const QString& keyPath, REGSAM access) {
+        const int separator = keyPath.indexOf('\\');
+        const QString rootName = keyPath.left(separator);
+        
+        HKEY root = nullptr;
+        if (rootName == "HKEY_LOCAL_MACHINE") {
+            root = HKEY_LOCAL_MACHINE;
+        } else if (rootName == "HKEY_CURRENT_USER") {
+            root = HKEY_CURRENT_USER;
+        } else if (rootName == "HKEY_CLASSES_ROOT") {
+            root = HKEY_CLASSES_ROOT;
+        } else {
+            return nullptr;
+        }
+        
+        // 路径中显式包含WOW6432Node，始终按64位视图解析
+        const QString subPath = separator < 0 ? QString() : keyPath.mid(separator + 1);
+        HKEY key = nullptr;
+        if (RegOpenKeyExW(root, reinterpret_cast<LPCWSTR>(subPath.utf16()), 0,
+                          access | KEY_WOW64_64KEY, &key) != ERROR_SUCCESS) {
+            return nullptr;
+        }
+        return key;
+    }
+    
+    static bool readValues(HKEY key, QVariantHash& values, quint64* fingerprint) {
+        DWORD valueCount = 0;
+        DWORD maxNameLength = 0;
+        DWORD maxDataLength = 0;
+        FILETIME lastWrite;
+        if (RegQueryInfoKeyW(key, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+                             &valueCount, &maxNameLength, &maxDataLength, nullptr, &lastWrite) != ERROR_SUCCESS) {
+            return false;
+        }
+        
+        if (fingerprint) {
+            *fingerprint = (static_cast<quint64>(lastWrite.dwHighDateTime) << 32) | lastWrite.dwLowDateTime;
+        }
+        
+        QVector<wchar_t> name(static_cast<int>(maxNameLength) + 1);
+        QByteArray data(static_cast<int>(maxDataLength) + sizeof(wchar_t), Qt::Uninitialized);
+        values.reserve(static_cast<int>(valueCount));
+        
+        for (DWORD index = 0;; ++index) {
+            DWORD nameLength = static_cast<DWORD>(name.size());
+            DWORD dataLength = static_cast<DWORD>(data.size());
+            DWORD type = 0;
+            const LSTATUS status = RegEnumValueW(key, index, name.data(), &nameLength, nullptr, &type,
+                                                 reinterpret_cast<LPBYTE>(data.data()), &dataLength);
+            if (status == ERROR_NO_MORE_ITEMS) {
+                break;
+            }
+            if (status != ERROR_SUCCESS) {
+                continue;
+            }
+            
+            values.insert(QString::fromWCharArray(name.constData(), static_cast<int>(nameLength)),
+                          toVariant(type, data.constData(), dataLength));
+        }
+        return true;
+    }
+    
+    static QVariant toVariant(DWORD type, const char* data, DWORD length) {
+        switch (type) {
+        case REG_SZ:
+        case REG_EXPAND_SZ: {
+            QString text = QString::fromWCharArray(reinterpret_cast<const wchar_t*>(data),
+                                                   static_cast<int>(length / sizeof(wchar_t)));
+            while (text.endsWith(QChar('\0'))) {
+                text.chop(1);
+            }
+            return text;
+        }
+        case REG_MULTI_SZ: {
+            const QString text = QString::fromWCharArray(reinterpret_cast<const wchar_t*>(data),
+                                                         static_cast<int>(length / sizeof(wchar_t)));
+            return text.split(QChar('\0'), Qt::SkipEmptyParts);
+        }
+        case REG_DWORD:
+            return length >= sizeof(quint32) ? QVariant(*reinterpret_cast<const quint32*>(data)) : QVariant();
+        case REG_QWORD:
+            return length >= sizeof(quint64) ? QVariant(*reinterpret_cast<const quint64*>(data)) : QVariant();
+        default:
+            return QByteArray(data, static_cast<int>(length));
+        }
+    }
+};
+
+#else
+
+// 非Windows平台通过QSettings访问由配置文件模拟的注册表，每次调用使用独立实例以便多线程读取
+class NativeRegistryBackend : public RegistryBackend {
+public:
+    QStringList childKeys(const QString& keyPath) const override {
+        QSettings registry(keyPath, QSettings::NativeFormat);
+        return registry.childGroups();
+    }
+    
+    quint64 fingerprint(const QString& keyPath, const QString& subKey) const override {
+        // 没有最后写入时间，退而对所有值做哈希
+        return hashValues(values(keyPath + "\\" + subKey));
+    }
+    
+    bool readEntry(const QString& keyPath, const QString& subKey, RegistryEntry& entry) const override {
+        QSettings registry(keyPath, QSettings::NativeFormat);
+        if (!registry.childGroups().contains(subKey)) {
+            return false;
+        }
+        
+        registry.beginGroup(subKey);
+        entry.subKey = subKey;
+        for (const QString& name : registry.childKeys()) {
+            entry.values.insert(name, registry.value(name));
+        }
+        registry.endGroup();
+        
+        entry.fingerprint = hashValues(entry.values);
+        return true;
+    }
+    
+    QVariantHash values(const QString& keyPath) const override {
+        QSettings registry(keyPath, QSettings::NativeFormat);
+        QVariantHash result;
+        for (const QString& name : registry.childKeys()) {
+            result.insert(name, registry.value(name));
+        }
+        return result;
+    }
+    
+    int deleteTrees(const QStringList& keyPaths) override {
+        int deleted = 0;
+        for (const QString& keyPath : keyPaths) {
+            QSettings registry(keyPath, QSettings::NativeFormat);
+            registry.clear();
+            registry.sync();
+            if (registry.status() == QSettings::NoError) {
+                ++deleted;
+            }
+        }
+        return deleted;
+    }
+    
+    int deleteValues(const QString& keyPath, const QStringList& valueNames) override {
+        QSettings registry(keyPath, QSettings::NativeFormat);
+        int deleted = 0;
+        for (const QString& name : valueNames) {
+            if (registry.contains(name)) {
+                registry.remove(name);
+                ++deleted;
+            }
+        }
+        registry.sync();
+        return deleted;
+    }
+    
+    bool isNative() const override {
+        return true;
+    }
+    
+    QString watchPath(const QString& keyPath) const override {
+        // 配置文件可能被整体替换，因此监视所在目录
+        QSettings registry(keyPath, QSettings::NativeFormat);
+        return QFileInfo(registry.fileName()).absolutePath();
+    }
+};
+
+#endif
+
+} // namespace
+
+quint64 RegistryBackend::hashValues(const QVariantHash& values) {
+    QStringList names = values.keys();
+    names.sort();
+    
+    size_t hash = 0;
+    for (const QString& name : names) {
+        hash = qHashMulti(hash, name, values.value(name).toString());
+    }
+    return static_cast<quint64>(hash);
+}
+
+std::shared_ptr<RegistryBackend> RegistryBackend::createNative() {
+    return std::make_shared<NativeRegistryBackend>();
+}
+
+std::shared_ptr<RegistryBackend> RegistryBackend::defaultBackend() {
+    static const std::shared_ptr<RegistryBackend> backend = []() -> std::shared_ptr<RegistryBackend> {
+        const QString fixturePath = qEnvironmentVariable("BTU_REGISTRY_FIXTURE");
+        if (!fixturePath.isEmpty()) {
+            auto fixture = std::make_shared<FixtureRegistryBackend>();
+            if (fixture->load(fixturePath)) {
+                LOG_INFO(QString("使用模拟注册表: %1 (%2 个键)").arg(fixturePath).arg(fixture->keyCount()));
+                return fixture;
+            }
+            LOG_WARNING(QString("无法加载模拟注册表，改用系统注册表: %1").arg(fixturePath));
+        }
+        return createNative();
+    }();
+    return backend;
+}
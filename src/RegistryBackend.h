@@ -0,0 +1,59 @@
+#pragma once
+
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+#include <QVariantHash>
+#include <memory>
+
+// 注册表子键的一次性读取结果
+struct RegistryEntry {
+    QString subKey;
+    QVariantHash values;     // 值名 -> 值
+    quint64 fingerprint;     // 变化检测用的指纹，0表示不可用
+    
+    RegistryEntry() : fingerprint(0) {}
+};
+
+// 注册表访问接口：以子键为单位批量读取所有值，以批为单位删除键树。
+// 实现必须允许多个线程同时读取。
+class RegistryBackend {
+public:
+    virtual ~RegistryBackend() = default;
+    
+    // 列出键下的直接子键名
+    virtual QStringList childKeys(const QString& keyPath) const = 0;
+    
+    // 只取子键指纹，不读取值，用于增量扫描判断子键是否变化
+    virtual quint64 fingerprint(const QString& keyPath, const QString& subKey) const = 0;
+    
+    // 一次读取子键的全部值和指纹
+    virtual bool readEntry(const QString& keyPath, const QString& subKey, RegistryEntry& entry) const = 0;
+    
+    // 读取键自身的全部值
+    virtual QVariantHash values(const QString& keyPath) const = 0;
+    
+    // 批量删除键及其所有子键，返回成功删除的数量
+    virtual int deleteTrees(const QStringList& keyPaths) = 0;
+    
+    // 删除键下的若干值，返回成功删除的数量
+    virtual int deleteValues(const QString& keyPath, const QStringList& valueNames) = 0;
+    
+    // 是否直接访问系统注册表（决定变更通知的方式）
+    virtual bool isNative() const = 0;
+    
+    // 监视该键变化时应监视的位置：注册表键路径或文件系统目录
+    virtual QString watchPath(const QString& keyPath) const = 0;
+    
+    // 每次扫描开始前调用：底层存储在进程外被修改时重新读取。系统注册表始终是最新的，无需处理
+    virtual void refresh() {}
+    
+    // 对一组值计算与顺序无关的稳定哈希
+    static quint64 hashValues(const QVariantHash& values);
+    
+    // 系统注册表实现
+    static std::shared_ptr<RegistryBackend> createNative();
+    
+    // 默认实现：设置了BTU_REGISTRY_FIXTURE环境变量时使用该文件中的模拟注册表，否则使用系统注册表
+    static std::shared_ptr<RegistryBackend> defaultBackend();
+};
@@ -0,0 +1,280 @@
+#include "SafeDeleteWalker.h"
+#include "Logger.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#else
+#include <cerrno>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+SafeDeleteWalker::SafeDeleteWalker(const SafetyPolicy& policy)
+    : m_policy(policy)
+#ifndef Q_OS_WIN
+    , m_rootDevice(0)
+#endif
+{
+}
+
+#ifdef Q_OS_WIN
+
+namespace {
+
+LPCWSTR nativePath(const QString& path) {
+    return reinterpret_cast<LPCWSTR>(path.utf16());
+}
+
+// 只读属性会导致删除失败，与QDir::removeRecursively一样先清除
+void clearReadOnly(const QString& native, DWORD attributes) {
+    if (attributes & FILE_ATTRIBUTE_READONLY) {
+        SetFileAttributesW(nativePath(native), attributes & ~FILE_ATTRIBUTE_READONLY);
+    }
+}
+
+} // namespace
+
+SafeDeleteWalker::Result SafeDeleteWalker::remove(const QString& rootPath) {
+    Result result;
+    const QString root = QDir::cleanPath(QFileInfo(rootPath).absoluteFilePath());
+    const QString native = QDir::toNativeSeparators(root);
+    
+    const DWORD attributes = GetFileAttributesW(nativePath(native));
+    if (attributes == INVALID_FILE_ATTRIBUTES) {
+        return result; // 不存在，视为已删除
+    }
+    
+    const bool isDirectory = attributes & FILE_ATTRIBUTE_DIRECTORY;
+    const bool isLink = attributes & FILE_ATTRIBUTE_REPARSE_POINT;
+    if (m_policy.isEntryBlocked(QFileInfo(root).path(), QFileInfo(root).fileName(), isDirectory && !isLink, false)) {
+        LOG_WARNING(QString("安全检查拦截删除: %1").arg(root));
+        result.blocked.append(root);
+        return result;
+    }
+    
+    clearReadOnly(native, attributes);
+    
+    if (!isDirectory) {
+        if (DeleteFileW(nativePath(native))) {
+            ++(isLink ? result.linksRemoved : result.filesRemoved);
+        } else {
+            result.failed.append(root);
+        }
+        return result;
+    }
+    
+    // 联接点只删除其本身
+    if (!isLink && !removeContents(root, m_policy.isSubtreeClear(root), result)) {
+        return result;
+    }
+    
+    if (RemoveDirectoryW(nativePath(native))) {
+        ++(isLink ? result.linksRemoved : result.directoriesRemoved);
+    } else {
+        result.failed.append(root);
+    }
+    return result;
+}
+
+bool SafeDeleteWalker::removeContents(const QString& path, bool clear, Result& result) {
+    const QString pattern = QDir::toNativeSeparators(path) + QLatin1String("\\*");
+    WIN32_FIND_DATAW data;
+    HANDLE handle = FindFirstFileExW(nativePath(pattern), FindExInfoBasic, &data,
+                                     FindExSearchNameMatch, nullptr, FIND_FIRST_EX_LARGE_FETCH);
+    if (handle == INVALID_HANDLE_VALUE) {
+        result.failed.append(path);
+        return false;
+    }
+    
+    bool complete = true;
+    do {
+        const QString name = QString::fromWCharArray(data.cFileName);
+        if (name == QLatin1String(".") || name == QLatin1String("..")) {
+            continue;
+        }
+        
+        const QString childPath = path + QLatin1Char('/') + name;
+        const QString childNative = QDir::toNativeSeparators(childPath);
+        const bool isDirectory = data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY;
+        const bool isLink = data.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT;
+        
+        if (m_policy.isEntryBlocked(path, name, isDirectory && !isLink, clear)) {
+            LOG_WARNING(QString("安全检查拦截删除: %1").arg(childPath));
+            result.blocked.append(childPath);
+            complete = false;
+            continue;
+        }
+        
+        clearReadOnly(childNative, data.dwFileAttributes);
+        
+        if (isDirectory && !isLink) {
+            const bool childClear = clear || m_policy.isSubtreeClear(childPath);
+            if (!removeContents(childPath, childClear, result)) {
+                complete = false;
+                continue;
+            }
+        }
+        
+        // 联接点和目录符号链接用RemoveDirectoryW删除链接本身，不影响目标
+        const bool removed = isDirectory ? RemoveDirectoryW(nativePath(childNative))
+                                         : DeleteFileW(nativePath(childNative));
+        if (!removed) {
+            result.failed.append(childPath);
+            complete = false;
+            continue;
+        }
+        
+        if (isLink) {
+            ++result.linksRemoved;
+        } else if (isDirectory) {
+            ++result.directoriesRemoved;
+        } else {
+            ++result.filesRemoved;
+            result.bytesFreed += (static_cast<qint64>(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+        }
+    } while (FindNextFileW(handle, &data));
+    
+    FindClose(handle);
+    return complete;
+}
+
+#else
+
+SafeDeleteWalker::Result SafeDeleteWalker::remove(const QString& rootPath) {
+    Result result;
+    const QString root = QDir::cleanPath(QFileInfo(rootPath).absoluteFilePath());
+    const QByteArray encoded = QFile::encodeName(root);
+    
+    struct stat st;
+    if (lstat(encoded.constData(), &st) != 0) {
+        if (errno != ENOENT) {
+            result.failed.append(root);
+        }
+        return result;
+    }
+    
+    const bool isDirectory = S_ISDIR(st.st_mode);
+    if (m_policy.isEntryBlocked(QFileInfo(root).path(), QFileInfo(root).fileName(), isDirectory, false)) {
+        LOG_WARNING(QString("安全检查拦截删除: %1").arg(root));
+        result.blocked.append(root);
+        return result;
+    }
+    
+    if (!isDirectory) {
+        if (::unlink(encoded.constData()) != 0) {
+            result.failed.append(root);
+        } else if (S_ISLNK(st.st_mode)) {
+            ++result.linksRemoved;
+        } else {
+            ++result.filesRemoved;
+            result.bytesFreed += st.st_nlink <= 1 ? static_cast<qint64>(st.st_size) : 0;
+        }
+        return result;
+    }
+    
+    // O_NOFOLLOW保证检查之后根目录被替换为链接时不会跟随
+    const int fd = ::open(encoded.constData(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+    if (fd < 0) {
+        result.failed.append(root);
+        return result;
+    }
+    
+    m_rootDevice = static_cast<quint64>(st.st_dev);
+    if (!removeContents(fd, root, m_policy.isSubtreeClear(root), result)) {
+        return result;
+    }
+    
+    if (::rmdir(encoded.constData()) != 0) {
+        result.failed.append(root);
+    } else {
+        ++result.directoriesRemoved;
+    }
+    return result;
+}
+
+bool SafeDeleteWalker::removeContents(int directoryFd, const QString& path, bool clear, Result& result) {
+    DIR* dir = fdopendir(directoryFd);
+    if (!dir) {
+        ::close(directoryFd);
+        result.failed.append(path);
+        return false;
+    }
+    
+    bool complete = true;
+    while (struct dirent* entry = readdir(dir)) {
+        const char* name = entry->d_name;
+        if (qstrcmp(name, ".") == 0 || qstrcmp(name, "..") == 0) {
+            continue;
+        }
+        
+        const QString childName = QFile::decodeName(name);
+        const QString childPath = path + QLatin1Char('/') + childName;
+        
+        // 相对于目录描述符操作，且不跟随符号链接
+        struct stat st;
+        if (fstatat(directoryFd, name, &st, AT_SYMLINK_NOFOLLOW) != 0) {
+            if (errno != ENOENT) {
+                result.failed.append(childPath);
+                complete = false;
+            }
+            continue;
+        }
+        
+        const bool isDirectory = S_ISDIR(st.st_mode);
+        if (m_policy.isEntryBlocked(path, childName, isDirectory, clear)) {
+            LOG_WARNING(QString("安全检查拦截删除: %1").arg(childPath));
+            result.blocked.append(childPath);
+            complete = false;
+            continue;
+        }
+        
+        if (isDirectory) {
+            if (static_cast<quint64>(st.st_dev) != m_rootDevice) {
+                LOG_WARNING(QString("跳过挂载点: %1").arg(childPath));
+                result.blocked.append(childPath);
+                complete = false;
+                continue;
+            }
+            
+            const int childFd = openat(directoryFd, name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+            const bool childClear = clear || m_policy.isSubtreeClear(childPath);
+            if (childFd < 0 || !removeContents(childFd, childPath, childClear, result)) {
+                if (childFd < 0) {
+                    result.failed.append(childPath);
+                }
+                complete = false;
+                continue;
+            }
+            
+            if (unlinkat(directoryFd, name, AT_REMOVEDIR) != 0) {
+                result.failed.append(childPath);
+                complete = false;
+            } else {
+                ++result.directoriesRemoved;
+            }
+            continue;
+        }
+        
+        // 符号链接只删除链接本身
+        if (unlinkat(directoryFd, name, 0) != 0) {
+            result.failed.append(childPath);
+            complete = false;
+        } else if (S_ISLNK(st.st_mode)) {
+            ++result.linksRemoved;
+        } else {
+            ++result.filesRemoved;
+            // 仍有其他硬链接时空间并未释放
+            result.bytesFreed += st.st_nlink <= 1 ? static_cast<qint64>(st.st_size) : 0;
+        }
+    }
+    
+    closedir(dir); // 同时关闭directoryFd
+    return complete;
+}
+
+#endif
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "SafetyPolicy.h"
+#include <QString>
+#include <QStringList>
+
+// 逐项校验的递归删除。与QDir::removeRecursively不同：
+// - 每个条目删除前都经过安全策略检查，被拦截的条目及其上级目录保留；
+// - 不跟随符号链接、联接点等重解析点，只删除链接本身，也不跨越挂载点，
+//   因此安装目录中的链接无法把删除引向受保护的目录树。
+// 目录一旦确认其下不含任何受保护路径和系统目录，该结论对整个子树有效，
+// 子孙条目只需再做一次文件名哈希查找。
+class SafeDeleteWalker {
+public:
+    struct Result {
+        qint64 filesRemoved = 0;
+        qint64 directoriesRemoved = 0;
+        qint64 linksRemoved = 0;
+        qint64 bytesFreed = 0;
+        QStringList blocked;  // 未通过安全检查而保留的条目
+        QStringList failed;   // 删除失败的条目
+        
+        bool isComplete() const { return blocked.isEmpty() && failed.isEmpty(); }
+    };
+    
+    // policy须在删除期间保持有效（SafetyChecker发布的快照始终有效）
+    explicit SafeDeleteWalker(const SafetyPolicy& policy);
+    
+    // 删除rootPath及其内容；rootPath本身是链接时只删除链接
+    Result remove(const QString& rootPath);
+
+private:
+    // 删除目录内容，全部删除成功后调用方再删除目录本身；
+    // clear表示该目录的子树已确认不涉及受保护路径
+#ifdef Q_OS_WIN
+    bool removeContents(const QString& path, bool clear, Result& result);
+#else
+    // directoryFd为已打开的目录描述符，由本函数关闭
+    bool removeContents(int directoryFd, const QString& path, bool clear, Result& result);
+#endif
+    
+    const SafetyPolicy& m_policy;
+#ifndef Q_OS_WIN
+    quint64 m_rootDevice;  // 根目录所在设备，不跨越挂载点
+#endif
+};
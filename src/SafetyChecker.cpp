@@ -1,114 +1,124 @@
 #include "SafetyChecker.h"
+#include "AppScanner.h"
 #include "Logger.h"
 #include <QCoreApplication>
 #include <QStandardPaths>
+#include <QThreadPool>
+#include <QTimer>
+#include "ChangeNotifier.h"
 
 SafetyChecker& SafetyChecker::instance() {
     static SafetyChecker instance;
     return instance;
 }
 
-SafetyChecker::SafetyChecker() {
-    initializeProtectedPaths();
-    initializeProtectedApplications();
-    initializeProtectedRegistryKeys();
+SafetyChecker::SafetyChecker()
+    : m_current(nullptr)
+{
+    // 用户可写的AppData中的策略只能追加保护；替换内置规则必须由部署方显式指定BTU_POLICY_FILE。
+    // 默认策略放在单独的子目录中，监视时不受同目录下日志、快照和缓存写入的干扰
+    m_policyFile = qEnvironmentVariable("BTU_POLICY_FILE");
+    m_loadMode = SafetyPolicy::Replace;
+    if (m_policyFile.isEmpty()) {
+        m_policyFile = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/policy/policy.json";
+        m_loadMode = SafetyPolicy::Merge;
+    }
+    
+    setPolicy(SafetyPolicy::compile(SafetyPolicy::defaultRules()));
+    if (QFileInfo::exists(m_policyFile)) {
+        reloadPolicy();
+    }
 }
 
-void SafetyChecker::initializeProtectedPaths() {
-    // Windows系统关键目录
-    m_protectedPaths << "C:\\Windows"
-                     << "C:\\Windows\\System32"
-                     << "C:\\Windows\\SysWOW64"
-                     << "C:\\Windows\\Boot"
-                     << "C:\\Windows\\Fonts"
-                     << "C:\\Windows\\drivers"
-                     << "C:\\Windows\\winsxs"
-                     << "C:\\Program Files\\Windows NT"
-                     << "C:\\Program Files\\WindowsApps"
-                     << "C:\\Program Files\\Common Files\\Microsoft Shared"
-                     << "C:\\Program Files (x86)\\Windows NT"
-                     << "C:\\Program Files (x86)\\Common Files\\Microsoft Shared"
-                     << "C:\\ProgramData\\Microsoft"
-                     << "C:\\System Volume Information"
-                     << "C:\\$Recycle.Bin"
-                     << "C:\\Recovery"
-                     << "C:\\Boot"
-                     << "C:\\bootmgr"
-                     << "C:\\pagefile.sys"
-                     << "C:\\hiberfil.sys"
-                     << "C:\\swapfile.sys";
+const SafetyPolicy& SafetyChecker::policy() const {
+    return *m_current.load(std::memory_order_acquire);
 }
 
-void SafetyChecker::initializeProtectedApplications() {
-    // 系统关键应用程序
-    m_protectedApplications << "Microsoft Visual C++"
-                           << "Microsoft .NET Framework"
-                           << ".NET Framework"
-                           << "Windows"
-                           << "Microsoft Edge"
-                           << "Internet Explorer"
-                           << "Windows Media Player"
-                           << "Windows Defender"
-                           << "Windows Security"
-                           << "Microsoft Store"
-                           << "Xbox"
-                           << "Cortana"
-                           << "Windows Photos"
-                           << "Windows Camera"
-                           << "Windows Calculator"
-                           << "Windows Mail"
-                           << "Windows Maps"
-                           << "Windows Sound Recorder"
-                           << "Windows Alarms & Clock"
-                           << "Windows Sticky Notes"
-                           << "Windows Feedback Hub"
-                           << "Windows Get Help"
-                           << "Windows Tips"
-                           << "Microsoft Solitaire Collection"
-                           << "Microsoft Minesweeper";
+void SafetyChecker::setPolicy(std::shared_ptr<const SafetyPolicy> policy) {
+    if (!policy) {
+        return;
+    }
     
-    // 系统发布商
-    m_systemPublishers << "Microsoft Corporation"
-                      << "Microsoft"
-                      << "Windows Software Developer"
-                      << "Microsoft Windows"
-                      << "Intel Corporation"
-                      << "NVIDIA Corporation"
-                      << "AMD"
-                      << "Realtek Semiconductor Corp."
-                      << "Qualcomm Atheros"
-                      << "Broadcom"
-                      << "Dell Inc."
-                      << "HP Inc."
-                      << "Lenovo"
-                      << "ASUS"
-                      << "Acer Incorporated";
+    QMutexLocker locker(&m_publishMutex);
+    m_snapshots.append(policy);
+    m_current.store(policy.get(), std::memory_order_release);
 }
 
-void SafetyChecker::initializeProtectedRegistryKeys() {
-    // 受保护的注册表键
-    m_protectedRegistryKeys << "HKEY_LOCAL_MACHINE\\SOFTWARE\\Microsoft\\Windows\\CurrentVersion\\Run"
-                           << "HKEY_LOCAL_MACHINE\\SOFTWARE\\Microsoft\\Windows NT\\CurrentVersion"
-                           << "HKEY_LOCAL_MACHINE\\SYSTEM"
-                           << "HKEY_LOCAL_MACHINE\\HARDWARE"
-                           << "HKEY_LOCAL_MACHINE\\SAM"
-                           << "HKEY_LOCAL_MACHINE\\SECURITY"
-                           << "HKEY_LOCAL_MACHINE\\SOFTWARE\\Classes"
-                           << "HKEY_CURRENT_USER\\SOFTWARE\\Microsoft\\Windows\\CurrentVersion\\Run"
-                           << "HKEY_USERS\\.DEFAULT";
+bool SafetyChecker::reloadPolicy() {
+    if (!QFileInfo::exists(m_policyFile)) {
+        if (!policy().source().isEmpty()) {
+            LOG_INFO("策略文件已移除，恢复内置安全策略");
+            setPolicy(SafetyPolicy::compile(SafetyPolicy::defaultRules()));
+        }
+        return true;
+    }
+    
+    QString error;
+    std::shared_ptr<const SafetyPolicy> loaded = SafetyPolicy::load(m_policyFile, m_loadMode, &error);
+    if (!loaded) {
+        LOG_WARNING(QString("加载安全策略失败，继续使用当前策略: %1").arg(error));
+        return false;
+    }
+    
+    const SafetyPolicy::Rules& rules = loaded->rules();
+    LOG_INFO(QString("已加载安全策略 %1（%2）: %3 个受保护路径, %4 个受保护应用, %5 个系统发布商, %6 个受保护注册表键")
+             .arg(m_policyFile, m_loadMode == SafetyPolicy::Merge ? QString("追加到内置规则") : QString("替换内置规则"))
+             .arg(rules.protectedPaths.size())
+             .arg(rules.protectedApplications.size())
+             .arg(rules.systemPublishers.size())
+             .arg(rules.protectedRegistryKeys.size()));
+    setPolicy(std::move(loaded));
+    return true;
 }
 
-bool SafetyChecker::isSafeToDelete(const QString& path) {
-    QString normalizedPath = QDir::toNativeSeparators(path.toLower());
+QString SafetyChecker::policyFilePath() const {
+    return m_policyFile;
+}
+
+void SafetyChecker::watchPolicyFile(QObject* owner) {
+    // 编辑器和部署工具常以替换文件的方式保存，因此监视所在目录
+    const QString directory = QFileInfo(m_policyFile).absolutePath();
+    QDir().mkpath(directory);
+    
+    ChangeNotifier* notifier = ChangeNotifier::createFileNotifier(owner);
+    if (!notifier->addPath(directory)) {
+        LOG_WARNING(QString("无法监视安全策略目录: %1").arg(directory));
+    }
+    
+    // 合并短时间内的多次写入
+    QTimer* debounce = new QTimer(notifier);
+    debounce->setSingleShot(true);
+    debounce->setInterval(200);
     
+    // 通知只带目录，无法按文件名过滤；只在未计时时启动，
+    // 目录中持续有写入时策略文件的修改也最迟在一个间隔后被发现
+    QObject::connect(notifier, &ChangeNotifier::changed, debounce, [debounce]() {
+        if (!debounce->isActive()) {
+            debounce->start();
+        }
+    });
+    // BTU_POLICY_FILE所在的目录可能还有其他文件，只在策略文件本身变化时重新加载
+    const QFileInfo initial(m_policyFile);
+    QDateTime lastSeen = initial.exists() ? initial.lastModified() : QDateTime();
+    QObject::connect(debounce, &QTimer::timeout, notifier, [this, lastSeen]() mutable {
+        const QFileInfo info(m_policyFile);
+        const QDateTime modified = info.exists() ? info.lastModified() : QDateTime();
+        if (modified != lastSeen) {
+            lastSeen = modified;
+            reloadPolicy();
+        }
+    });
+}
+
+bool SafetyChecker::isSafeToDelete(const QString& path) {
     // 检查是否为系统关键路径
-    if (isSystemCriticalPath(normalizedPath)) {
+    if (isSystemCriticalPath(path)) {
         LOG_WARNING(QString("阻止删除系统关键路径: %1").arg(path));
         return false;
     }
     
     // 检查是否为Windows系统文件
-    if (isWindowsSystemFile(normalizedPath)) {
+    if (isWindowsSystemFile(path)) {
         LOG_WARNING(QString("阻止删除Windows系统文件: %1").arg(path));
         return false;
     }
@@ -123,83 +133,60 @@ bool SafetyChecker::isSafeToDelete(const QString& path) {
 }
 
 bool SafetyChecker::isSystemCriticalPath(const QString& path) {
-    QString normalizedPath = QDir::toNativeSeparators(path.toLower());
-    
-    for (const QString& protectedPath : m_protectedPaths) {
-        QString normalizedProtected = QDir::toNativeSeparators(protectedPath.toLower());
-        if (normalizedPath.startsWith(normalizedProtected)) {
-            return true;
-        }
-    }
-    
-    return false;
+    return policy().isSystemCriticalPath(path);
 }
 
 bool SafetyChecker::isWindowsSystemFile(const QString& filePath) {
-    QFileInfo fileInfo(filePath);
-    QString fileName = fileInfo.fileName().toLower();
-    QString dirPath = fileInfo.absolutePath().toLower();
-    
-    // 检查是否在系统目录中
-    QStringList systemDirs = {
-        "c:/windows/system32",
-        "c:/windows/syswow64",
-        "c:/windows/winsxs",
-        "c:/windows/drivers"
-    };
-    
-    for (const QString& sysDir : systemDirs) {
-        if (dirPath.startsWith(sysDir)) {
-            return true;
-        }
-    }
-    
-    // 检查关键系统文件
-    QStringList systemFiles = {
-        "kernel32.dll", "ntdll.dll", "user32.dll", "gdi32.dll",
-        "advapi32.dll", "shell32.dll", "ole32.dll", "oleaut32.dll",
-        "rpcrt4.dll", "msvcrt.dll", "ws2_32.dll", "wininet.dll",
-        "explorer.exe", "winlogon.exe", "csrss.exe", "lsass.exe",
-        "services.exe", "svchost.exe", "spoolsv.exe", "dwm.exe"
-    };
-    
-    return systemFiles.contains(fileName);
+    return policy().isWindowsSystemFile(filePath);
 }
 
 bool SafetyChecker::isSystemApplication(const QString& appName, const QString& publisher) {
-    // 检查应用程序名称
-    for (const QString& protectedApp : m_protectedApplications) {
-        if (appName.contains(protectedApp, Qt::CaseInsensitive)) {
-            return true;
+    return policy().isSystemApplication(appName, publisher);
+}
+
+QVector<bool> SafetyChecker::classifySystemApplications(const QList<ApplicationInfo>& applications, bool parallel) {
+    const int count = static_cast<int>(applications.size());
+    QVector<bool> result(count, false);
+    bool* output = result.data();
+    
+    // 整批使用同一快照，即使期间策略被更新结果也保持一致
+    const SafetyPolicy& current = policy();
+    auto classifyRange = [&current, &applications, output](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+            output[i] = current.isSystemApplication(applications[i].name, applications[i].publisher);
         }
+    };
+    
+    // 条目较少时线程调度的开销超过收益
+    const int minChunk = 1024;
+    const int chunkCount = parallel ? qMin(QThread::idealThreadCount(), count / minChunk) : 1;
+    if (chunkCount <= 1) {
+        classifyRange(0, count);
+        return result;
     }
     
-    // 检查发布商
-    for (const QString& systemPublisher : m_systemPublishers) {
-        if (publisher.contains(systemPublisher, Qt::CaseInsensitive)) {
-            return true;
-        }
+    const int chunkSize = (count + chunkCount - 1) / chunkCount;
+    QThreadPool pool;
+    pool.setMaxThreadCount(chunkCount);
+    for (int begin = 0; begin < count; begin += chunkSize) {
+        const int end = qMin(count, begin + chunkSize);
+        pool.start([&classifyRange, begin, end]() {
+            classifyRange(begin, end);
+        });
     }
+    pool.waitForDone();
     
-    return false;
+    return result;
 }
 
 bool SafetyChecker::isSafeRegistryKey(const QString& keyPath) {
-    QString normalizedKey = keyPath.toUpper();
-    
-    for (const QString& protectedKey : m_protectedRegistryKeys) {
-        if (normalizedKey.startsWith(protectedKey.toUpper())) {
-            return false;
-        }
-    }
-    
-    return true;
+    return policy().isSafeRegistryKey(keyPath);
 }
 
 QStringList SafetyChecker::getProtectedPaths() const {
-    return m_protectedPaths;
+    return policy().rules().protectedPaths;
 }
 
 QStringList SafetyChecker::getProtectedApplications() const {
-    return m_protectedApplications;
+    return policy().rules().protectedApplications;
 }
@@ -5,7 +5,19 @@
 #include <QDir>
 #include <QFileInfo>
 #include <QRegularExpression>
+#include <QList>
+#include <QVector>
+#include <QMutex>
+#include <QObject>
+#include <atomic>
+#include <memory>
+#include "SafetyPolicy.h"
 
+struct ApplicationInfo;
+
+// 安全检查入口。规则来自不可变的策略快照（SafetyPolicy），
+// 读取当前快照只是一次原子加载，策略更新通过原子替换指针发布，查询路径上没有锁。
+// 旧快照不做宽限期回收，而是保留到进程结束（见m_snapshots）。
 class SafetyChecker {
 public:
     static SafetyChecker& instance();
@@ -22,6 +34,10 @@ public:
     // 检查是否为重要的系统应用
     bool isSystemApplication(const QString& appName, const QString& publisher);
     
+    // 批量判断系统应用，结果与逐个调用isSystemApplication一致；
+    // parallel为true且条目较多时分块并行处理
+    QVector<bool> classifySystemApplications(const QList<ApplicationInfo>& applications, bool parallel = false);
+    
     // 获取受保护的路径列表
     QStringList getProtectedPaths() const;
     
@@ -30,15 +46,33 @@ public:
     
     // 验证注册表键是否安全删除
     bool isSafeRegistryKey(const QString& keyPath);
+    
+    // 当前策略快照。返回的引用在进程生命周期内有效，
+    // 对同一对象的多项检查应使用同一快照以保证结果一致
+    const SafetyPolicy& policy() const;
+    
+    // 发布新的策略快照
+    void setPolicy(std::shared_ptr<const SafetyPolicy> policy);
+    
+    // 从策略文件重新加载，文件不存在时恢复内置策略，格式错误时保留当前策略
+    bool reloadPolicy();
+    
+    // 策略文件路径：BTU_POLICY_FILE环境变量（替换内置规则），
+    // 默认为AppDataLocation下的policy/policy.json（只能追加到内置规则）
+    QString policyFilePath() const;
+    
+    // 监视策略文件，变化后自动重新加载。须在主线程调用，owner销毁时停止监视
+    void watchPolicyFile(QObject* owner);
 
 private:
     SafetyChecker();
-    void initializeProtectedPaths();
-    void initializeProtectedApplications();
-    void initializeProtectedRegistryKeys();
-    
-    QStringList m_protectedPaths;
-    QStringList m_protectedApplications;
-    QStringList m_protectedRegistryKeys;
-    QStringList m_systemPublishers;
+    
+    std::atomic<const SafetyPolicy*> m_current;
+    
+    // 被替换的快照保留到进程结束，读者因此无需引用计数，policy()返回的引用可以跨越整个删除过程；
+    // 策略更新很少，占用可以忽略
+    QMutex m_publishMutex;
+    QList<std::shared_ptr<const SafetyPolicy>> m_snapshots;
+    QString m_policyFile;
+    SafetyPolicy::LoadMode m_loadMode;
 };
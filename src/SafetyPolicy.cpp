@@ -0,0 +1,263 @@
+#include "SafetyPolicy.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+namespace {
+
+// merge为true时追加到list（忽略大小写去重），否则替换list
+bool readList(const QJsonObject& object, const char* name, bool merge, QStringList& list, QString* errorMessage) {
+    const QJsonValue value = object.value(QLatin1String(name));
+    if (value.isUndefined()) {
+        return true;
+    }
+    if (!value.isArray()) {
+        if (errorMessage) {
+            *errorMessage = QString("%1 必须是字符串数组").arg(name);
+        }
+        return false;
+    }
+    
+    QStringList result;
+    for (const QJsonValue& item : value.toArray()) {
+        if (!item.isString()) {
+            if (errorMessage) {
+                *errorMessage = QString("%1 中包含非字符串项").arg(name);
+            }
+            return false;
+        }
+        if (!item.toString().isEmpty()) {
+            result.append(item.toString());
+        }
+    }
+    
+    if (!merge) {
+        list = result;
+        return true;
+    }
+    for (const QString& item : std::as_const(result)) {
+        if (!list.contains(item, Qt::CaseInsensitive)) {
+            list.append(item);
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+SafetyPolicy::Rules SafetyPolicy::defaultRules() {
+    Rules rules;
+    
+    // Windows系统关键目录
+    rules.protectedPaths << "C:\\Windows"
+                         << "C:\\Windows\\System32"
+                         << "C:\\Windows\\SysWOW64"
+                         << "C:\\Windows\\Boot"
+                         << "C:\\Windows\\Fonts"
+                         << "C:\\Windows\\drivers"
+                         << "C:\\Windows\\winsxs"
+                         << "C:\\Program Files\\Windows NT"
+                         << "C:\\Program Files\\WindowsApps"
+                         << "C:\\Program Files\\Common Files\\Microsoft Shared"
+                         << "C:\\Program Files (x86)\\Windows NT"
+                         << "C:\\Program Files (x86)\\Common Files\\Microsoft Shared"
+                         << "C:\\ProgramData\\Microsoft"
+                         << "C:\\System Volume Information"
+                         << "C:\\$Recycle.Bin"
+                         << "C:\\Recovery"
+                         << "C:\\Boot"
+                         << "C:\\bootmgr"
+                         << "C:\\pagefile.sys"
+                         << "C:\\hiberfil.sys"
+                         << "C:\\swapfile.sys";
+    
+    // 系统目录：其中的任何文件都视为系统文件
+    rules.systemDirectories << "c:/windows/system32"
+                            << "c:/windows/syswow64"
+                            << "c:/windows/winsxs"
+                            << "c:/windows/drivers";
+    
+    // 关键系统文件名，无论位于哪个目录
+    rules.systemFiles << "kernel32.dll" << "ntdll.dll" << "user32.dll" << "gdi32.dll"
+                      << "advapi32.dll" << "shell32.dll" << "ole32.dll" << "oleaut32.dll"
+                      << "rpcrt4.dll" << "msvcrt.dll" << "ws2_32.dll" << "wininet.dll"
+                      << "explorer.exe" << "winlogon.exe" << "csrss.exe" << "lsass.exe"
+                      << "services.exe" << "svchost.exe" << "spoolsv.exe" << "dwm.exe";
+    
+    // 系统关键应用程序
+    rules.protectedApplications << "Microsoft Visual C++"
+                                << "Microsoft .NET Framework"
+                                << ".NET Framework"
+                                << "Windows"
+                                << "Microsoft Edge"
+                                << "Internet Explorer"
+                                << "Windows Media Player"
+                                << "Windows Defender"
+                                << "Windows Security"
+                                << "Microsoft Store"
+                                << "Xbox"
+                                << "Cortana"
+                                << "Windows Photos"
+                                << "Windows Camera"
+                                << "Windows Calculator"
+                                << "Windows Mail"
+                                << "Windows Maps"
+                                << "Windows Sound Recorder"
+                                << "Windows Alarms & Clock"
+                                << "Windows Sticky Notes"
+                                << "Windows Feedback Hub"
+                                << "Windows Get Help"
+                                << "Windows Tips"
+                                << "Microsoft Solitaire Collection"
+                                << "Microsoft Minesweeper";
+    
+    // 系统发布商
+    rules.systemPublishers << "Microsoft Corporation"
+                           << "Microsoft"
+                           << "Windows Software Developer"
+                           << "Microsoft Windows"
+                           << "Intel Corporation"
+                           << "NVIDIA Corporation"
+                           << "AMD"
+                           << "Realtek Semiconductor Corp."
+                           << "Qualcomm Atheros"
+                           << "Broadcom"
+                           << "Dell Inc."
+                           << "HP Inc."
+                           << "Lenovo"
+                           << "ASUS"
+                           << "Acer Incorporated";
+    
+    // 受保护的注册表键
+    rules.protectedRegistryKeys << "HKEY_LOCAL_MACHINE\\SOFTWARE\\Microsoft\\Windows\\CurrentVersion\\Run"
+                                << "HKEY_LOCAL_MACHINE\\SOFTWARE\\Microsoft\\Windows NT\\CurrentVersion"
+                                << "HKEY_LOCAL_MACHINE\\SYSTEM"
+                                << "HKEY_LOCAL_MACHINE\\HARDWARE"
+                                << "HKEY_LOCAL_MACHINE\\SAM"
+                                << "HKEY_LOCAL_MACHINE\\SECURITY"
+                                << "HKEY_LOCAL_MACHINE\\SOFTWARE\\Classes"
+                                << "HKEY_CURRENT_USER\\SOFTWARE\\Microsoft\\Windows\\CurrentVersion\\Run"
+                                << "HKEY_USERS\\.DEFAULT";
+    
+    return rules;
+}
+
+std::shared_ptr<const SafetyPolicy> SafetyPolicy::compile(const Rules& rules, const QString& source) {
+    std::shared_ptr<SafetyPolicy> policy(new SafetyPolicy());
+    policy->m_rules = rules;
+    policy->m_source = source;
+    
+    for (const QString& path : rules.protectedPaths) {
+        policy->m_protectedPathTrie.insert(path);
+    }
+    for (const QString& dir : rules.systemDirectories) {
+        policy->m_systemDirTrie.insert(dir);
+    }
+    for (const QString& key : rules.protectedRegistryKeys) {
+        policy->m_protectedRegistryTrie.insert(key);
+    }
+    for (const QString& name : rules.systemFiles) {
+        policy->m_systemFileNames.insert(name);
+    }
+    policy->m_protectedAppAutomaton.build(rules.protectedApplications);
+    policy->m_systemPublisherAutomaton.build(rules.systemPublishers);
+    
+    return policy;
+}
+
+std::shared_ptr<const SafetyPolicy> SafetyPolicy::load(const QString& filePath, LoadMode mode, QString* errorMessage) {
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (errorMessage) {
+            *errorMessage = QString("无法打开策略文件: %1").arg(file.errorString());
+        }
+        return nullptr;
+    }
+    
+    QJsonParseError parseError;
+    const QJsonDocument document = QJsonDocument::fromJson(file.readAll(), &parseError);
+    if (parseError.error != QJsonParseError::NoError || !document.isObject()) {
+        if (errorMessage) {
+            *errorMessage = QString("策略文件格式错误: %1").arg(parseError.errorString());
+        }
+        return nullptr;
+    }
+    
+    const QJsonObject object = document.object();
+    Rules rules = defaultRules();
+    const bool merge = mode == Merge;
+    if (!readList(object, "protectedPaths", merge, rules.protectedPaths, errorMessage)
+        || !readList(object, "systemDirectories", merge, rules.systemDirectories, errorMessage)
+        || !readList(object, "systemFiles", merge, rules.systemFiles, errorMessage)
+        || !readList(object, "protectedApplications", merge, rules.protectedApplications, errorMessage)
+        || !readList(object, "systemPublishers", merge, rules.systemPublishers, errorMessage)
+        || !readList(object, "protectedRegistryKeys", merge, rules.protectedRegistryKeys, errorMessage)) {
+        return nullptr;
+    }
+    
+    return compile(rules, QFileInfo(filePath).absoluteFilePath());
+}
+
+bool SafetyPolicy::isSystemCriticalPath(QStringView path) const {
+    // 前缀树已折叠大小写和分隔符，直接按原始路径查询
+    return m_protectedPathTrie.matchesPrefix(path);
+}
+
+bool SafetyPolicy::isWindowsSystemFile(const QString& filePath) const {
+    // 相对路径先转为绝对路径，与按所在目录判断的语义保持一致
+    if (QDir::isRelativePath(filePath)) {
+        return isWindowsSystemFile(QFileInfo(filePath).absoluteFilePath());
+    }
+    
+    QStringView path(filePath);
+    const qsizetype separator = qMax(path.lastIndexOf(u'/'), path.lastIndexOf(u'\\'));
+    const QStringView dirPath = separator >= 0 ? path.left(separator) : QStringView();
+    const QStringView fileName = separator >= 0 ? path.mid(separator + 1) : path;
+    
+    // 检查是否在系统目录中
+    if (m_systemDirTrie.matchesPrefix(dirPath)) {
+        return true;
+    }
+    
+    // 检查关键系统文件
+    return m_systemFileNames.contains(fileName);
+}
+
+bool SafetyPolicy::isSystemFileName(QStringView fileName) const {
+    return m_systemFileNames.contains(fileName);
+}
+
+bool SafetyPolicy::isSubtreeClear(QStringView directory) const {
+    return !m_protectedPathTrie.matchesPrefix(directory)
+        && !m_systemDirTrie.matchesPrefix(directory)
+        && !m_protectedPathTrie.hasPrefixBelow(directory)
+        && !m_systemDirTrie.hasPrefixBelow(directory);
+}
+
+bool SafetyPolicy::isEntryBlocked(QStringView directory, QStringView name, bool isDirectory, bool subtreeClear) const {
+    if (subtreeClear) {
+        return !isDirectory && isSystemFileName(name);
+    }
+    
+    QString path = directory.toString();
+    if (!path.endsWith(QLatin1Char('/')) && !path.endsWith(QLatin1Char('\\'))) {
+        path.append(QLatin1Char('/'));
+    }
+    path.append(name);
+    if (isSystemCriticalPath(path)) {
+        return true;
+    }
+    return !isDirectory && isWindowsSystemFile(path);
+}
+
+bool SafetyPolicy::isSystemApplication(QStringView appName, QStringView publisher) const {
+    // 名称或发布商包含任一受保护的关键字（不区分大小写）
+    return m_protectedAppAutomaton.matches(appName) || m_systemPublisherAutomaton.matches(publisher);
+}
+
+bool SafetyPolicy::isSafeRegistryKey(QStringView keyPath) const {
+    return !m_protectedRegistryTrie.matchesPrefix(keyPath);
+}
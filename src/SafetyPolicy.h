@@ -0,0 +1,68 @@
+#pragma once
+
+#include "PathPrefixTrie.h"
+#include "PatternAutomaton.h"
+#include <QString>
+#include <QStringList>
+#include <memory>
+
+// 安全策略快照：受保护的路径、应用、发布商和注册表键，以及由它们编译出的查询结构。
+// 创建后不可修改，多个线程可以不加锁地同时查询。
+class SafetyPolicy {
+public:
+    struct Rules {
+        QStringList protectedPaths;          // 前缀匹配的关键路径
+        QStringList systemDirectories;       // 其中所有文件都视为系统文件的目录
+        QStringList systemFiles;             // 关键系统文件名
+        QStringList protectedApplications;   // 名称包含即视为系统应用
+        QStringList systemPublishers;        // 发布商包含即视为系统应用
+        QStringList protectedRegistryKeys;   // 前缀匹配的受保护注册表键
+    };
+    
+    // 内置的默认规则
+    static Rules defaultRules();
+    
+    // 编译规则得到快照
+    static std::shared_ptr<const SafetyPolicy> compile(const Rules& rules, const QString& source = QString());
+    
+    enum LoadMode {
+        Merge,    // 文件中的条目追加到默认规则，只能增加保护
+        Replace   // 文件中出现的分组替换对应的默认规则，未出现的分组沿用默认规则
+    };
+    
+    // 从JSON策略文件加载。失败时返回空指针并通过errorMessage说明原因
+    static std::shared_ptr<const SafetyPolicy> load(const QString& filePath, LoadMode mode,
+                                                    QString* errorMessage = nullptr);
+    
+    const Rules& rules() const { return m_rules; }
+    const QString& source() const { return m_source; }
+    
+    bool isSystemCriticalPath(QStringView path) const;
+    bool isWindowsSystemFile(const QString& filePath) const;
+    
+    // 文件名是否为关键系统文件（不考虑所在目录）
+    bool isSystemFileName(QStringView fileName) const;
+    
+    // 目录及其整个子树是否都不涉及受保护路径和系统目录。
+    // 成立时子孙条目只需再检查文件名，递归删除据此把判定结果沿子树向下复用
+    bool isSubtreeClear(QStringView directory) const;
+    
+    // 递归删除时目录directory中的条目name是否应被拦截。
+    // subtreeClear为true（directory所在子树已确认安全）时只检查文件名，不拼接完整路径
+    bool isEntryBlocked(QStringView directory, QStringView name, bool isDirectory, bool subtreeClear) const;
+    bool isSystemApplication(QStringView appName, QStringView publisher) const;
+    bool isSafeRegistryKey(QStringView keyPath) const;
+
+private:
+    SafetyPolicy() = default;
+    
+    Rules m_rules;
+    QString m_source;  // 策略来源（文件路径，内置策略为空）
+    
+    PathPrefixTrie m_protectedPathTrie;
+    PathPrefixTrie m_systemDirTrie;
+    PathPrefixTrie m_protectedRegistryTrie;
+    FoldedNameSet m_systemFileNames;
+    PatternAutomaton m_protectedAppAutomaton;
+    PatternAutomaton m_systemPublisherAutomaton;
+};
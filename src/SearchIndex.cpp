@@ -0,0 +1,218 @@
+#include "SearchIndex.h"
+#include <algorithm>
+
+namespace {
+
+// 排名：名称前缀 < 名称单词开头 < 名称包含 < 发布商包含
+enum MatchRank {
+    RankNamePrefix = 0,
+    RankNameWord = 1,
+    RankNameContains = 2,
+    RankPublisher = 3,
+    RankNoMatch = 4
+};
+
+} // namespace
+
+SearchIndex::SearchIndex() {
+}
+
+void SearchIndex::clear() {
+    m_documents.clear();
+    m_freeIds.clear();
+    m_idByKey.clear();
+    m_postings.clear();
+}
+
+quint64 SearchIndex::trigramAt(const QString& text, int pos) {
+    return (static_cast<quint64>(text.at(pos).unicode()) << 32) |
+           (static_cast<quint64>(text.at(pos + 1).unicode()) << 16) |
+           static_cast<quint64>(text.at(pos + 2).unicode());
+}
+
+QVector<quint64> SearchIndex::trigramsOf(const Document& doc) {
+    QVector<quint64> trigrams;
+    trigrams.reserve(qMax<qsizetype>(0, doc.foldedName.size() - 2) +
+                     qMax<qsizetype>(0, doc.foldedPublisher.size() - 2));
+    
+    for (const QString* text : {&doc.foldedName, &doc.foldedPublisher}) {
+        for (int pos = 0; pos + 3 <= text->size(); ++pos) {
+            trigrams.append(trigramAt(*text, pos));
+        }
+    }
+    
+    std::sort(trigrams.begin(), trigrams.end());
+    trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+    return trigrams;
+}
+
+void SearchIndex::insert(const QString& key, const QString& name, const QString& publisher) {
+    remove(key);
+    
+    int id;
+    if (!m_freeIds.isEmpty()) {
+        id = m_freeIds.takeLast();
+    } else {
+        id = static_cast<int>(m_documents.size());
+        m_documents.append(Document());
+    }
+    
+    Document& doc = m_documents[id];
+    doc.key = key;
+    doc.foldedName = name.toCaseFolded();
+    doc.foldedPublisher = publisher.toCaseFolded();
+    doc.alive = true;
+    m_idByKey.insert(key, id);
+    
+    // 复用的ID可能小于已有ID，按序插入保持倒排表有序
+    for (quint64 trigram : trigramsOf(doc)) {
+        QVector<int>& postings = m_postings[trigram];
+        postings.insert(std::lower_bound(postings.begin(), postings.end(), id), id);
+    }
+}
+
+void SearchIndex::remove(const QString& key) {
+    auto it = m_idByKey.find(key);
+    if (it == m_idByKey.end()) {
+        return;
+    }
+    
+    const int id = it.value();
+    m_idByKey.erase(it);
+    
+    Document& doc = m_documents[id];
+    for (quint64 trigram : trigramsOf(doc)) {
+        auto postingIt = m_postings.find(trigram);
+        if (postingIt == m_postings.end()) {
+            continue;
+        }
+        QVector<int>& postings = postingIt.value();
+        auto pos = std::lower_bound(postings.begin(), postings.end(), id);
+        if (pos != postings.end() && *pos == id) {
+            postings.erase(pos);
+        }
+        if (postings.isEmpty()) {
+            m_postings.erase(postingIt);
+        }
+    }
+    
+    doc = Document();
+    doc.alive = false;
+    m_freeIds.append(id);
+}
+
+int SearchIndex::matchRank(const Document& doc, const QString& foldedKeyword) const {
+    int pos = doc.foldedName.indexOf(foldedKeyword);
+    if (pos == 0) {
+        return RankNamePrefix;
+    }
+    if (pos > 0) {
+        // 在名称中查找落在单词开头的匹配
+        while (pos > 0) {
+            if (!doc.foldedName.at(pos - 1).isLetterOrNumber()) {
+                return RankNameWord;
+            }
+            pos = doc.foldedName.indexOf(foldedKeyword, pos + 1);
+        }
+        return RankNameContains;
+    }
+    if (doc.foldedPublisher.contains(foldedKeyword)) {
+        return RankPublisher;
+    }
+    return RankNoMatch;
+}
+
+QStringList SearchIndex::search(const QString& keyword) const {
+    const QString folded = keyword.trimmed().toCaseFolded();
+    
+    QVector<int> candidates;
+    bool verifyAll = false;
+    
+    if (folded.isEmpty()) {
+        QStringList keys;
+        keys.reserve(m_idByKey.size());
+        for (const Document& doc : m_documents) {
+            if (doc.alive) {
+                keys.append(doc.key);
+            }
+        }
+        return keys;
+    }
+    
+    if (folded.size() < 3) {
+        // 过短的关键字无法形成三元组，直接扫描折叠后的文本
+        verifyAll = true;
+    } else {
+        // 取出所有查询三元组的倒排表，从最短的开始求交集
+        QVector<const QVector<int>*> lists;
+        for (int pos = 0; pos + 3 <= folded.size(); ++pos) {
+            auto it = m_postings.constFind(trigramAt(folded, pos));
+            if (it == m_postings.constEnd()) {
+                return QStringList();
+            }
+            lists.append(&it.value());
+        }
+        std::sort(lists.begin(), lists.end(), [](const QVector<int>* a, const QVector<int>* b) {
+            return a->size() < b->size();
+        });
+        
+        candidates = *lists.first();
+        QVector<int> intersection;
+        for (int i = 1; i < lists.size() && !candidates.isEmpty(); ++i) {
+            if (lists[i] == lists[i - 1]) {
+                continue;
+            }
+            intersection.clear();
+            std::set_intersection(candidates.cbegin(), candidates.cend(),
+                                  lists[i]->cbegin(), lists[i]->cend(),
+                                  std::back_inserter(intersection));
+            candidates.swap(intersection);
+        }
+    }
+    
+    // 逐条确认真实匹配并计算排名
+    struct Hit {
+        int rank;
+        int id;
+    };
+    QVector<Hit> hits;
+    
+    auto consider = [&](int id) {
+        const Document& doc = m_documents[id];
+        if (!doc.alive) {
+            return;
+        }
+        int rank = matchRank(doc, folded);
+        if (rank != RankNoMatch) {
+            hits.append({rank, id});
+        }
+    };
+    
+    if (verifyAll) {
+        for (int id = 0; id < static_cast<int>(m_documents.size()); ++id) {
+            consider(id);
+        }
+    } else {
+        for (int id : candidates) {
+            consider(id);
+        }
+    }
+    
+    std::stable_sort(hits.begin(), hits.end(), [this](const Hit& a, const Hit& b) {
+        if (a.rank != b.rank) {
+            return a.rank < b.rank;
+        }
+        return m_documents[a.id].foldedName < m_documents[b.id].foldedName;
+    });
+    
+    QStringList keys;
+    keys.reserve(hits.size());
+    for (const Hit& hit : hits) {
+        keys.append(m_documents[hit.id].key);
+    }
+    return keys;
+}
+
+int SearchIndex::size() const {
+    return m_idByKey.size();
+}
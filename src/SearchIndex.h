@@ -0,0 +1,45 @@
+#pragma once
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+
+// 应用搜索索引：对名称和发布商的大小写折叠文本建立三元组倒排表，
+// 查询时求交集并按匹配位置排序。非线程安全，由调用方加锁。
+class SearchIndex {
+public:
+    SearchIndex();
+    
+    // 清空索引
+    void clear();
+    
+    // 插入或替换一条记录
+    void insert(const QString& key, const QString& name, const QString& publisher);
+    
+    // 删除一条记录
+    void remove(const QString& key);
+    
+    // 查询关键字，返回按相关度排序的记录键；关键字为空时返回全部记录
+    QStringList search(const QString& keyword) const;
+    
+    // 当前记录数
+    int size() const;
+
+private:
+    struct Document {
+        QString key;
+        QString foldedName;
+        QString foldedPublisher;
+        bool alive;
+    };
+    
+    static quint64 trigramAt(const QString& text, int pos);
+    static QVector<quint64> trigramsOf(const Document& doc);
+    int matchRank(const Document& doc, const QString& foldedKeyword) const;
+    
+    QVector<Document> m_documents;
+    QVector<int> m_freeIds;
+    QHash<QString, int> m_idByKey;
+    QHash<quint64, QVector<int>> m_postings; // 三元组 -> 升序文档ID
+};
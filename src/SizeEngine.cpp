@@ -0,0 +1,487 @@
+#include "SizeEngine.h"
+#include "WorkStealingPool.h"
+#include "Logger.h"
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QDataStream>
+#include <QFileInfo>
+#include <QStandardPaths>
+#include <QElapsedTimer>
+#include <QSet>
+#include <QSemaphore>
+#include <utility>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const quint32 kCacheMagic = 0x42545553; // "BTUS"
+const quint32 kCacheVersion = 1;
+
+// 连续多少轮计算未访问的目录记录在保存时丢弃
+const quint32 kCacheRetainRuns = 8;
+
+// 引擎析构时等待计算线程结束的最长时间
+const int kTeardownWaitMs = 3000;
+
+} // namespace
+
+struct SizeEngine::State {
+    QMutex cacheMutex;
+    QHash<QString, DirectoryRecord> cache; // 目录标识 -> 统计
+    quint32 runCounter = 0;
+    
+    // 引擎析构时置空；计算线程持锁投递事件，投递期间引擎不会被销毁
+    QMutex engineMutex;
+    SizeEngine* engine = nullptr;
+};
+
+struct SizeEngine::Job {
+    std::shared_ptr<State> state;
+    std::atomic<bool> stop{false};
+    QSemaphore finished;  // 线程结束时释放
+};
+
+struct SizeEngine::RootState {
+    QString registryKey;
+    std::atomic<int> outstanding{1};
+    std::atomic<qint64> logicalBytes{0};
+    std::atomic<qint64> allocatedBytes{0};
+    qint64 clusterSize = 0;
+    
+    // 同一安装目录内的硬链接只计一次
+    QMutex linkMutex;
+    QSet<QPair<quint64, quint64>> seenLinks;
+};
+
+QDataStream& operator<<(QDataStream& out, const SizeEngine::LinkedFile& file) {
+    out << file.device << file.inode << file.logicalBytes << file.allocatedBytes;
+    return out;
+}
+
+QDataStream& operator>>(QDataStream& in, SizeEngine::LinkedFile& file) {
+    in >> file.device >> file.inode >> file.logicalBytes >> file.allocatedBytes;
+    return in;
+}
+
+QDataStream& operator<<(QDataStream& out, const SizeEngine::DirectoryRecord& record) {
+    out << record.modifiedTime << record.logicalBytes << record.allocatedBytes
+        << record.linkedFiles << record.subdirectories << record.lastUsedRun;
+    return out;
+}
+
+QDataStream& operator>>(QDataStream& in, SizeEngine::DirectoryRecord& record) {
+    in >> record.modifiedTime >> record.logicalBytes >> record.allocatedBytes
+       >> record.linkedFiles >> record.subdirectories >> record.lastUsedRun;
+    return in;
+}
+
+SizeEngine::SizeEngine(QObject* parent)
+    : QObject(parent)
+    , m_state(std::make_shared<State>())
+    , m_hasPendingTargets(false)
+{
+    m_state->engine = this;
+    loadCache(*m_state);
+}
+
+SizeEngine::~SizeEngine() {
+    // 断开结果投递后有限等待计算线程结束，避免它在程序退出过程中仍写缓存和日志
+    cancel();
+    {
+        QMutexLocker locker(&m_state->engineMutex);
+        m_state->engine = nullptr;
+    }
+    if (m_job && !m_job->finished.tryAcquire(1, kTeardownWaitMs)) {
+        LOG_WARNING("目录占用计算线程未能及时结束");
+    }
+}
+
+QString SizeEngine::defaultCachePath() {
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/size_cache.bin";
+}
+
+template <typename Functor>
+void SizeEngine::post(State& state, Functor functor) {
+    QMutexLocker locker(&state.engineMutex);
+    SizeEngine* engine = state.engine;
+    if (engine) {
+        QMetaObject::invokeMethod(engine, [engine, functor]() { functor(engine); }, Qt::QueuedConnection);
+    }
+}
+
+void SizeEngine::calculate(const QList<QPair<QString, QString>>& targets) {
+    if (m_job) {
+        m_job->stop = true;
+        m_pendingTargets = targets;
+        m_hasPendingTargets = true;
+        return;
+    }
+    
+    start(targets);
+}
+
+void SizeEngine::start(const QList<QPair<QString, QString>>& targets) {
+    auto job = std::make_shared<Job>();
+    job->state = m_state;
+    m_job = job;
+    
+    // 线程结束后自行销毁，引擎不持有它
+    QThread* thread = QThread::create([job, targets]() {
+        run(job, targets);
+        post(*job->state, [job](SizeEngine* engine) {
+            engine->onJobFinished(job);
+        });
+        job->finished.release();
+    });
+    connect(thread, &QThread::finished, thread, &QObject::deleteLater);
+    thread->start(QThread::LowPriority);
+}
+
+void SizeEngine::onJobFinished(const std::shared_ptr<Job>& job) {
+    if (job != m_job) {
+        return;
+    }
+    m_job.reset();
+    
+    if (m_hasPendingTargets) {
+        m_hasPendingTargets = false;
+        start(std::exchange(m_pendingTargets, {}));
+        return;
+    }
+    
+    emit finished();
+}
+
+void SizeEngine::cancel() {
+    m_pendingTargets.clear();
+    m_hasPendingTargets = false;
+    if (m_job) {
+        m_job->stop = true;
+    }
+}
+
+bool SizeEngine::isRunning() const {
+    return m_job != nullptr;
+}
+
+void SizeEngine::run(const std::shared_ptr<Job>& job, const QList<QPair<QString, QString>>& targets) {
+    QElapsedTimer timer;
+    timer.start();
+    
+    State& state = *job->state;
+    {
+        QMutexLocker locker(&state.cacheMutex);
+        ++state.runCounter;
+    }
+    
+    WorkStealingPool pool;
+    int rootCount = 0;
+    
+    for (const auto& target : targets) {
+        const QString& path = target.second;
+        if (path.isEmpty()) {
+            continue;
+        }
+        
+        QFileInfo info(path);
+        // 不统计驱动器根目录等明显不属于单个应用的位置
+        if (!info.isDir() || QDir(info.absoluteFilePath()).isRoot()) {
+            continue;
+        }
+        
+        auto root = std::make_shared<RootState>();
+        root->registryKey = target.first;
+        
+#ifdef Q_OS_WIN
+        DWORD sectorsPerCluster = 0;
+        DWORD bytesPerSector = 0;
+        DWORD freeClusters = 0;
+        DWORD totalClusters = 0;
+        const QString volume = QDir::toNativeSeparators(QFileInfo(path).absoluteFilePath().left(3));
+        if (GetDiskFreeSpaceW(reinterpret_cast<LPCWSTR>(volume.utf16()), &sectorsPerCluster,
+                              &bytesPerSector, &freeClusters, &totalClusters)) {
+            root->clusterSize = static_cast<qint64>(sectorsPerCluster) * bytesPerSector;
+        }
+#endif
+        
+        const QString rootPath = QDir::cleanPath(info.absoluteFilePath());
+        pool.submit([&job = *job, &pool, root, rootPath](int) {
+            walkDirectory(job, pool, root, rootPath);
+        });
+        ++rootCount;
+    }
+    
+    pool.waitForDone();
+    
+    // 引擎等待超时已销毁时不再写缓存和日志
+    {
+        QMutexLocker locker(&state.engineMutex);
+        if (!state.engine) {
+            return;
+        }
+    }
+    
+    if (!job->stop) {
+        saveCache(state);
+    }
+    
+    LOG_INFO(QString("目录占用计算完成: %1 个目录, 耗时 %2 ms%3")
+             .arg(rootCount).arg(timer.elapsed()).arg(job->stop ? "（已取消）" : ""));
+}
+
+void SizeEngine::walkDirectory(Job& job, WorkStealingPool& pool, const std::shared_ptr<RootState>& root,
+                               const QString& path) {
+    if (job.stop) {
+        finishDirectory(job, root);
+        return;
+    }
+    
+    State& state = *job.state;
+    QString identity;
+    qint64 modifiedTime = 0;
+    DirectoryRecord record;
+    
+    if (statDirectory(path, identity, modifiedTime)) {
+        bool cached = false;
+        {
+            QMutexLocker locker(&state.cacheMutex);
+            auto it = state.cache.find(identity);
+            if (it != state.cache.end() && it->modifiedTime == modifiedTime) {
+                it->lastUsedRun = state.runCounter;
+                record = *it;
+                cached = true;
+            }
+        }
+        
+        // 目录修改时间只反映直接子项的增删改名，文件内容变化会改变大小但不改变目录时间，
+        // 这里接受这一近似以换取重复扫描时跳过未变化的目录
+        if (!cached && readDirectory(path, record, root->clusterSize)) {
+            record.modifiedTime = modifiedTime;
+            QMutexLocker locker(&state.cacheMutex);
+            record.lastUsedRun = state.runCounter;
+            state.cache.insert(identity, record);
+        }
+    }
+    
+    root->logicalBytes += record.logicalBytes;
+    root->allocatedBytes += record.allocatedBytes;
+    
+    if (!record.linkedFiles.isEmpty()) {
+        QMutexLocker locker(&root->linkMutex);
+        for (const LinkedFile& file : record.linkedFiles) {
+            if (!root->seenLinks.contains(qMakePair(file.device, file.inode))) {
+                root->seenLinks.insert(qMakePair(file.device, file.inode));
+                root->logicalBytes += file.logicalBytes;
+                root->allocatedBytes += file.allocatedBytes;
+            }
+        }
+    }
+    
+    for (const QString& name : record.subdirectories) {
+        const QString childPath = path + QLatin1Char('/') + name;
+        root->outstanding.fetch_add(1);
+        pool.submit([&job, &pool, root, childPath](int) {
+            walkDirectory(job, pool, root, childPath);
+        });
+    }
+    
+    finishDirectory(job, root);
+}
+
+void SizeEngine::finishDirectory(Job& job, const std::shared_ptr<RootState>& root) {
+    if (root->outstanding.fetch_sub(1) == 1 && !job.stop) {
+        const QString registryKey = root->registryKey;
+        const qint64 logicalBytes = root->logicalBytes.load();
+        const qint64 allocatedBytes = root->allocatedBytes.load();
+        post(*job.state, [registryKey, logicalBytes, allocatedBytes](SizeEngine* engine) {
+            emit engine->sizeCalculated(registryKey, logicalBytes, allocatedBytes);
+        });
+    }
+}
+
+#ifdef Q_OS_WIN
+
+bool SizeEngine::statDirectory(const QString& path, QString& identity, qint64& modifiedTime) {
+    WIN32_FILE_ATTRIBUTE_DATA data;
+    const QString nativePath = QDir::toNativeSeparators(path);
+    if (!GetFileAttributesExW(reinterpret_cast<LPCWSTR>(nativePath.utf16()), GetFileExInfoStandard, &data)) {
+        return false;
+    }
+    
+    // Windows下以规范化路径作为目录标识
+    identity = path.toLower();
+    modifiedTime = (static_cast<qint64>(data.ftLastWriteTime.dwHighDateTime) << 32)
+                   | data.ftLastWriteTime.dwLowDateTime;
+    return true;
+}
+
+bool SizeEngine::readDirectory(const QString& path, DirectoryRecord& record, qint64 clusterSize) {
+    const QString pattern = QDir::toNativeSeparators(path) + QLatin1String("\\*");
+    WIN32_FIND_DATAW data;
+    HANDLE handle = FindFirstFileExW(reinterpret_cast<LPCWSTR>(pattern.utf16()), FindExInfoBasic, &data,
+                                     FindExSearchNameMatch, nullptr, FIND_FIRST_EX_LARGE_FETCH);
+    if (handle == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    
+    do {
+        const QString name = QString::fromWCharArray(data.cFileName);
+        if (name == QLatin1String(".") || name == QLatin1String("..")) {
+            continue;
+        }
+        
+        // 不跟随联接点和符号链接
+        if (data.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT) {
+            continue;
+        }
+        
+        if (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+            record.subdirectories.append(name);
+            continue;
+        }
+        
+        const qint64 size = (static_cast<qint64>(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+        qint64 allocated = size;
+        if (clusterSize > 0) {
+            allocated = (size + clusterSize - 1) / clusterSize * clusterSize;
+        }
+        
+        // 枚举结果不含链接计数，Windows下硬链接不去重
+        record.logicalBytes += size;
+        record.allocatedBytes += allocated;
+    } while (FindNextFileW(handle, &data));
+    
+    FindClose(handle);
+    return true;
+}
+
+#else
+
+bool SizeEngine::statDirectory(const QString& path, QString& identity, qint64& modifiedTime) {
+    struct stat st;
+    if (lstat(QFile::encodeName(path).constData(), &st) != 0 || !S_ISDIR(st.st_mode)) {
+        return false;
+    }
+    
+    identity = QString("%1:%2").arg(static_cast<quint64>(st.st_dev)).arg(static_cast<quint64>(st.st_ino));
+    modifiedTime = static_cast<qint64>(st.st_mtim.tv_sec) * 1000000000LL + st.st_mtim.tv_nsec;
+    return true;
+}
+
+bool SizeEngine::readDirectory(const QString& path, DirectoryRecord& record, qint64 clusterSize) {
+    Q_UNUSED(clusterSize);
+    
+    DIR* dir = opendir(QFile::encodeName(path).constData());
+    if (!dir) {
+        return false;
+    }
+    
+    const int fd = dirfd(dir);
+    struct stat dirStat;
+    if (fstat(fd, &dirStat) != 0) {
+        closedir(dir);
+        return false;
+    }
+    
+    while (struct dirent* entry = readdir(dir)) {
+        const char* name = entry->d_name;
+        if (qstrcmp(name, ".") == 0 || qstrcmp(name, "..") == 0) {
+            continue;
+        }
+        
+        struct stat st;
+        if (fstatat(fd, name, &st, AT_SYMLINK_NOFOLLOW) != 0) {
+            continue;
+        }
+        
+        if (S_ISDIR(st.st_mode)) {
+            // 不跨越挂载点
+            if (st.st_dev == dirStat.st_dev) {
+                record.subdirectories.append(QFile::decodeName(name));
+            }
+            continue;
+        }
+        
+        const qint64 logical = static_cast<qint64>(st.st_size);
+        const qint64 allocated = static_cast<qint64>(st.st_blocks) * 512;
+        
+        if (S_ISREG(st.st_mode) && st.st_nlink > 1) {
+            record.linkedFiles.append({static_cast<quint64>(st.st_dev), static_cast<quint64>(st.st_ino),
+                                       logical, allocated});
+        } else {
+            record.logicalBytes += logical;
+            record.allocatedBytes += allocated;
+        }
+    }
+    
+    closedir(dir);
+    return true;
+}
+
+#endif
+
+void SizeEngine::loadCache(State& state) {
+    QFile file(defaultCachePath());
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+    
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_0);
+    
+    quint32 magic = 0;
+    quint32 version = 0;
+    in >> magic >> version;
+    if (magic != kCacheMagic || version != kCacheVersion) {
+        LOG_INFO("目录大小缓存版本不匹配，将重新计算");
+        return;
+    }
+    
+    QHash<QString, DirectoryRecord> cache;
+    quint32 runCounter = 0;
+    in >> runCounter >> cache;
+    if (in.status() != QDataStream::Ok) {
+        LOG_WARNING("目录大小缓存已损坏，将重新计算");
+        return;
+    }
+    
+    QMutexLocker locker(&state.cacheMutex);
+    state.cache = std::move(cache);
+    state.runCounter = runCounter;
+}
+
+void SizeEngine::saveCache(State& state) {
+    QMutexLocker locker(&state.cacheMutex);
+    
+    // 丢弃长时间未访问的目录（已卸载或已移动）
+    const quint32 runCounter = state.runCounter;
+    state.cache.removeIf([runCounter](const QHash<QString, DirectoryRecord>::iterator it) {
+        return runCounter - it->lastUsedRun > kCacheRetainRuns;
+    });
+    
+    const QString filePath = defaultCachePath();
+    QDir().mkpath(QFileInfo(filePath).absolutePath());
+    
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        LOG_WARNING(QString("无法写入目录大小缓存: %1").arg(filePath));
+        return;
+    }
+    
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << kCacheMagic << kCacheVersion << state.runCounter << state.cache;
+    
+    if (!file.commit()) {
+        LOG_WARNING(QString("保存目录大小缓存失败: %1").arg(filePath));
+    }
+}
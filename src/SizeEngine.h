@@ -0,0 +1,99 @@
+#pragma once
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QPair>
+#include <QHash>
+#include <QMutex>
+#include <QThread>
+#include <QDataStream>
+#include <atomic>
+#include <memory>
+
+class WorkStealingPool;
+
+// 磁盘占用计算引擎：用工作窃取线程池并行遍历安装目录，
+// 统计逻辑大小和实际分配大小，硬链接只计一次。
+// 每个目录的直接文件统计按目录标识和修改时间缓存并持久化，重复扫描时
+// 未变化的目录无需重新读取。
+class SizeEngine : public QObject {
+    Q_OBJECT
+
+public:
+    explicit SizeEngine(QObject* parent = nullptr);
+    ~SizeEngine();
+    
+    // 后台计算一批目录的占用，targets为(注册表键, 安装目录)，
+    // 每个目录完成后立即发送sizeCalculated。正在计算时取消当前批次，
+    // 待其线程结束后再开始新批次，不在调用线程中等待
+    void calculate(const QList<QPair<QString, QString>>& targets);
+    
+    // 取消正在进行的计算，线程结束后仍发送finished
+    void cancel();
+    
+    // 有批次正在计算或其线程尚未结束
+    bool isRunning() const;
+    
+    // 默认缓存文件路径（位于AppDataLocation）
+    static QString defaultCachePath();
+
+signals:
+    void sizeCalculated(const QString& registryKey, qint64 logicalBytes, qint64 allocatedBytes);
+    void finished();
+
+private:
+    // 链接数大于1的文件，按(设备, 索引节点)去重
+    struct LinkedFile {
+        quint64 device;
+        quint64 inode;
+        qint64 logicalBytes;
+        qint64 allocatedBytes;
+    };
+    
+    // 单个目录的直接内容统计（不含子目录）
+    struct DirectoryRecord {
+        qint64 modifiedTime = 0;
+        qint64 logicalBytes = 0;
+        qint64 allocatedBytes = 0;
+        QList<LinkedFile> linkedFiles;
+        QStringList subdirectories;
+        quint32 lastUsedRun = 0;
+    };
+    
+    // 缓存和结果投递目标，由引擎和计算线程共享，引擎销毁后计算线程仍可安全结束
+    struct State;
+    
+    // 一个批次的计算，线程只通过它访问共享状态
+    struct Job;
+    
+    struct RootState;
+    
+    void start(const QList<QPair<QString, QString>>& targets);
+    void onJobFinished(const std::shared_ptr<Job>& job);
+    
+    static void run(const std::shared_ptr<Job>& job, const QList<QPair<QString, QString>>& targets);
+    static void walkDirectory(Job& job, WorkStealingPool& pool, const std::shared_ptr<RootState>& root,
+                              const QString& path);
+    static void finishDirectory(Job& job, const std::shared_ptr<RootState>& root);
+    static bool statDirectory(const QString& path, QString& identity, qint64& modifiedTime);
+    static bool readDirectory(const QString& path, DirectoryRecord& record, qint64 clusterSize);
+    
+    // 在引擎所在线程中以引擎为参数执行functor，引擎已销毁时丢弃
+    template <typename Functor>
+    static void post(State& state, Functor functor);
+    
+    static void loadCache(State& state);
+    static void saveCache(State& state);
+    
+    friend QDataStream& operator<<(QDataStream& out, const LinkedFile& file);
+    friend QDataStream& operator>>(QDataStream& in, LinkedFile& file);
+    friend QDataStream& operator<<(QDataStream& out, const DirectoryRecord& record);
+    friend QDataStream& operator>>(QDataStream& in, DirectoryRecord& record);
+    
+    std::shared_ptr<State> m_state;
+    std::shared_ptr<Job> m_job;                        // 当前批次，其线程结束前不为空
+    QList<QPair<QString, QString>> m_pendingTargets;   // 当前批次取消后接着计算的批次
+    bool m_hasPendingTargets;
+};
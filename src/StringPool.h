@@ -0,0 +1,39 @@
+#pragma once
+
+#include <QString>
+#include <QSet>
+#include <QMutex>
+
+// 字符串驻留池：相同内容的字符串共享同一份隐式共享数据，
+// 用于发布商等在大量应用间重复出现的字段。线程安全。
+class StringPool {
+public:
+    // 返回与value内容相同的驻留字符串
+    QString intern(const QString& value) {
+        if (value.isEmpty()) {
+            return QString();
+        }
+        
+        QMutexLocker locker(&m_mutex);
+        auto it = m_strings.constFind(value);
+        if (it != m_strings.constEnd()) {
+            return *it;
+        }
+        m_strings.insert(value);
+        return value;
+    }
+    
+    void clear() {
+        QMutexLocker locker(&m_mutex);
+        m_strings.clear();
+    }
+    
+    int size() const {
+        QMutexLocker locker(&m_mutex);
+        return m_strings.size();
+    }
+
+private:
+    mutable QMutex m_mutex;
+    QSet<QString> m_strings;
+};
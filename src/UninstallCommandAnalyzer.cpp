@@ -0,0 +1,241 @@
+#include "UninstallCommandAnalyzer.h"
+#include <QFile>
+#include <QRegularExpression>
+
+namespace {
+
+// 卸载键中的值名不区分大小写
+QString stringValue(const QVariantHash& values, const QString& name) {
+    auto it = values.constFind(name);
+    if (it != values.constEnd()) {
+        return it.value().toString().trimmed();
+    }
+    for (it = values.constBegin(); it != values.constEnd(); ++it) {
+        if (it.key().compare(name, Qt::CaseInsensitive) == 0) {
+            return it.value().toString().trimmed();
+        }
+    }
+    return QString();
+}
+
+// 路径中的文件名部分，同时接受两种分隔符
+QString fileNameOf(const QString& path) {
+    const int separator = qMax(path.lastIndexOf(QLatin1Char('\\')), path.lastIndexOf(QLatin1Char('/')));
+    return path.mid(separator + 1);
+}
+
+QString directoryOf(const QString& path) {
+    const int separator = qMax(path.lastIndexOf(QLatin1Char('\\')), path.lastIndexOf(QLatin1Char('/')));
+    return separator > 0 ? path.left(separator) : QString();
+}
+
+// 参数中是否有某个开关（/S、-S形式，按空白分隔）
+bool hasSwitch(const QString& arguments, const QString& name, Qt::CaseSensitivity sensitivity) {
+    const QStringList parts = arguments.split(QRegularExpression("\\s+"), Qt::SkipEmptyParts);
+    for (const QString& part : parts) {
+        if ((part.startsWith(QLatin1Char('/')) || part.startsWith(QLatin1Char('-')))
+            && part.mid(1).compare(name, sensitivity) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+QString quoted(const QString& path) {
+    return QLatin1Char('"') + path + QLatin1Char('"');
+}
+
+// NSIS生成的程序在512字节对齐的位置有固定的头部：4字节标志、0xDEADBEEF、"NullsoftInst"。
+// 头部紧跟在几十KB的存根之后，只检查文件开头的一段
+bool hasNsisSignature(const QString& executable) {
+    static const QByteArray signature("\xEF\xBE\xAD\xDENullsoftInst", 16);
+    const qint64 kSearchLimit = 1024 * 1024;
+    const qint64 kAlignment = 512;
+    
+    QFile file(executable);
+    if (executable.isEmpty() || !file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    const QByteArray head = file.read(kSearchLimit);
+    for (qint64 offset = 0; offset + 4 + signature.size() <= head.size(); offset += kAlignment) {
+        if (head.mid(offset + 4, signature.size()) == signature) {
+            return true;
+        }
+    }
+    return false;
+}
+
+const QRegularExpression& productCodePattern() {
+    static const QRegularExpression pattern(
+        "\\{[0-9A-Fa-f]{8}-[0-9A-Fa-f]{4}-[0-9A-Fa-f]{4}-[0-9A-Fa-f]{4}-[0-9A-Fa-f]{12}\\}");
+    return pattern;
+}
+
+} // namespace
+
+UninstallCommandAnalyzer::Analysis UninstallCommandAnalyzer::analyze(const QString& uninstallString,
+                                                                     const QVariantHash& values,
+                                                                     const QString& subKey) {
+    Analysis analysis;
+    splitCommand(uninstallString, analysis.executable, analysis.arguments);
+    
+    const QString fileName = fileNameOf(analysis.executable).toLower();
+    
+    // 1. 识别安装程序类型
+    static const QRegularExpression innoUninstaller("^unins\\d{3}(\\.exe)?$");
+    static const QRegularExpression nsisUninstaller("^uninst.*\\.exe$");
+    
+    bool innoValues = false;
+    bool nsisValues = false;
+    for (auto it = values.constBegin(); it != values.constEnd(); ++it) {
+        innoValues = innoValues || it.key().startsWith(QLatin1String("Inno Setup:"), Qt::CaseInsensitive);
+        nsisValues = nsisValues || it.key().startsWith(QLatin1String("NSIS:"), Qt::CaseInsensitive);
+    }
+    
+    if (fileName == QLatin1String("msiexec.exe") || fileName == QLatin1String("msiexec")
+        || stringValue(values, "WindowsInstaller") == QLatin1String("1")) {
+        analysis.family = Msi;
+        QRegularExpressionMatch match = productCodePattern().match(analysis.arguments);
+        if (match.hasMatch()) {
+            analysis.productCode = match.captured().toUpper();
+        } else if (productCodePattern().match(subKey).capturedLength() == subKey.length() && !subKey.isEmpty()) {
+            analysis.productCode = subKey.toUpper();
+        }
+    } else if (innoValues || innoUninstaller.match(fileName).hasMatch()) {
+        analysis.family = InnoSetup;
+    } else if (nsisUninstaller.match(fileName).hasMatch()) {
+        // uninst*.exe也是许多自制卸载程序的名字，其/S未必表示静默，文件名之外还要有NSIS特有的依据：
+        // 参数中的_?=或区分大小写的/S、electron-builder的/currentuser和/allusers、
+        // NSIS:开头的值，或可执行文件中的NSIS头部
+        const bool nsisArguments = analysis.arguments.contains(QLatin1String("_?="))
+            || hasSwitch(analysis.arguments, "S", Qt::CaseSensitive)
+            || hasSwitch(analysis.arguments, "currentuser", Qt::CaseInsensitive)
+            || hasSwitch(analysis.arguments, "allusers", Qt::CaseInsensitive);
+        if (nsisArguments || nsisValues || hasNsisSignature(analysis.executable)) {
+            analysis.family = Nsis;
+        }
+    }
+    
+    // 2. 厂商提供的静默命令优先
+    const QString vendorQuiet = stringValue(values, "QuietUninstallString");
+    if (!vendorQuiet.isEmpty()) {
+        analysis.quietCommand = vendorQuiet;
+        analysis.vendorQuiet = true;
+        return analysis;
+    }
+    
+    // 3. 按类型生成静默命令
+    switch (analysis.family) {
+        case Msi:
+            // /I是修改安装，统一改写为/x卸载
+            if (!analysis.productCode.isEmpty()) {
+                analysis.quietCommand = QString("msiexec.exe /x %1 /qn /norestart").arg(analysis.productCode);
+            }
+            break;
+        
+        case InnoSetup: {
+            QString arguments = analysis.arguments;
+            if (!hasSwitch(arguments, "VERYSILENT", Qt::CaseInsensitive)) {
+                arguments += QLatin1String(" /VERYSILENT");
+            }
+            if (!hasSwitch(arguments, "SUPPRESSMSGBOXES", Qt::CaseInsensitive)) {
+                arguments += QLatin1String(" /SUPPRESSMSGBOXES");
+            }
+            if (!hasSwitch(arguments, "NORESTART", Qt::CaseInsensitive)) {
+                arguments += QLatin1String(" /NORESTART");
+            }
+            analysis.quietCommand = quoted(analysis.executable) + QLatin1Char(' ') + arguments.trimmed();
+            break;
+        }
+        
+        case Nsis: {
+            // NSIS的/S区分大小写；卸载程序默认复制到临时目录后立即退出，
+            // 加上_?=安装目录使其原地运行，进程结束时卸载才真正完成。_?=必须是最后一个参数
+            QString arguments = analysis.arguments;
+            if (!hasSwitch(arguments, "S", Qt::CaseSensitive)) {
+                arguments = (QLatin1String("/S ") + arguments).trimmed();
+            }
+            const QString directory = directoryOf(analysis.executable);
+            if (!arguments.contains(QLatin1String("_?=")) && !directory.isEmpty()) {
+                arguments += QLatin1String(" _?=") + directory;
+            }
+            analysis.quietCommand = quoted(analysis.executable) + QLatin1Char(' ') + arguments.trimmed();
+            break;
+        }
+        
+        case Unknown:
+            break;
+    }
+    
+    return analysis;
+}
+
+void UninstallCommandAnalyzer::splitCommand(const QString& command, QString& executable, QString& arguments) {
+    const QString trimmed = command.trimmed();
+    executable.clear();
+    arguments.clear();
+    if (trimmed.isEmpty()) {
+        return;
+    }
+    
+    if (trimmed.startsWith(QLatin1Char('"'))) {
+        const int end = trimmed.indexOf(QLatin1Char('"'), 1);
+        if (end < 0) {
+            executable = trimmed.mid(1);
+        } else {
+            executable = trimmed.mid(1, end - 1);
+            arguments = trimmed.mid(end + 1).trimmed();
+        }
+        return;
+    }
+    
+    // 未加引号的路径可能含空格（C:\Program Files\App\uninst.exe /x），以第一个独立的.exe结尾为界
+    int from = 0;
+    for (;;) {
+        const int index = trimmed.indexOf(QLatin1String(".exe"), from, Qt::CaseInsensitive);
+        if (index < 0) {
+            break;
+        }
+        const int end = index + 4;
+        if (end == trimmed.length() || trimmed.at(end).isSpace() || trimmed.at(end) == QLatin1Char('"')) {
+            executable = trimmed.left(end);
+            arguments = trimmed.mid(end).trimmed();
+            return;
+        }
+        from = end;
+    }
+    
+    const int space = trimmed.indexOf(QRegularExpression("\\s"));
+    if (space < 0) {
+        executable = trimmed;
+    } else {
+        executable = trimmed.left(space);
+        arguments = trimmed.mid(space + 1).trimmed();
+    }
+}
+
+bool UninstallCommandAnalyzer::isSuccessExitCode(Family family, int exitCode) {
+    if (exitCode == 0) {
+        return true;
+    }
+    if (family == Msi) {
+        // ERROR_SUCCESS_REBOOT_INITIATED、ERROR_SUCCESS_REBOOT_REQUIRED、
+        // ERROR_UNKNOWN_PRODUCT（已被卸载）
+        return exitCode == 1641 || exitCode == 3010 || exitCode == 1605;
+    }
+    return false;
+}
+
+QString UninstallCommandAnalyzer::familyName(Family family) {
+    switch (family) {
+        case Msi:
+            return "MSI";
+        case Nsis:
+            return "NSIS";
+        case InnoSetup:
+            return "Inno Setup";
+        case Unknown:
+            break;
+    }
+    return "未知";
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <QString>
+#include <QStringList>
+#include <QVariantHash>
+
+// 卸载命令分析：根据UninstallString和卸载键中的值识别安装程序类型，
+// 生成不弹出向导的静默卸载命令。优先使用厂商提供的QuietUninstallString；
+// 否则MSI改写为msiexec /x {GUID} /qn，NSIS追加/S，Inno Setup追加/VERYSILENT /SUPPRESSMSGBOXES。
+// NSIS除惯用的卸载程序文件名外还需要参数、注册表值或文件头部中的NSIS特征。
+// 无法识别的命令不做改动，由原生卸载程序自行交互。
+class UninstallCommandAnalyzer {
+public:
+    enum Family {
+        Unknown,
+        Msi,
+        Nsis,
+        InnoSetup
+    };
+    
+    struct Analysis {
+        Family family = Unknown;
+        QString executable;      // 去掉引号的可执行文件路径
+        QString arguments;       // 可执行文件之后的原始参数
+        QString productCode;     // MSI产品代码，含花括号
+        QString quietCommand;    // 静默卸载命令，无法生成时为空
+        bool vendorQuiet = false;  // quietCommand来自QuietUninstallString
+        
+        bool canRunQuietly() const { return !quietCommand.isEmpty(); }
+    };
+    
+    // values为卸载键中的值，subKey为卸载键名（MSI产品的键名通常就是产品代码）
+    static Analysis analyze(const QString& uninstallString, const QVariantHash& values = QVariantHash(),
+                            const QString& subKey = QString());
+    
+    // 拆分可执行文件和参数，兼容未加引号且含空格的路径
+    static void splitCommand(const QString& command, QString& executable, QString& arguments);
+    
+    // 各类型卸载程序表示成功的退出码（MSI的3010/1641表示需要重启，1605表示产品已不存在）
+    static bool isSuccessExitCode(Family family, int exitCode);
+    
+    static QString familyName(Family family);
+};
@@ -1,11 +1,18 @@
 #include "UninstallEngine.h"
 #include "SafetyChecker.h"
+#include "DeletionEngine.h"
+#include "UninstallScheduler.h"
+#include "UninstallCommandAnalyzer.h"
+#include "PatternAutomaton.h"
 #include "Logger.h"
-#include <QSettings>
 #include <QStandardPaths>
 #include <QMessageBox>
 #include <QApplication>
 #include <QRegularExpression>
+#include <QThreadPool>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
 
 #ifdef Q_OS_WIN
 #include <windows.h>
@@ -14,15 +21,47 @@
 #include <shlobj.h>
 #endif
 
+namespace {
+
+// 两次进度信号之间的最小间隔，避免大量小文件时信号淹没界面线程
+const qint64 kProgressIntervalMs = 100;
+
+// 进度信号限频，可在多个线程中并发调用
+class ProgressThrottle {
+public:
+    ProgressThrottle() : m_lastEmit(-kProgressIntervalMs) {
+        m_timer.start();
+    }
+    
+    bool shouldEmit() {
+        const qint64 now = m_timer.elapsed();
+        qint64 last = m_lastEmit.load();
+        return now - last >= kProgressIntervalMs && m_lastEmit.compare_exchange_strong(last, now);
+    }
+
+private:
+    QElapsedTimer m_timer;
+    std::atomic<qint64> m_lastEmit;
+};
+
+} // namespace
+
 UninstallEngine::UninstallEngine(QObject* parent)
     : QObject(parent)
     , m_uninstallThread(nullptr)
+    , m_registry(RegistryBackend::defaultBackend())
     , m_isUninstalling(false)
     , m_shouldStop(false)
     , m_createBackup(false)
     , m_forceDelete(false)
-    , m_currentIndex(0)
+    , m_maxParallel(qMax(2, QThread::idealThreadCount()))
+    , m_supervisor(new ProcessSupervisor())
+    , m_backupStore(new BackupStore())
+    , m_uninstallerTimeout(300000)
+    , m_uninstallerIdleTimeout(0)
+    , m_silentUninstall(true)
 {
+    m_backupStore->setStopFlag(&m_shouldStop);
 }
 
 UninstallEngine::~UninstallEngine() {
@@ -36,6 +75,19 @@ void UninstallEngine::uninstallApplication(const ApplicationInfo& appInfo) {
 }
 
 void UninstallEngine::uninstallApplications(const QList<ApplicationInfo>& appList) {
+    startUninstall(appList, QList<UninstallPlan>());
+}
+
+void UninstallEngine::uninstallWithPlans(const QList<UninstallPlan>& plans) {
+    QList<ApplicationInfo> appList;
+    appList.reserve(plans.size());
+    for (const UninstallPlan& plan : plans) {
+        appList.append(plan.application);
+    }
+    startUninstall(appList, plans);
+}
+
+void UninstallEngine::startUninstall(const QList<ApplicationInfo>& appList, const QList<UninstallPlan>& plans) {
     if (m_isUninstalling) {
         return;
     }
@@ -43,15 +95,15 @@ void UninstallEngine::uninstallApplications(const QList<ApplicationInfo>& appLis
     m_isUninstalling = true;
     m_shouldStop = false;
     m_uninstallQueue = appList;
-    m_currentIndex = 0;
     
     // 创建工作线程
     m_uninstallThread = new QThread(this);
-    UninstallWorker* worker = new UninstallWorker(this, appList);
+    UninstallWorker* worker = new UninstallWorker(this, appList, plans);
     worker->moveToThread(m_uninstallThread);
     
     // 连接信号
     connect(m_uninstallThread, &QThread::started, worker, &UninstallWorker::doWork);
+    connect(m_uninstallThread, &QThread::finished, worker, &QObject::deleteLater);
     connect(worker, &UninstallWorker::finished, this, &UninstallEngine::onUninstallFinished);
     connect(worker, &UninstallWorker::uninstallStarted, this, &UninstallEngine::uninstallStarted);
     connect(worker, &UninstallWorker::uninstallFinished, this, &UninstallEngine::uninstallFinished);
@@ -63,6 +115,27 @@ void UninstallEngine::uninstallApplications(const QList<ApplicationInfo>& appLis
     m_uninstallThread->start();
 }
 
+void UninstallEngine::previewUninstall(const QList<ApplicationInfo>& appList) {
+    if (m_isUninstalling) {
+        return;
+    }
+    
+    m_isUninstalling = true;
+    m_shouldStop = false;
+    
+    m_uninstallThread = new QThread(this);
+    UninstallPlanner* planner = new UninstallPlanner(this, appList);
+    planner->moveToThread(m_uninstallThread);
+    
+    connect(m_uninstallThread, &QThread::started, planner, &UninstallPlanner::doWork);
+    connect(m_uninstallThread, &QThread::finished, planner, &QObject::deleteLater);
+    connect(planner, &UninstallPlanner::finished, this, &UninstallEngine::onPreviewFinished);
+    
+    LOG_INFO(QString("开始预演 %1 个应用程序的卸载").arg(appList.size()));
+    
+    m_uninstallThread->start();
+}
+
 void UninstallEngine::stopUninstall() {
     if (!m_isUninstalling) {
         return;
@@ -70,6 +143,9 @@ void UninstallEngine::stopUninstall() {
     
     m_shouldStop = true;
     
+    // 立即结束正在运行的原生卸载程序，等待它们的工作线程随之返回
+    m_supervisor->cancelAll();
+    
     if (m_uninstallThread) {
         m_uninstallThread->quit();
         m_uninstallThread->wait(10000); // 等待最多10秒
@@ -94,6 +170,20 @@ void UninstallEngine::onUninstallFinished() {
     emit allUninstallsFinished();
 }
 
+void UninstallEngine::onPreviewFinished(const QList<UninstallPlan>& plans) {
+    m_isUninstalling = false;
+    
+    if (m_uninstallThread) {
+        m_uninstallThread->quit();
+        m_uninstallThread->wait();
+        m_uninstallThread->deleteLater();
+        m_uninstallThread = nullptr;
+    }
+    
+    LOG_INFO(QString("卸载预演完成，共 %1 个应用").arg(plans.size()));
+    emit previewFinished(plans);
+}
+
 bool UninstallEngine::isUninstalling() const {
     return m_isUninstalling;
 }
@@ -106,83 +196,73 @@ void UninstallEngine::setForceDelete(bool enabled) {
     m_forceDelete = enabled;
 }
 
+void UninstallEngine::setRegistryBackend(std::shared_ptr<RegistryBackend> backend) {
+    if (backend) {
+        m_registry = std::move(backend);
+    }
+}
+
+void UninstallEngine::setMaxParallelUninstalls(int count) {
+    m_maxParallel = qMax(1, count);
+}
+
+void UninstallEngine::setMaxConcurrentUninstallers(int count) {
+    m_supervisor->setMaxConcurrent(count);
+}
+
+void UninstallEngine::setUninstallerTimeouts(int timeoutMs, int idleTimeoutMs) {
+    m_uninstallerTimeout = qMax(0, timeoutMs);
+    m_uninstallerIdleTimeout = qMax(0, idleTimeoutMs);
+}
+
+void UninstallEngine::setUninstallerShell(const QString& program, const QStringList& arguments) {
+    m_supervisor->setShell(program, arguments);
+}
+
+void UninstallEngine::setSilentUninstall(bool enabled) {
+    m_silentUninstall = enabled;
+}
+
+void UninstallEngine::setInstalledApplications(const QList<ApplicationInfo>& applications) {
+    m_installedApplications = applications;
+}
+
 bool UninstallEngine::runNativeUninstaller(const ApplicationInfo& appInfo) {
     QString uninstallCmd = appInfo.uninstallString;
     if (uninstallCmd.isEmpty()) {
         return false;
     }
     
-    LOG_INFO(QString("运行原生卸载程序: %1").arg(uninstallCmd));
-    
-    // 解析卸载命令
-    QProcess process;
-    process.setProgram("cmd.exe");
-    QStringList arguments;
-    arguments << "/c" << uninstallCmd;
-    process.setArguments(arguments);
-    
-    // 启动卸载进程
-    process.start();
-    if (!process.waitForStarted(5000)) {
-        LOG_ERROR(QString("无法启动卸载程序: %1").arg(process.errorString()));
-        return false;
-    }
+    // Windows Installer同时只能执行一个事务，MSI卸载互相等待而不是并行失败
+    QMutexLocker installerLock(UninstallScheduler::requiresInstallerLock(appInfo) ? &m_installerMutex : nullptr);
     
-    // 等待卸载完成（最多等待5分钟）
-    if (!process.waitForFinished(300000)) {
-        LOG_ERROR("卸载程序超时");
-        process.kill();
+    if (m_shouldStop) {
         return false;
     }
     
-    int exitCode = process.exitCode();
-    LOG_INFO(QString("卸载程序退出码: %1").arg(exitCode));
-    
-    return exitCode == 0;
-}
-
-bool UninstallEngine::deleteDirectory(const QString& dirPath) {
-    SafetyChecker& safety = SafetyChecker::instance();
-    
-    if (!safety.isSafeToDelete(dirPath)) {
-        LOG_WARNING(QString("安全检查失败，跳过删除目录: %1").arg(dirPath));
-        return false;
+    // 识别安装程序类型，能静默卸载时不弹出向导，批量卸载无需人工点击
+    const UninstallCommandAnalyzer::Analysis analysis = UninstallCommandAnalyzer::analyze(
+        uninstallCmd, m_registry->values(appInfo.registryKey()), appInfo.subKey);
+    if (m_silentUninstall && analysis.canRunQuietly()) {
+        uninstallCmd = analysis.quietCommand;
+        LOG_INFO(QString("静默卸载 (%1%2)").arg(UninstallCommandAnalyzer::familyName(analysis.family),
+                                               analysis.vendorQuiet ? ", QuietUninstallString" : ""));
     }
     
-    QDir dir(dirPath);
-    if (!dir.exists()) {
-        return true; // 目录不存在，认为删除成功
-    }
-    
-    LOG_INFO(QString("删除目录: %1").arg(dirPath));
-    
-    // 递归删除目录
-    bool success = dir.removeRecursively();
-    if (!success) {
-        LOG_ERROR(QString("删除目录失败: %1").arg(dirPath));
-    }
-    
-    return success;
-}
-
-bool UninstallEngine::deleteRegistryKeys(const ApplicationInfo& appInfo) {
-    SafetyChecker& safety = SafetyChecker::instance();
-    
-    if (!safety.isSafeRegistryKey(appInfo.registryKey)) {
-        LOG_WARNING(QString("注册表键不安全，跳过删除: %1").arg(appInfo.registryKey));
-        return false;
-    }
-    
-    LOG_INFO(QString("删除注册表键: %1").arg(appInfo.registryKey));
+    LOG_INFO(QString("运行原生卸载程序: %1").arg(uninstallCmd));
     
-    QSettings registry(appInfo.registryKey, QSettings::NativeFormat);
-    registry.clear();
-    registry.sync();
+    // 由监管线程启动和等待，输出实时写入日志，超时或停止时结束进程
+    ProcessSupervisor::Options options;
+    options.label = appInfo.name;
+    options.timeoutMs = m_uninstallerTimeout;
+    options.idleTimeoutMs = m_uninstallerIdleTimeout;
     
-    return true;
+    const ProcessSupervisor::Result result = m_supervisor->run(uninstallCmd, options);
+    return result.status == ProcessSupervisor::Result::Finished
+        && UninstallCommandAnalyzer::isSuccessExitCode(analysis.family, result.exitCode);
 }
 
-bool UninstallEngine::cleanUserData(const ApplicationInfo& appInfo) {
+QStringList UninstallEngine::userDataPaths(const ApplicationInfo& appInfo) {
     QStringList userDataPaths;
     
     // 常见的用户数据路径
@@ -204,183 +284,324 @@ bool UninstallEngine::cleanUserData(const ApplicationInfo& appInfo) {
         userDataPaths << QString("%1/%2").arg(documents, name);
     }
     
-    bool success = true;
-    for (const QString& path : userDataPaths) {
-        QDir dir(path);
-        if (dir.exists()) {
-            LOG_INFO(QString("清理用户数据: %1").arg(path));
-            if (!deleteDirectory(path)) {
-                success = false;
-            }
-        }
-    }
-    
-    return success;
+    return userDataPaths;
 }
 
-bool UninstallEngine::cleanTemporaryFiles(const ApplicationInfo& appInfo) {
-    QString tempPath = QStandardPaths::writableLocation(QStandardPaths::TempLocation);
-    QDir tempDir(tempPath);
+UninstallPlan UninstallEngine::planDeepClean(const ApplicationInfo& appInfo, const CleanupDiscovery* discovery,
+                                             int deletionThreads) {
+    SafetyChecker& safety = SafetyChecker::instance();
+    
+    UninstallPlan plan;
+    plan.application = appInfo;
     
-    // 查找与应用相关的临时文件
-    QStringList nameFilters;
-    nameFilters << QString("*%1*").arg(appInfo.name.split(" ").first());
+    // 单独规划时按只含一个应用的批次发现
+    QVector<CleanupDiscovery> single;
+    if (!discovery) {
+        single = discoverBatch({appInfo});
+        discovery = &single.first();
+    }
     
-    QFileInfoList tempFiles = tempDir.entryInfoList(nameFilters, QDir::Files | QDir::Dirs);
+    // 规划只读取目录内容，同一引擎依次枚举各个位置
+    DeletionEngine engine(safety.policy(), deletionThreads);
+    engine.setStopFlag(&m_shouldStop);
     
-    bool success = true;
-    for (const QFileInfo& fileInfo : tempFiles) {
-        if (fileInfo.isDir()) {
-            if (!deleteDirectory(fileInfo.absoluteFilePath())) {
-                success = false;
-            }
-        } else {
-            QFile file(fileInfo.absoluteFilePath());
-            if (!file.remove()) {
-                LOG_WARNING(QString("删除临时文件失败: %1").arg(fileInfo.absoluteFilePath()));
-                success = false;
+    // required为false（推测出的残留）时未通过安全检查不影响结果
+    auto addDeletion = [&](QList<DeletionPlan>& target, const QString& path, bool required = true) {
+        if (!safety.isSafeToDelete(path)) {
+            LOG_WARNING(QString("安全检查失败，跳过删除: %1").arg(path));
+            if (required) {
+                plan.rejected.append(path);
             }
+            return;
+        }
+        
+        DeletionPlan deletion = engine.plan(path);
+        if (deletion.isEmpty()) {
+            return; // 不存在
         }
+        plan.totalFiles += deletion.fileCount;
+        plan.totalBytes += deletion.totalBytes;
+        target.append(std::move(deletion));
+    };
+    
+    // 1. 安装目录
+    if (!appInfo.installLocation.isEmpty()) {
+        addDeletion(plan.directories, appInfo.installLocation);
     }
     
-    return success;
-}
-
-bool UninstallEngine::cleanStartupEntries(const ApplicationInfo& appInfo) {
-    QStringList startupKeys = {
-        "HKEY_LOCAL_MACHINE\\SOFTWARE\\Microsoft\\Windows\\CurrentVersion\\Run",
-        "HKEY_CURRENT_USER\\SOFTWARE\\Microsoft\\Windows\\CurrentVersion\\Run"
-    };
+    // 2. 用户数据目录
+    for (const QString& path : userDataPaths(appInfo)) {
+        if (QDir(path).exists()) {
+            addDeletion(plan.directories, path);
+        }
+    }
     
-    bool found = false;
+    // 3. 与应用相关的临时文件
+    for (const QString& path : discovery->temporaryFiles) {
+        addDeletion(plan.temporaryFiles, path);
+    }
     
-    for (const QString& keyPath : startupKeys) {
-        QSettings registry(keyPath, QSettings::NativeFormat);
-        QStringList keys = registry.allKeys();
+    // 4. 卸载信息注册表键
+    if (safety.isSafeRegistryKey(appInfo.registryKey())) {
+        plan.registryKeys.append(appInfo.registryKey());
+    } else {
+        LOG_WARNING(QString("注册表键不安全，跳过删除: %1").arg(appInfo.registryKey()));
+        plan.rejected.append(appInfo.registryKey());
+    }
+    
+    // 5. 启动项
+    plan.startupValues = discovery->startupValues;
+    for (const QStringList& valueNames : plan.startupValues) {
+        plan.totalRegistryKeys += valueNames.size();
+    }
+    
+    // 6. 发现的残留：高置信度的随深度清理删除，其余只在计划中列出
+    plan.leftovers = discovery->leftovers;
+    for (const LeftoverCandidate& candidate : plan.leftovers) {
+        if (candidate.confidence() != LeftoverCandidate::High) {
+            continue;
+        }
         
-        for (const QString& key : keys) {
-            QString value = registry.value(key).toString();
-            if (value.contains(appInfo.name, Qt::CaseInsensitive) ||
-                (!appInfo.installLocation.isEmpty() && value.contains(appInfo.installLocation, Qt::CaseInsensitive))) {
-                
-                LOG_INFO(QString("删除启动项: %1").arg(key));
-                registry.remove(key);
-                found = true;
+        if (candidate.kind == LeftoverCandidate::RegistryKey) {
+            if (!plan.registryKeys.contains(candidate.location, Qt::CaseInsensitive) &&
+                safety.isSafeRegistryKey(candidate.location)) {
+                plan.registryKeys.append(candidate.location);
             }
+            continue;
+        }
+        
+        // 已包含在前面计划删除的目录中
+        const QString location = QDir::cleanPath(candidate.location);
+        bool covered = false;
+        for (const DeletionPlan& deletion : plan.directories) {
+            if (location.compare(deletion.root, Qt::CaseInsensitive) == 0 ||
+                location.startsWith(deletion.root + QLatin1Char('/'), Qt::CaseInsensitive)) {
+                covered = true;
+                break;
+            }
+        }
+        if (!covered) {
+            LOG_INFO(QString("残留: %1（%2，%3 分）").arg(location, candidate.reason).arg(candidate.score));
+            addDeletion(plan.directories, location, false);
         }
     }
     
-    return found;
+    plan.totalRegistryKeys += plan.registryKeys.size();
+    
+    return plan;
 }
 
-bool UninstallEngine::cleanServices(const ApplicationInfo& appInfo) {
-    // 服务清理需要更谨慎，这里只是一个基本实现
-    // 实际应用中可能需要更复杂的逻辑
-    LOG_INFO(QString("检查与 %1 相关的服务").arg(appInfo.name));
-    
-    // 这里可以添加服务检查和删除的逻辑
-    // 由于安全考虑，暂时不实现自动删除服务的功能
+bool UninstallEngine::executeDeletion(const DeletionPlan& deletion, const QString& appName, UninstallProgress& progress,
+                                      int deletionThreads) {
+    LOG_INFO(QString("删除: %1（%2 个文件，%3 字节）").arg(deletion.root).arg(deletion.fileCount).arg(deletion.totalBytes));
+    
+    DeletionEngine engine(SafetyChecker::instance().policy(), deletionThreads);
+    engine.setStopFlag(&m_shouldStop);
+    
+    // 回调在删除线程中并发调用，限频后才发送信号
+    ProgressThrottle throttle;
+    const UninstallProgress base = progress;
+    engine.setProgressCallback([this, &throttle, appName, base](qint64 filesRemoved, qint64 bytesFreed) {
+        if (!throttle.shouldEmit()) {
+            return;
+        }
+        UninstallProgress current = base;
+        current.filesProcessed += static_cast<int>(filesRemoved);
+        current.bytesFreed += bytesFreed;
+        emit uninstallProgress(appName, current);
+    }, 64);
+    
+    const DeletionEngine::Result result = engine.execute(deletion);
+    progress.filesProcessed += static_cast<int>(result.filesRemoved + result.linksRemoved);
+    progress.bytesFreed += result.bytesFreed;
+    emit uninstallProgress(appName, progress);
+    
+    if (!result.blocked.isEmpty()) {
+        LOG_WARNING(QString("%1 中有 %2 个条目未通过安全检查，已保留")
+                    .arg(deletion.root).arg(result.blocked.size()));
+    }
+    if (!result.failed.isEmpty()) {
+        LOG_ERROR(QString("删除失败: %1（%2 个条目无法删除，首个: %3）")
+                  .arg(deletion.root).arg(result.failed.size()).arg(result.failed.first()));
+    }
     
-    return true;
+    // 规划时已被拦截或无法读取的条目同样保留
+    return result.isComplete() && deletion.blocked.isEmpty() && deletion.failed.isEmpty();
 }
 
-bool UninstallEngine::performDeepClean(const ApplicationInfo& appInfo) {
-    bool success = true;
+bool UninstallEngine::executePlan(const UninstallPlan& plan, int deletionThreads) {
+    const QString& appName = plan.application.name;
+    bool success = plan.rejected.isEmpty();
     
     UninstallProgress progress;
-    progress.currentOperation = "深度清理中...";
-    emit uninstallProgress(appInfo.name, progress);
+    progress.totalFiles = static_cast<int>(plan.totalFiles);
+    progress.totalRegistryKeys = plan.totalRegistryKeys;
     
-    // 1. 删除安装目录
-    if (!appInfo.installLocation.isEmpty()) {
-        progress.currentOperation = "删除安装目录...";
-        emit uninstallProgress(appInfo.name, progress);
-        
-        if (!deleteDirectory(appInfo.installLocation)) {
+    // 阶段切换时总是发送进度
+    auto report = [&](const QString& operation) {
+        progress.currentOperation = operation;
+        emit uninstallProgress(appName, progress);
+    };
+    
+    // 1. 删除安装目录和用户数据
+    report("删除文件...");
+    for (const DeletionPlan& deletion : plan.directories) {
+        if (m_shouldStop) {
+            return false;
+        }
+        if (!executeDeletion(deletion, appName, progress, deletionThreads)) {
             success = false;
         }
     }
     
-    // 2. 删除注册表项
-    progress.currentOperation = "清理注册表...";
-    emit uninstallProgress(appInfo.name, progress);
-    
-    if (!deleteRegistryKeys(appInfo)) {
-        success = false;
+    // 2. 清理临时文件
+    report("清理临时文件...");
+    for (const DeletionPlan& deletion : plan.temporaryFiles) {
+        if (m_shouldStop) {
+            return false;
+        }
+        executeDeletion(deletion, appName, progress, deletionThreads);
     }
     
-    // 3. 清理用户数据
-    progress.currentOperation = "清理用户数据...";
-    emit uninstallProgress(appInfo.name, progress);
+    // 3. 删除注册表项
+    if (!plan.registryKeys.isEmpty()) {
+        report("清理注册表...");
+        LOG_INFO(QString("删除注册表键: %1").arg(plan.registryKeys.join(", ")));
+        
+        const int deleted = m_registry->deleteTrees(plan.registryKeys);
+        progress.registryKeysProcessed += deleted;
+        if (deleted < plan.registryKeys.size()) {
+            success = false;
+        }
+    }
     
-    if (!cleanUserData(appInfo)) {
-        success = false;
+    // 4. 清理启动项，每个键的匹配值一次删除
+    if (!plan.startupValues.isEmpty()) {
+        report("清理启动项...");
+        for (auto it = plan.startupValues.constBegin(); it != plan.startupValues.constEnd(); ++it) {
+            LOG_INFO(QString("删除启动项: %1").arg(it.value().join(", ")));
+            progress.registryKeysProcessed += m_registry->deleteValues(it.key(), it.value());
+        }
     }
     
-    // 4. 清理临时文件
-    progress.currentOperation = "清理临时文件...";
-    emit uninstallProgress(appInfo.name, progress);
+    // 5. 检查服务
+    report("检查服务...");
+    cleanServices(plan.application);
     
-    cleanTemporaryFiles(appInfo);
+    progress.isComplete = true;
+    report("清理完成");
     
-    // 5. 清理启动项
-    progress.currentOperation = "清理启动项...";
-    emit uninstallProgress(appInfo.name, progress);
+    return success;
+}
+
+bool UninstallEngine::cleanServices(const ApplicationInfo& appInfo) {
+    // 服务清理需要更谨慎，这里只是一个基本实现
+    // 实际应用中可能需要更复杂的逻辑
+    LOG_INFO(QString("检查与 %1 相关的服务").arg(appInfo.name));
     
-    cleanStartupEntries(appInfo);
+    // 这里可以添加服务检查和删除的逻辑
+    // 由于安全考虑，暂时不实现自动删除服务的功能
+    
+    return true;
+}
+
+bool UninstallEngine::performDeepClean(const ApplicationInfo& appInfo, const UninstallPlan* plan,
+                                       const CleanupDiscovery* discovery, int deletionThreads) {
+    if (plan) {
+        return executePlan(*plan, deletionThreads);
+    }
     
-    // 6. 检查服务
-    progress.currentOperation = "检查服务...";
+    UninstallProgress progress;
+    progress.currentOperation = "分析待清理的内容...";
     emit uninstallProgress(appInfo.name, progress);
     
-    cleanServices(appInfo);
+    // 先完整规划，总量确定之后再开始删除
+    const UninstallPlan newPlan = planDeepClean(appInfo, discovery, deletionThreads);
+    LOG_INFO(QString("清理计划: %1，%2 个文件，%3 字节，%4 个注册表项")
+             .arg(appInfo.name).arg(newPlan.totalFiles).arg(newPlan.totalBytes).arg(newPlan.totalRegistryKeys));
     
-    progress.isComplete = true;
-    progress.currentOperation = "清理完成";
-    emit uninstallProgress(appInfo.name, progress);
+    if (m_shouldStop) {
+        return false;
+    }
     
-    return success;
+    return executePlan(newPlan, deletionThreads);
 }
 
 // UninstallWorker实现
-UninstallWorker::UninstallWorker(UninstallEngine* engine, const QList<ApplicationInfo>& appList)
+UninstallWorker::UninstallWorker(UninstallEngine* engine, const QList<ApplicationInfo>& appList,
+                                 const QList<UninstallPlan>& plans)
     : m_engine(engine)
     , m_appList(appList)
+    , m_plans(plans)
+    , m_deletionThreads(QThread::idealThreadCount())
 {
 }
 
 void UninstallWorker::doWork() {
-    for (int i = 0; i < m_appList.size(); ++i) {
-        if (m_engine->m_shouldStop) {
-            break;
-        }
-        
-        const ApplicationInfo& appInfo = m_appList[i];
-        m_engine->m_currentIndex = i;
-        
-        emit uninstallStarted(appInfo.name);
-        LOG_INFO(QString("开始卸载应用: %1").arg(appInfo.name));
-        
-        UninstallResult result = UninstallResult::Success;
-        
-        try {
-            // 安全检查
-            SafetyChecker& safety = SafetyChecker::instance();
-            if (appInfo.isSystemApp || safety.isSystemApplication(appInfo.name, appInfo.publisher)) {
-                LOG_WARNING(QString("跳过系统应用: %1").arg(appInfo.name));
-                emit uninstallError(appInfo.name, "这是系统关键应用，无法卸载");
-                result = UninstallResult::Failed;
-            } else {
-                // 创建备份（如果启用）
-                if (m_engine->m_createBackup) {
-                    m_engine->createBackup(appInfo);
+    // 互不冲突的分组并行执行，组内按调度顺序依次卸载
+    const UninstallScheduler scheduler(m_appList);
+    const QList<QVector<int>>& groups = scheduler.groups();
+    
+    LOG_INFO(QString("卸载计划: %1 个应用分为 %2 个互不冲突的组").arg(m_appList.size()).arg(groups.size()));
+    
+    // 同时卸载的应用平分删除线程
+    const int parallel = qBound(1, m_engine->m_maxParallel, static_cast<int>(groups.size()));
+    m_deletionThreads = qMax(2, QThread::idealThreadCount() / parallel);
+    
+    // 没有预演计划时，先为整批应用一次性发现共享位置中的清理对象
+    if (m_plans.isEmpty()) {
+        m_discoveries = m_engine->discoverBatch(m_appList);
+    }
+    
+    QThreadPool pool;
+    pool.setMaxThreadCount(parallel);
+    for (const QVector<int>& group : groups) {
+        pool.start([this, group]() {
+            for (int index : group) {
+                if (m_engine->m_shouldStop) {
+                    break;
                 }
                 
+                const ApplicationInfo& appInfo = m_appList[index];
+                emit uninstallStarted(appInfo.name);
+                LOG_INFO(QString("开始卸载应用: %1").arg(appInfo.name));
+                
+                const UninstallPlan* plan = index < m_plans.size() ? &m_plans.at(index) : nullptr;
+                const CleanupDiscovery* discovery = index < m_discoveries.size() ? &m_discoveries.at(index) : nullptr;
+                const UninstallResult result = uninstallOne(appInfo, plan, discovery);
+                
+                emit uninstallFinished(appInfo.name, result);
+                LOG_INFO(QString("应用 %1 卸载完成，结果: %2").arg(appInfo.name).arg(static_cast<int>(result)));
+            }
+        });
+    }
+    pool.waitForDone();
+    
+    emit finished();
+}
+
+UninstallResult UninstallWorker::uninstallOne(const ApplicationInfo& appInfo, const UninstallPlan* plan,
+                                              const CleanupDiscovery* discovery) {
+    UninstallResult result = UninstallResult::Success;
+    
+    try {
+        // 安全检查
+        SafetyChecker& safety = SafetyChecker::instance();
+        if (appInfo.isSystemApp() || safety.isSystemApplication(appInfo.name, appInfo.publisher)) {
+            LOG_WARNING(QString("跳过系统应用: %1").arg(appInfo.name));
+            emit uninstallError(appInfo.name, "这是系统关键应用，无法卸载");
+            result = UninstallResult::Failed;
+        } else {
+            // 创建备份（如果启用），备份失败时不卸载
+            if (m_engine->m_createBackup && m_engine->createBackup(appInfo).isEmpty()) {
+                emit uninstallError(appInfo.name, "备份失败，已跳过卸载");
+                result = UninstallResult::Failed;
+            } else {
                 // 1. 尝试运行原生卸载程序
                 bool nativeSuccess = m_engine->runNativeUninstaller(appInfo);
                 
                 // 2. 执行深度清理
-                bool deepCleanSuccess = m_engine->performDeepClean(appInfo);
+                bool deepCleanSuccess = m_engine->performDeepClean(appInfo, plan, discovery, m_deletionThreads);
                 
                 if (nativeSuccess && deepCleanSuccess) {
                     result = UninstallResult::Success;
@@ -390,38 +611,253 @@ void UninstallWorker::doWork() {
                     result = UninstallResult::Failed;
                 }
             }
-            
-        } catch (const std::exception& e) {
-            LOG_ERROR(QString("卸载过程中发生错误: %1").arg(e.what()));
-            emit uninstallError(appInfo.name, QString("卸载失败: %1").arg(e.what()));
-            result = UninstallResult::Failed;
-        } catch (...) {
-            LOG_ERROR("卸载过程中发生未知错误");
-            emit uninstallError(appInfo.name, "卸载失败: 未知错误");
-            result = UninstallResult::Failed;
         }
         
-        emit uninstallFinished(appInfo.name, result);
-        LOG_INFO(QString("应用 %1 卸载完成，结果: %2").arg(appInfo.name).arg(static_cast<int>(result)));
+    } catch (const std::exception& e) {
+        LOG_ERROR(QString("卸载过程中发生错误: %1").arg(e.what()));
+        emit uninstallError(appInfo.name, QString("卸载失败: %1").arg(e.what()));
+        result = UninstallResult::Failed;
+    } catch (...) {
+        LOG_ERROR("卸载过程中发生未知错误");
+        emit uninstallError(appInfo.name, "卸载失败: 未知错误");
+        result = UninstallResult::Failed;
     }
     
-    emit finished();
+    return result;
 }
 
-QString UninstallEngine::createBackup(const ApplicationInfo& appInfo) {
-    // 备份功能的基本实现
-    QString backupPath = QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation) + "/BTU_Backups";
-    QDir().mkpath(backupPath);
+QVector<CleanupDiscovery> UninstallEngine::discoverBatch(const QList<ApplicationInfo>& appList) {
+    QVector<CleanupDiscovery> discoveries(appList.size());
     
-    QString timestamp = QDateTime::currentDateTime().toString("yyyyMMdd_hhmmss");
-    QString backupDir = QString("%1/%2_%3").arg(backupPath, appInfo.name, timestamp);
+    // 1. 临时文件：名称包含应用名首个词。所有应用的词编入一个自动机，临时目录只枚举一次
+    QStringList tempWords;
+    for (const ApplicationInfo& appInfo : appList) {
+        tempWords.append(appInfo.name.split(" ").first());
+    }
+    PatternAutomaton tempAutomaton;
+    tempAutomaton.build(tempWords);
+    
+    if (!tempAutomaton.isEmpty()) {
+        QDir tempDir(QStandardPaths::writableLocation(QStandardPaths::TempLocation));
+        const QFileInfoList tempFiles = tempDir.entryInfoList(QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot);
+        for (const QFileInfo& fileInfo : tempFiles) {
+            int lastApplication = -1;
+            tempAutomaton.forEachMatch(fileInfo.fileName(), [&](int application, qsizetype) {
+                // 同一名称中多次出现只记录一次
+                if (application != lastApplication &&
+                    !discoveries[application].temporaryFiles.contains(fileInfo.absoluteFilePath())) {
+                    discoveries[application].temporaryFiles.append(fileInfo.absoluteFilePath());
+                }
+                lastApplication = application;
+            });
+        }
+    }
     
-    LOG_INFO(QString("创建备份到: %1").arg(backupDir));
+    // 2. 启动项：每个Run键只读取一次，值中引用应用名或安装目录的归属该应用
+    QStringList startupPatterns;
+    QVector<int> startupOwners;
+    for (int i = 0; i < appList.size(); ++i) {
+        startupPatterns << appList[i].name << appList[i].installLocation;
+        startupOwners << i << i;
+    }
+    PatternAutomaton startupAutomaton;
+    startupAutomaton.build(startupPatterns);
     
-    // 这里可以实现具体的备份逻辑
-    // 例如压缩安装目录、导出注册表项等
+    const QStringList startupKeys = {
+        "HKEY_LOCAL_MACHINE\\SOFTWARE\\Microsoft\\Windows\\CurrentVersion\\Run",
+        "HKEY_CURRENT_USER\\SOFTWARE\\Microsoft\\Windows\\CurrentVersion\\Run"
+    };
+    for (const QString& keyPath : startupKeys) {
+        if (startupAutomaton.isEmpty()) {
+            break;
+        }
+        
+        const QVariantHash values = m_registry->values(keyPath);
+        for (auto it = values.constBegin(); it != values.constEnd(); ++it) {
+            QVector<int> owners;
+            startupAutomaton.forEachMatch(it.value().toString(), [&](int pattern, qsizetype) {
+                if (!owners.contains(startupOwners[pattern])) {
+                    owners.append(startupOwners[pattern]);
+                }
+            });
+            for (int application : owners) {
+                LOG_INFO(QString("发现启动项: %1（%2）").arg(it.key(), appList[application].name));
+                discoveries[application].startupValues[keyPath].append(it.key());
+            }
+        }
+    }
     
-    return backupDir;
+    // 3. 残留：一次并行扫描
+    LeftoverScanner scanner(m_registry);
+    scanner.setInstalledApplications(m_installedApplications);
+    scanner.setStopFlag(&m_shouldStop);
+    for (const LeftoverCandidate& candidate : scanner.scan(appList)) {
+        discoveries[candidate.application].leftovers.append(candidate);
+    }
+    
+    return discoveries;
+}
+
+QStringList UninstallEngine::findRelatedFiles(const ApplicationInfo& appInfo) {
+    LeftoverScanner scanner(m_registry);
+    scanner.setInstalledApplications(m_installedApplications);
+    scanner.setStopFlag(&m_shouldStop);
+    
+    QStringList files;
+    for (const LeftoverCandidate& candidate : scanner.scan({appInfo}, LeftoverScanner::Files)) {
+        if (candidate.confidence() == LeftoverCandidate::High) {
+            files.append(candidate.location);
+        }
+    }
+    return files;
+}
+
+QStringList UninstallEngine::findRelatedRegistryKeys(const ApplicationInfo& appInfo) {
+    LeftoverScanner scanner(m_registry);
+    scanner.setInstalledApplications(m_installedApplications);
+    scanner.setStopFlag(&m_shouldStop);
+    
+    QStringList keys;
+    for (const LeftoverCandidate& candidate : scanner.scan({appInfo}, LeftoverScanner::Registry)) {
+        if (candidate.confidence() == LeftoverCandidate::High) {
+            keys.append(candidate.location);
+        }
+    }
+    return keys;
+}
+
+// UninstallPlanner实现
+UninstallPlanner::UninstallPlanner(UninstallEngine* engine, const QList<ApplicationInfo>& appList)
+    : m_engine(engine)
+    , m_appList(appList)
+{
+}
+
+void UninstallPlanner::doWork() {
+    // 规划只读取，各应用之间没有冲突，全部并行
+    const int parallel = qBound(1, m_engine->m_maxParallel, static_cast<int>(m_appList.size()));
+    const int deletionThreads = qMax(2, QThread::idealThreadCount() / parallel);
+    
+    // 共享位置每批只枚举一次
+    const QVector<CleanupDiscovery> discoveries = m_engine->discoverBatch(m_appList);
+    
+    QVector<UninstallPlan> plans(m_appList.size());
+    UninstallPlan* results = plans.data();
+    
+    QThreadPool pool;
+    pool.setMaxThreadCount(parallel);
+    for (int i = 0; i < m_appList.size(); ++i) {
+        pool.start([this, results, &discoveries, i, deletionThreads]() {
+            const ApplicationInfo& appInfo = m_appList.at(i);
+            results[i].application = appInfo;
+            
+            // 系统应用在卸载时会被拒绝，不做规划
+            SafetyChecker& safety = SafetyChecker::instance();
+            if (m_engine->m_shouldStop || appInfo.isSystemApp() ||
+                safety.isSystemApplication(appInfo.name, appInfo.publisher)) {
+                return;
+            }
+            results[i] = m_engine->planDeepClean(appInfo, &discoveries.at(i), deletionThreads);
+        });
+    }
+    pool.waitForDone();
+    
+    emit finished(QList<UninstallPlan>(plans.begin(), plans.end()));
+}
+
+QJsonObject UninstallPlan::toJson() const {
+    QJsonArray directoryArray;
+    for (const DeletionPlan& deletion : directories) {
+        directoryArray.append(deletion.toJson());
+    }
+    QJsonArray temporaryArray;
+    for (const DeletionPlan& deletion : temporaryFiles) {
+        temporaryArray.append(deletion.toJson());
+    }
+    QJsonObject startupObject;
+    for (auto it = startupValues.constBegin(); it != startupValues.constEnd(); ++it) {
+        startupObject.insert(it.key(), QJsonArray::fromStringList(it.value()));
+    }
+    
+    QJsonObject object;
+    object.insert("name", application.name);
+    object.insert("version", application.version);
+    object.insert("publisher", application.publisher);
+    object.insert("installLocation", application.installLocation);
+    object.insert("totalFiles", totalFiles);
+    object.insert("totalBytes", totalBytes);
+    object.insert("totalRegistryKeys", totalRegistryKeys);
+    object.insert("directories", directoryArray);
+    object.insert("temporaryFiles", temporaryArray);
+    object.insert("registryKeys", QJsonArray::fromStringList(registryKeys));
+    object.insert("startupValues", startupObject);
+    if (!rejected.isEmpty()) {
+        object.insert("rejected", QJsonArray::fromStringList(rejected));
+    }
+    
+    static const char* const confidenceNames[] = {"low", "medium", "high"};
+    QJsonArray leftoverArray;
+    for (const LeftoverCandidate& candidate : leftovers) {
+        QJsonObject item;
+        item.insert("location", candidate.location);
+        item.insert("registry", candidate.kind == LeftoverCandidate::RegistryKey);
+        item.insert("score", candidate.score);
+        item.insert("confidence", confidenceNames[candidate.confidence()]);
+        item.insert("reason", candidate.reason);
+        leftoverArray.append(item);
+    }
+    object.insert("leftovers", leftoverArray);
+    return object;
+}
+
+bool UninstallEngine::exportPlans(const QList<UninstallPlan>& plans, const QString& filePath) {
+    QJsonArray applications;
+    qint64 totalFiles = 0;
+    qint64 totalBytes = 0;
+    qint64 totalRegistryKeys = 0;
+    for (const UninstallPlan& plan : plans) {
+        applications.append(plan.toJson());
+        totalFiles += plan.totalFiles;
+        totalBytes += plan.totalBytes;
+        totalRegistryKeys += plan.totalRegistryKeys;
+    }
+    
+    QJsonObject root;
+    root.insert("generated", QDateTime::currentDateTime().toString(Qt::ISODate));
+    root.insert("totalFiles", totalFiles);
+    root.insert("totalBytes", totalBytes);
+    root.insert("totalRegistryKeys", totalRegistryKeys);
+    root.insert("applications", applications);
+    
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        LOG_ERROR(QString("无法写入卸载计划: %1").arg(filePath));
+        return false;
+    }
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Indented));
+    LOG_INFO(QString("卸载计划已导出到: %1").arg(filePath));
+    return true;
+}
+
+QString UninstallEngine::createBackup(const ApplicationInfo& appInfo) {
+    // 安装目录和卸载键分块去重后写入备份存储，返回清单路径
+    QElapsedTimer timer;
+    timer.start();
+    
+    const BackupStore::Result result = m_backupStore->backup(appInfo, *m_registry);
+    if (!result.success) {
+        LOG_ERROR(QString("备份失败: %1 - %2").arg(appInfo.name, result.error));
+        return QString();
+    }
+    
+    LOG_INFO(QString("已备份 %1: %2 个文件，%3 字节，%4/%5 个新块，新增存储 %6 字节，耗时 %7 ms，清单: %8")
+             .arg(appInfo.name).arg(result.files).arg(result.totalBytes)
+             .arg(result.newChunks).arg(result.chunks).arg(result.storedBytes)
+             .arg(timer.elapsed()).arg(result.manifestPath));
+    if (result.skippedFiles > 0) {
+        LOG_WARNING(QString("%1 有 %2 个文件无法读取，未包含在备份中").arg(appInfo.name).arg(result.skippedFiles));
+    }
+    return result.manifestPath;
 }
 
 #include "UninstallEngine.moc"
@@ -1,6 +1,11 @@
 #pragma once
 
 #include "AppScanner.h"
+#include "BackupStore.h"
+#include "DeletionPlan.h"
+#include "LeftoverScanner.h"
+#include "ProcessSupervisor.h"
+#include "RegistryBackend.h"
 #include <QString>
 #include <QStringList>
 #include <QObject>
@@ -9,6 +14,10 @@
 #include <QDir>
 #include <QFileInfo>
 #include <QProcess>
+#include <QHash>
+#include <QJsonObject>
+#include <atomic>
+#include <memory>
 
 enum class UninstallResult {
     Success,
@@ -31,6 +40,31 @@ struct UninstallProgress {
                          bytesFreed(0), isComplete(false) {}
 };
 
+// 批量发现的一个应用的清理对象。临时目录和启动项等共享位置每批只枚举一次，
+// 对所有应用一起匹配后再按应用分配
+struct CleanupDiscovery {
+    QStringList temporaryFiles;                 // 名称包含应用名首个词的临时文件和目录
+    QHash<QString, QStringList> startupValues;  // 启动项所在的键 -> 引用应用名或安装目录的值名
+    QList<LeftoverCandidate> leftovers;
+};
+
+// 一个应用的深度清理计划。规划阶段只读取，枚举出全部待删除的文件、目录、
+// 注册表键和启动项并统计总量；执行阶段按计划处理，进度按精确的数量和字节数报告
+struct UninstallPlan {
+    ApplicationInfo application;
+    QList<DeletionPlan> directories;     // 安装目录和用户数据目录
+    QList<DeletionPlan> temporaryFiles;  // 与应用相关的临时文件，删除失败不影响结果
+    QStringList registryKeys;
+    QHash<QString, QStringList> startupValues;  // 启动项所在的键 -> 值名
+    QStringList rejected;                // 未通过安全检查而不处理的位置
+    QList<LeftoverCandidate> leftovers;  // 发现的残留，高置信度的已计入上面的删除和注册表项
+    qint64 totalFiles = 0;
+    qint64 totalBytes = 0;
+    int totalRegistryKeys = 0;           // 注册表键和启动项
+    
+    QJsonObject toJson() const;
+};
+
 class UninstallEngine : public QObject {
     Q_OBJECT
 
@@ -55,6 +89,48 @@ public:
     
     // 设置是否强制删除
     void setForceDelete(bool enabled);
+    
+    // 替换注册表访问实现（默认为RegistryBackend::defaultBackend()）
+    void setRegistryBackend(std::shared_ptr<RegistryBackend> backend);
+    
+    // 批量卸载时最多同时处理的应用数（互不冲突的应用才会并行）
+    void setMaxParallelUninstalls(int count);
+    
+    // 同时运行的原生卸载程序数
+    void setMaxConcurrentUninstallers(int count);
+    
+    // 原生卸载程序的总时长和连续无输出时长上限（毫秒），0表示不限
+    void setUninstallerTimeouts(int timeoutMs, int idleTimeoutMs);
+    
+    // 执行卸载命令的程序和参数（默认见ProcessSupervisor::defaultShell）
+    void setUninstallerShell(const QString& program, const QStringList& arguments);
+    
+    // 能识别安装程序类型时以静默方式运行原生卸载程序（默认开启）
+    void setSilentUninstall(bool enabled);
+    
+    // 当前已安装的全部应用：残留同时匹配其中未被卸载的应用时只列出而不删除
+    void setInstalledApplications(const QList<ApplicationInfo>& applications);
+    
+    // 深度清理时检查的用户数据目录（以应用名和发布商命名）
+    static QStringList userDataPaths(const ApplicationInfo& appInfo);
+    
+    // 规划深度清理，不做任何修改。discovery为批量发现的该应用的清理对象，为空指针时单独发现；
+    // deletionThreads为枚举目录使用的线程数
+    UninstallPlan planDeepClean(const ApplicationInfo& appInfo, const CleanupDiscovery* discovery = nullptr,
+                                int deletionThreads = QThread::idealThreadCount());
+    
+    // 执行深度清理计划，进度以uninstallProgress信号限频发送
+    bool executePlan(const UninstallPlan& plan, int deletionThreads = QThread::idealThreadCount());
+    
+    // 预演：并行规划所选应用的深度清理，不做任何修改，完成后发送previewFinished
+    void previewUninstall(const QList<ApplicationInfo>& appList);
+    
+    // 按预演得到的计划卸载，深度清理直接执行计划而不再枚举磁盘。
+    // 原生卸载程序已删除的条目视为已删除
+    void uninstallWithPlans(const QList<UninstallPlan>& plans);
+    
+    // 把计划连同文件数和大小统计导出为JSON文件
+    static bool exportPlans(const QList<UninstallPlan>& plans, const QString& filePath);
 
 signals:
     void uninstallStarted(const QString& appName);
@@ -62,51 +138,95 @@ signals:
     void uninstallProgress(const QString& appName, const UninstallProgress& progress);
     void uninstallError(const QString& appName, const QString& error);
     void allUninstallsFinished();
+    void previewFinished(const QList<UninstallPlan>& plans);
 
 private slots:
     void onUninstallFinished();
+    void onPreviewFinished(const QList<UninstallPlan>& plans);
 
 private:
+    friend class UninstallWorker;
+    friend class UninstallPlanner;
+    
+    void startUninstall(const QList<ApplicationInfo>& appList, const QList<UninstallPlan>& plans);
     void performUninstall(const ApplicationInfo& appInfo);
     bool runNativeUninstaller(const ApplicationInfo& appInfo);
-    bool performDeepClean(const ApplicationInfo& appInfo);
-    bool deleteDirectory(const QString& dirPath);
-    bool deleteRegistryKeys(const ApplicationInfo& appInfo);
-    bool cleanUserData(const ApplicationInfo& appInfo);
-    bool cleanTemporaryFiles(const ApplicationInfo& appInfo);
-    bool cleanStartupEntries(const ApplicationInfo& appInfo);
+    // plan非空时直接执行预演得到的计划，否则先规划
+    bool performDeepClean(const ApplicationInfo& appInfo, const UninstallPlan* plan,
+                          const CleanupDiscovery* discovery, int deletionThreads);
+    // 按计划以deletionThreads个线程删除一个位置，删除的文件数和释放的字节数累加到progress
+    bool executeDeletion(const DeletionPlan& deletion, const QString& appName, UninstallProgress& progress,
+                         int deletionThreads);
     bool cleanServices(const ApplicationInfo& appInfo);
     
-    QStringList findRelatedFiles(const QString& appName);
-    QStringList findRelatedRegistryKeys(const QString& appName);
+    // 为整批应用一次性枚举临时目录、启动项并扫描残留，结果与appList一一对应
+    QVector<CleanupDiscovery> discoverBatch(const QList<ApplicationInfo>& appList);
+    
+    // 单个应用的高置信度残留
+    QStringList findRelatedFiles(const ApplicationInfo& appInfo);
+    QStringList findRelatedRegistryKeys(const ApplicationInfo& appInfo);
     QString createBackup(const ApplicationInfo& appInfo);
     
     QThread* m_uninstallThread;
+    std::shared_ptr<RegistryBackend> m_registry;
     QMutex m_mutex;
+    QMutex m_installerMutex;  // 串行化依赖全局安装锁的原生卸载程序
     bool m_isUninstalling;
-    bool m_shouldStop;
+    std::atomic<bool> m_shouldStop;
     bool m_createBackup;
     bool m_forceDelete;
+    int m_maxParallel;
+    std::unique_ptr<ProcessSupervisor> m_supervisor;  // 运行原生卸载程序
+    std::unique_ptr<BackupStore> m_backupStore;
+    int m_uninstallerTimeout;
+    int m_uninstallerIdleTimeout;
+    bool m_silentUninstall;
+    QList<ApplicationInfo> m_installedApplications;
     QList<ApplicationInfo> m_uninstallQueue;
-    int m_currentIndex;
 };
 
 class UninstallWorker : public QObject {
     Q_OBJECT
 
 public:
-    explicit UninstallWorker(UninstallEngine* engine, const QList<ApplicationInfo>& appList);
-    
+    // plans为空时每个应用在卸载时规划，否则与appList一一对应
+    explicit UninstallWorker(UninstallEngine* engine, const QList<ApplicationInfo>& appList,
+                             const QList<UninstallPlan>& plans = QList<UninstallPlan>());
+
 public slots:
     void doWork();
-    
+
 signals:
     void finished();
     void uninstallStarted(const QString& appName);
     void uninstallFinished(const QString& appName, UninstallResult result);
     void uninstallProgress(const QString& appName, const UninstallProgress& progress);
     void uninstallError(const QString& appName, const QString& error);
+
+private:
+    UninstallResult uninstallOne(const ApplicationInfo& appInfo, const UninstallPlan* plan,
+                                 const CleanupDiscovery* discovery);
     
+    UninstallEngine* m_engine;
+    QList<ApplicationInfo> m_appList;
+    QList<UninstallPlan> m_plans;
+    QVector<CleanupDiscovery> m_discoveries;  // 没有预演计划时在开始前为整批应用发现的清理对象
+    int m_deletionThreads;  // 每个目录删除使用的线程数，按本批同时卸载的应用数分配
+};
+
+// 预演工作对象：并行规划多个应用的深度清理
+class UninstallPlanner : public QObject {
+    Q_OBJECT
+
+public:
+    explicit UninstallPlanner(UninstallEngine* engine, const QList<ApplicationInfo>& appList);
+
+public slots:
+    void doWork();
+
+signals:
+    void finished(const QList<UninstallPlan>& plans);
+
 private:
     UninstallEngine* m_engine;
     QList<ApplicationInfo> m_appList;
@@ -0,0 +1,117 @@
+#include "UninstallScheduler.h"
+#include "UninstallEngine.h"
+#include "UninstallCommandAnalyzer.h"
+#include "PathPrefixTrie.h"
+#include <QDir>
+#include <QHash>
+#include <QPair>
+#include <algorithm>
+
+namespace {
+
+// 折叠大小写和分隔符并以分隔符结尾，使"是否嵌套"成为普通的前缀判断
+QString normalizedRoot(const QString& path) {
+    QString folded = QDir::cleanPath(path);
+    for (QChar& ch : folded) {
+        ch = QChar(PathPrefixTrie::fold(ch.unicode()));
+    }
+    if (!folded.endsWith(QLatin1Char('\\'))) {
+        folded.append(QLatin1Char('\\'));
+    }
+    return folded;
+}
+
+int pathDepth(const QString& path) {
+    return path.isEmpty() ? 0 : path.count(QLatin1Char('/')) + path.count(QLatin1Char('\\')) + 1;
+}
+
+} // namespace
+
+UninstallScheduler::UninstallScheduler(const QList<ApplicationInfo>& applications) {
+    const int count = static_cast<int>(applications.size());
+    m_parent.resize(count);
+    for (int i = 0; i < count; ++i) {
+        m_parent[i] = i;
+    }
+    
+    // 1. 文件系统位置：排序后嵌套的路径紧随其前缀之后，用栈维护当前仍然打开的前缀
+    QVector<QPair<QString, int>> roots;
+    for (int i = 0; i < count; ++i) {
+        for (const QString& root : cleanupRoots(applications[i])) {
+            roots.append({normalizedRoot(root), i});
+        }
+    }
+    std::sort(roots.begin(), roots.end());
+    
+    QVector<QPair<QString, int>> open;
+    for (const auto& root : roots) {
+        while (!open.isEmpty() && !root.first.startsWith(open.last().first)) {
+            open.removeLast();
+        }
+        if (!open.isEmpty()) {
+            unite(open.last().second, root.second);
+        }
+        open.append(root);
+    }
+    
+    // 2. 临时文件：按名称首个单词做通配匹配，一方包含另一方时匹配到的文件可能重叠
+    QVector<QPair<QString, int>> tempKeys;
+    for (int i = 0; i < count; ++i) {
+        tempKeys.append({applications[i].name.split(QLatin1Char(' ')).first().toCaseFolded(), i});
+    }
+    for (int i = 0; i < tempKeys.size(); ++i) {
+        for (int j = i + 1; j < tempKeys.size(); ++j) {
+            if (tempKeys[i].first.contains(tempKeys[j].first) || tempKeys[j].first.contains(tempKeys[i].first)) {
+                unite(tempKeys[i].second, tempKeys[j].second);
+            }
+        }
+    }
+    
+    // 3. 收集分组，保持原顺序
+    QHash<int, int> groupOfRoot;
+    for (int i = 0; i < count; ++i) {
+        const int root = find(i);
+        auto it = groupOfRoot.constFind(root);
+        if (it == groupOfRoot.constEnd()) {
+            it = groupOfRoot.insert(root, static_cast<int>(m_groups.size()));
+            m_groups.append(QVector<int>());
+        }
+        m_groups[it.value()].append(i);
+    }
+    
+    // 4. 组内嵌套更深的安装目录先处理
+    for (QVector<int>& group : m_groups) {
+        std::stable_sort(group.begin(), group.end(), [&applications](int a, int b) {
+            return pathDepth(applications[a].installLocation) > pathDepth(applications[b].installLocation);
+        });
+    }
+}
+
+bool UninstallScheduler::requiresInstallerLock(const ApplicationInfo& appInfo) {
+    return UninstallCommandAnalyzer::analyze(appInfo.uninstallString).family == UninstallCommandAnalyzer::Msi;
+}
+
+QStringList UninstallScheduler::cleanupRoots(const ApplicationInfo& appInfo) {
+    QStringList roots = UninstallEngine::userDataPaths(appInfo);
+    if (!appInfo.installLocation.isEmpty()) {
+        roots.prepend(appInfo.installLocation);
+    }
+    return roots;
+}
+
+int UninstallScheduler::find(int index) {
+    while (m_parent[index] != index) {
+        m_parent[index] = m_parent[m_parent[index]]; // 路径减半
+        index = m_parent[index];
+    }
+    return index;
+}
+
+void UninstallScheduler::unite(int a, int b) {
+    const int rootA = find(a);
+    const int rootB = find(b);
+    if (rootA != rootB) {
+        // 以较小的下标为根，分组顺序与原列表一致
+        m_parent[qMax(rootA, rootB)] = qMin(rootA, rootB);
+    }
+}
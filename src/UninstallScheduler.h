@@ -0,0 +1,34 @@
+#pragma once
+
+#include "AppScanner.h"
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// 批量卸载调度：把待卸载的应用划分为互不冲突的组。
+// 安装目录相互嵌套、共享用户数据目录或临时文件模式的应用归入同一组并按顺序执行，
+// 不同组之间没有共享的文件系统位置，可以并行执行。
+// 分组用并查集完成，路径冲突通过对排序后的路径做一次线性扫描找出。
+class UninstallScheduler {
+public:
+    explicit UninstallScheduler(const QList<ApplicationInfo>& applications);
+    
+    // 冲突分组，每组为应用在原列表中的下标。
+    // 组内嵌套在其他应用目录中的应用排在前面，以免其卸载程序先被外层应用的清理删除；
+    // 其余保持原顺序。各组按其中最先选中的应用排列
+    const QList<QVector<int>>& groups() const { return m_groups; }
+    
+    // 原生卸载程序是否依赖全局安装锁（Windows Installer同一时间只能执行一个事务）
+    static bool requiresInstallerLock(const ApplicationInfo& appInfo);
+    
+    // 深度清理会删除的文件系统位置：安装目录，以及以应用名和发布商命名的用户数据目录
+    static QStringList cleanupRoots(const ApplicationInfo& appInfo);
+
+private:
+    int find(int index);
+    void unite(int a, int b);
+    
+    QVector<int> m_parent;
+    QList<QVector<int>> m_groups;
+};
@@ -0,0 +1,138 @@
+#include "WorkStealingPool.h"
+
+namespace {
+
+// 当前线程所属的线程池及其工作线程下标
+thread_local WorkStealingPool* t_currentPool = nullptr;
+thread_local int t_workerIndex = -1;
+
+} // namespace
+
+WorkStealingPool::WorkStealingPool(int threadCount)
+    : m_pending(0)
+    , m_queued(0)
+    , m_nextWorker(0)
+    , m_shutdown(false)
+{
+    const int count = qMax(1, threadCount);
+    for (int i = 0; i < count; ++i) {
+        m_workers.append(std::make_shared<Worker>());
+    }
+    for (int i = 0; i < count; ++i) {
+        QThread* thread = QThread::create([this, i]() { run(i); });
+        thread->start();
+        m_threads.append(thread);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        QMutexLocker locker(&m_stateMutex);
+        m_shutdown = true;
+        m_workAvailable.wakeAll();
+    }
+    
+    for (QThread* thread : m_threads) {
+        thread->wait();
+        delete thread;
+    }
+}
+
+int WorkStealingPool::threadCount() const {
+    return static_cast<int>(m_workers.size());
+}
+
+void WorkStealingPool::submit(Task task) {
+    const unsigned count = static_cast<unsigned>(m_workers.size());
+    int index = (t_currentPool == this) ? t_workerIndex
+                                        : static_cast<int>(static_cast<unsigned>(m_nextWorker.fetch_add(1)) % count);
+    
+    ++m_pending;
+    ++m_queued;
+    {
+        QMutexLocker locker(&m_workers[index]->mutex);
+        m_workers[index]->tasks.push_back(std::move(task));
+    }
+    
+    QMutexLocker locker(&m_stateMutex);
+    m_workAvailable.wakeOne();
+}
+
+bool WorkStealingPool::takeTask(int workerIndex, Task& task) {
+    // 先从自己的队尾取（深度优先，局部性好）
+    {
+        Worker& own = *m_workers[workerIndex];
+        QMutexLocker locker(&own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            --m_queued;
+            return true;
+        }
+    }
+    
+    // 再从其他线程的队首窃取（通常是较大的子树）
+    const int count = static_cast<int>(m_workers.size());
+    for (int offset = 1; offset < count; ++offset) {
+        Worker& victim = *m_workers[(workerIndex + offset) % count];
+        QMutexLocker locker(&victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            --m_queued;
+            return true;
+        }
+    }
+    
+    return false;
+}
+
+void WorkStealingPool::run(int workerIndex) {
+    t_currentPool = this;
+    t_workerIndex = workerIndex;
+    
+    for (;;) {
+        Task task;
+        if (takeTask(workerIndex, task)) {
+            task(workerIndex);
+            finishTasks(1);
+            continue;
+        }
+        
+        QMutexLocker locker(&m_stateMutex);
+        if (m_shutdown) {
+            break;
+        }
+        if (m_queued.load() == 0) {
+            m_workAvailable.wait(&m_stateMutex);
+        }
+    }
+}
+
+void WorkStealingPool::finishTasks(int count) {
+    if (m_pending.fetch_sub(count) == count) {
+        QMutexLocker locker(&m_stateMutex);
+        m_allDone.wakeAll();
+    }
+}
+
+void WorkStealingPool::waitForDone() {
+    QMutexLocker locker(&m_stateMutex);
+    while (m_pending.load() > 0) {
+        m_allDone.wait(&m_stateMutex);
+    }
+}
+
+void WorkStealingPool::clear() {
+    int dropped = 0;
+    for (const std::shared_ptr<Worker>& worker : m_workers) {
+        QMutexLocker locker(&worker->mutex);
+        dropped += static_cast<int>(worker->tasks.size());
+        worker->tasks.clear();
+    }
+    
+    if (dropped > 0) {
+        m_queued -= dropped;
+        finishTasks(dropped);
+    }
+}
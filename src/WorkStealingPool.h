@@ -0,0 +1,57 @@
+#pragma once
+
+#include <QMutex>
+#include <QWaitCondition>
+#include <QThread>
+#include <QVector>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <atomic>
+
+// 工作窃取线程池：每个工作线程维护自己的任务队列，从队尾取自己的任务，
+// 空闲时从其他线程的队首窃取。任务中提交的子任务进入当前线程的队列，
+// 适合目录树遍历这类不断派生子任务、负载不均的场景。
+class WorkStealingPool {
+public:
+    // 任务参数为执行该任务的工作线程下标
+    using Task = std::function<void(int workerIndex)>;
+    
+    explicit WorkStealingPool(int threadCount = QThread::idealThreadCount());
+    ~WorkStealingPool();
+    
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+    
+    // 提交任务；在工作线程内调用时放入该线程自己的队列
+    void submit(Task task);
+    
+    // 阻塞直到所有任务（包括执行中派生的任务）完成
+    void waitForDone();
+    
+    // 丢弃尚未开始的任务
+    void clear();
+    
+    int threadCount() const;
+
+private:
+    struct Worker {
+        QMutex mutex;
+        std::deque<Task> tasks;
+    };
+    
+    void run(int workerIndex);
+    bool takeTask(int workerIndex, Task& task);
+    void finishTasks(int count);
+    
+    QVector<std::shared_ptr<Worker>> m_workers;
+    QVector<QThread*> m_threads;
+    
+    QMutex m_stateMutex;
+    QWaitCondition m_workAvailable;
+    QWaitCondition m_allDone;
+    std::atomic<int> m_pending;     // 已提交但尚未完成的任务数
+    std::atomic<int> m_queued;      // 仍在队列中的任务数
+    std::atomic<int> m_nextWorker;  // 外部提交时轮流选择的队列
+    bool m_shutdown;
+};
@@ -284,27 +284,16 @@ int main(int argc, char *argv[])
     app.processEvents();
     
     // 启动画面显示消息
-    splash->showMessage("正在初始化...", Qt::AlignBottom | Qt::AlignCenter, Qt::white);
+    splash->showMessage("正在加载组件...", Qt::AlignBottom | Qt::AlignCenter, Qt::white);
     app.processEvents();
     
-    // 模拟初始化延迟
-    QTimer::singleShot(1000, [splash]() {
-        splash->showMessage("正在加载组件...", Qt::AlignBottom | Qt::AlignCenter, Qt::white);
-    });
-    
-    QTimer::singleShot(2000, [splash]() {
-        splash->showMessage("准备就绪", Qt::AlignBottom | Qt::AlignCenter, Qt::white);
-    });
-    
-    // 创建主窗口
+    // 创建主窗口（应用列表从快照加载，不依赖注册表扫描）
     BTUMainWindow mainWindow;
     
-    // 3秒后关闭启动画面并显示主窗口
-    QTimer::singleShot(3000, [&mainWindow, splash]() {
-        splash->finish(&mainWindow);
-        mainWindow.show();
-        splash->deleteLater();
-    });
+    // 主窗口就绪后立即关闭启动画面
+    mainWindow.show();
+    splash->finish(&mainWindow);
+    splash->deleteLater();
     
     LOG_INFO("主窗口创建完成，进入事件循环");
     
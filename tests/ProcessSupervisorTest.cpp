@@ -0,0 +1,247 @@
+// ProcessSupervisor测试：以测试程序自身作为卸载shell的桩（--stub），
+// 验证并发上限、总时长和无输出超时、取消，以及超时时整个进程树都被结束。
+//
+// 桩命令：sleep <毫秒> | quiet <毫秒> | exit <退出码> | track <目录> <毫秒> | spawn <文件> | heartbeat <文件>
+
+#include "ProcessSupervisor.h"
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QProcess>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QThread>
+#include <QtTest>
+#include <memory>
+#include <vector>
+
+namespace {
+
+// 桩shell：第一个参数为命令，按空格拆分
+int runStub(const QString& command) {
+    const QStringList parts = command.split(' ', Qt::SkipEmptyParts);
+    const QString verb = parts.value(0);
+    
+    if (verb == "sleep") {
+        QThread::msleep(parts.value(1).toULong());
+        return 0;
+    }
+    if (verb == "quiet") {
+        // 输出一行后不再输出
+        QTextStream(stdout) << "started" << Qt::endl;
+        QThread::msleep(parts.value(1).toULong());
+        return 0;
+    }
+    if (verb == "exit") {
+        return parts.value(1).toInt();
+    }
+    if (verb == "track") {
+        // 运行期间在目录中留下标记，记录开始时同时运行的桩数
+        const QDir directory(parts.value(1));
+        const QString marker = directory.filePath(QString::number(QCoreApplication::applicationPid()));
+        QFile(marker).open(QIODevice::WriteOnly);
+        const int running = static_cast<int>(directory.entryList(QDir::Files).size());
+        
+        QFile log(parts.value(1) + ".log");
+        if (log.open(QIODevice::WriteOnly | QIODevice::Append)) {
+            log.write(QByteArray::number(running) + '\n');
+            log.close();
+        }
+        
+        QThread::msleep(parts.value(2).toULong());
+        QFile::remove(marker);
+        return 0;
+    }
+    if (verb == "spawn") {
+        // 启动一个持续写文件的子进程后等待，模拟启动真正卸载程序的shell
+        QProcess child;
+        child.start(QCoreApplication::applicationFilePath(), {"--stub", "heartbeat " + parts.value(1)});
+        child.waitForStarted();
+        QThread::msleep(30000);
+        return 0;
+    }
+    if (verb == "heartbeat") {
+        QFile file(parts.value(1));
+        for (int i = 0; i < 600 && file.open(QIODevice::WriteOnly | QIODevice::Append); ++i) {
+            file.write("x\n");
+            file.close();
+            QThread::msleep(50);
+        }
+        return 0;
+    }
+    return 127;
+}
+
+} // namespace
+
+class ProcessSupervisorTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void init();
+    void exitCode();
+    void concurrencyLimit();
+    void timeout();
+    void idleTimeout();
+    void cancelAll();
+    void timeoutKillsProcessTree();
+
+private:
+    // 在单独的线程中调用run，测试线程保持空闲以便取消
+    QThread* runAsync(const QString& command, const ProcessSupervisor::Options& options,
+                      ProcessSupervisor::Result& result);
+    
+    std::unique_ptr<ProcessSupervisor> m_supervisor;
+    QTemporaryDir m_directory;
+};
+
+void ProcessSupervisorTest::init() {
+    QVERIFY(m_directory.isValid());
+    m_supervisor = std::make_unique<ProcessSupervisor>();
+    m_supervisor->setShell(QCoreApplication::applicationFilePath(), {"--stub"});
+}
+
+QThread* ProcessSupervisorTest::runAsync(const QString& command, const ProcessSupervisor::Options& options,
+                                         ProcessSupervisor::Result& result) {
+    ProcessSupervisor* supervisor = m_supervisor.get();
+    QThread* thread = QThread::create([supervisor, command, options, &result]() {
+        result = supervisor->run(command, options);
+    });
+    thread->start();
+    return thread;
+}
+
+void ProcessSupervisorTest::exitCode() {
+    ProcessSupervisor::Options options;
+    options.label = "exit";
+    
+    const ProcessSupervisor::Result result = m_supervisor->run("exit 3", options);
+    QCOMPARE(result.status, ProcessSupervisor::Result::Finished);
+    QCOMPARE(result.exitCode, 3);
+    QVERIFY(!result.succeeded());
+}
+
+void ProcessSupervisorTest::concurrencyLimit() {
+    const int jobs = 5;
+    const QString trackDirectory = m_directory.filePath("track");
+    QVERIFY(QDir().mkpath(trackDirectory));
+    m_supervisor->setMaxConcurrent(2);
+    
+    ProcessSupervisor::Options options;
+    options.label = "track";
+    std::vector<ProcessSupervisor::Result> results(jobs);
+    QList<QThread*> threads;
+    for (int i = 0; i < jobs; ++i) {
+        threads.append(runAsync(QString("track %1 300").arg(trackDirectory), options, results[i]));
+    }
+    for (QThread* thread : threads) {
+        QVERIFY(thread->wait(30000));
+        delete thread;
+    }
+    
+    for (const ProcessSupervisor::Result& result : results) {
+        QCOMPARE(result.status, ProcessSupervisor::Result::Finished);
+        QCOMPARE(result.exitCode, 0);
+    }
+    
+    QFile log(trackDirectory + ".log");
+    QVERIFY(log.open(QIODevice::ReadOnly));
+    const QList<QByteArray> counts = log.readAll().split('\n');
+    int started = 0;
+    for (const QByteArray& count : counts) {
+        if (count.isEmpty()) {
+            continue;
+        }
+        ++started;
+        QVERIFY2(count.toInt() <= 2, "同时运行的进程数超过上限");
+    }
+    QCOMPARE(started, jobs);
+}
+
+void ProcessSupervisorTest::timeout() {
+    ProcessSupervisor::Options options;
+    options.label = "timeout";
+    options.timeoutMs = 300;
+    
+    QElapsedTimer timer;
+    timer.start();
+    const ProcessSupervisor::Result result = m_supervisor->run("sleep 20000", options);
+    QCOMPARE(result.status, ProcessSupervisor::Result::TimedOut);
+    QVERIFY(timer.elapsed() < 10000);
+}
+
+void ProcessSupervisorTest::idleTimeout() {
+    ProcessSupervisor::Options options;
+    options.label = "idle";
+    options.timeoutMs = 0;
+    options.idleTimeoutMs = 300;
+    
+    QElapsedTimer timer;
+    timer.start();
+    const ProcessSupervisor::Result result = m_supervisor->run("quiet 20000", options);
+    QCOMPARE(result.status, ProcessSupervisor::Result::IdleTimedOut);
+    QVERIFY(timer.elapsed() < 10000);
+}
+
+void ProcessSupervisorTest::cancelAll() {
+    // 上限为1时第二个任务在排队，取消后两者都应立即返回
+    m_supervisor->setMaxConcurrent(1);
+    
+    ProcessSupervisor::Options options;
+    options.label = "cancel";
+    ProcessSupervisor::Result running;
+    ProcessSupervisor::Result queued;
+    QThread* first = runAsync("sleep 20000", options, running);
+    QThread::msleep(200);
+    QThread* second = runAsync("sleep 20000", options, queued);
+    QThread::msleep(300);
+    
+    QElapsedTimer timer;
+    timer.start();
+    m_supervisor->cancelAll();
+    QVERIFY(first->wait(10000));
+    QVERIFY(second->wait(10000));
+    QVERIFY(timer.elapsed() < 10000);
+    delete first;
+    delete second;
+    
+    QCOMPARE(running.status, ProcessSupervisor::Result::Cancelled);
+    QCOMPARE(queued.status, ProcessSupervisor::Result::Cancelled);
+}
+
+void ProcessSupervisorTest::timeoutKillsProcessTree() {
+    const QString heartbeat = m_directory.filePath("heartbeat");
+    
+    ProcessSupervisor::Options options;
+    options.label = "tree";
+    options.timeoutMs = 1500;
+    
+    const ProcessSupervisor::Result result = m_supervisor->run("spawn " + heartbeat, options);
+    QCOMPARE(result.status, ProcessSupervisor::Result::TimedOut);
+    QVERIFY2(QFileInfo(heartbeat).size() > 0, "桩没有启动子进程");
+    
+    // 子进程被一起结束后文件不再增长
+    QThread::msleep(200);
+    const qint64 size = QFileInfo(heartbeat).size();
+    QThread::msleep(500);
+    QCOMPARE(QFileInfo(heartbeat).size(), size);
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 2 && qstrcmp(argv[1], "--stub") == 0) {
+        QCoreApplication app(argc, argv);
+        return runStub(QString::fromLocal8Bit(argv[2]));
+    }
+    
+    QCoreApplication app(argc, argv);
+    // 日志写入测试目录，不影响正式安装的数据
+    QStandardPaths::setTestModeEnabled(true);
+    
+    ProcessSupervisorTest test;
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "ProcessSupervisorTest.moc"
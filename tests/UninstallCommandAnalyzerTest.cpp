@@ -0,0 +1,217 @@
+// UninstallCommandAnalyzer测试：真实卸载字符串组成的语料，覆盖MSI的/I和/X、
+// 带空格的加引号和未加引号路径、Inno Setup、NSIS、electron-builder，以及应保持未知的命令。
+// 语料中的路径在测试机上都不存在，NSIS只能由参数和注册表值识别。
+
+#include "UninstallCommandAnalyzer.h"
+#include <QtTest>
+
+Q_DECLARE_METATYPE(UninstallCommandAnalyzer::Family)
+
+namespace {
+
+const QString kSevenZipCode = "{23170F69-40C1-2702-2301-000001000000}";
+
+} // namespace
+
+class UninstallCommandAnalyzerTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void analyze_data();
+    void analyze();
+    void splitCommand_data();
+    void splitCommand();
+    void successExitCodes();
+};
+
+void UninstallCommandAnalyzerTest::analyze_data() {
+    QTest::addColumn<QString>("uninstallString");
+    QTest::addColumn<QVariantHash>("values");
+    QTest::addColumn<QString>("subKey");
+    QTest::addColumn<UninstallCommandAnalyzer::Family>("family");
+    QTest::addColumn<QString>("executable");
+    QTest::addColumn<QString>("productCode");
+    QTest::addColumn<QString>("quietCommand");
+    QTest::addColumn<bool>("vendorQuiet");
+    
+    const QString msiQuiet = QString("msiexec.exe /x %1 /qn /norestart").arg(kSevenZipCode);
+    
+    // MSI：/I是修改安装，与/X一样改写为/x卸载
+    QTest::newRow("msi /I")
+        << QString("MsiExec.exe /I%1").arg(kSevenZipCode) << QVariantHash() << kSevenZipCode
+        << UninstallCommandAnalyzer::Msi << "MsiExec.exe" << kSevenZipCode << msiQuiet << false;
+    QTest::newRow("msi /X")
+        << QString("MsiExec.exe /X%1").arg(kSevenZipCode) << QVariantHash() << QString()
+        << UninstallCommandAnalyzer::Msi << "MsiExec.exe" << kSevenZipCode << msiQuiet << false;
+    QTest::newRow("msi quoted system path, lower-case code")
+        << QString("\"C:\\Windows\\System32\\msiexec.exe\" /x %1 /qb").arg(kSevenZipCode.toLower()) << QVariantHash()
+        << QString() << UninstallCommandAnalyzer::Msi << "C:\\Windows\\System32\\msiexec.exe" << kSevenZipCode
+        << msiQuiet << false;
+    QTest::newRow("msi without extension")
+        << QString("msiexec /i %1").arg(kSevenZipCode) << QVariantHash() << QString()
+        << UninstallCommandAnalyzer::Msi << "msiexec" << kSevenZipCode << msiQuiet << false;
+    QTest::newRow("msi code from key name")
+        << QString("MsiExec.exe /I") << QVariantHash{{"WindowsInstaller", 1}} << kSevenZipCode.toLower()
+        << UninstallCommandAnalyzer::Msi << "MsiExec.exe" << kSevenZipCode << msiQuiet << false;
+    QTest::newRow("msi without product code")
+        << QString("msiexec.exe /x \"C:\\Installers\\Foo Setup.msi\"") << QVariantHash() << QString("Foo")
+        << UninstallCommandAnalyzer::Msi << "msiexec.exe" << QString() << QString() << false;
+    
+    // Inno Setup
+    QTest::newRow("inno quoted path with spaces")
+        << QString("\"C:\\Program Files\\Notepad++\\unins000.exe\"") << QVariantHash() << QString("Notepad++")
+        << UninstallCommandAnalyzer::InnoSetup << "C:\\Program Files\\Notepad++\\unins000.exe" << QString()
+        << QString("\"C:\\Program Files\\Notepad++\\unins000.exe\" /VERYSILENT /SUPPRESSMSGBOXES /NORESTART")
+        << false;
+    QTest::newRow("inno unquoted path with spaces")
+        << QString("C:\\Program Files\\Git\\unins001.exe /SILENT") << QVariantHash() << QString("Git_is1")
+        << UninstallCommandAnalyzer::InnoSetup << "C:\\Program Files\\Git\\unins001.exe" << QString()
+        << QString("\"C:\\Program Files\\Git\\unins001.exe\" /SILENT /VERYSILENT /SUPPRESSMSGBOXES /NORESTART")
+        << false;
+    QTest::newRow("inno switches not duplicated")
+        << QString("\"C:\\Program Files (x86)\\WinSCP\\unins000.exe\" /verysilent /norestart") << QVariantHash()
+        << QString("winscp3_is1") << UninstallCommandAnalyzer::InnoSetup
+        << "C:\\Program Files (x86)\\WinSCP\\unins000.exe" << QString()
+        << QString("\"C:\\Program Files (x86)\\WinSCP\\unins000.exe\" /verysilent /norestart /SUPPRESSMSGBOXES")
+        << false;
+    QTest::newRow("inno from registry values")
+        << QString("\"C:\\Program Files\\Foo\\uninstall.exe\"")
+        << QVariantHash{{"Inno Setup: App Path", "C:\\Program Files\\Foo"}} << QString("Foo_is1")
+        << UninstallCommandAnalyzer::InnoSetup << "C:\\Program Files\\Foo\\uninstall.exe" << QString()
+        << QString("\"C:\\Program Files\\Foo\\uninstall.exe\" /VERYSILENT /SUPPRESSMSGBOXES /NORESTART") << false;
+    
+    // NSIS：文件名之外必须有NSIS特有的依据
+    QTest::newRow("nsis with _?=")
+        << QString("\"C:\\Program Files\\Foo\\uninst.exe\" _?=C:\\Program Files\\Foo") << QVariantHash()
+        << QString("Foo") << UninstallCommandAnalyzer::Nsis << "C:\\Program Files\\Foo\\uninst.exe" << QString()
+        << QString("\"C:\\Program Files\\Foo\\uninst.exe\" /S _?=C:\\Program Files\\Foo") << false;
+    QTest::newRow("nsis unquoted path with /S")
+        << QString("C:\\Program Files (x86)\\Foo Bar\\uninstall.exe /S") << QVariantHash() << QString("Foo Bar")
+        << UninstallCommandAnalyzer::Nsis << "C:\\Program Files (x86)\\Foo Bar\\uninstall.exe" << QString()
+        << QString("\"C:\\Program Files (x86)\\Foo Bar\\uninstall.exe\" /S _?=C:\\Program Files (x86)\\Foo Bar")
+        << false;
+    QTest::newRow("nsis from registry values")
+        << QString("\"C:\\Program Files\\VLC\\uninstall.exe\"") << QVariantHash{{"NSIS:Language", "1033"}}
+        << QString("VLC media player") << UninstallCommandAnalyzer::Nsis << "C:\\Program Files\\VLC\\uninstall.exe"
+        << QString() << QString("\"C:\\Program Files\\VLC\\uninstall.exe\" /S _?=C:\\Program Files\\VLC") << false;
+    
+    // electron-builder生成NSIS卸载程序，通常附带QuietUninstallString
+    const QString electronUninstaller = "C:\\Users\\me\\AppData\\Local\\Programs\\foo-app\\Uninstall Foo App.exe";
+    QTest::newRow("electron-builder with QuietUninstallString")
+        << QString("\"%1\" /currentuser").arg(electronUninstaller)
+        << QVariantHash{{"QuietUninstallString", QString("\"%1\" /currentuser /S").arg(electronUninstaller)}}
+        << QString("a1b2c3d4-0000-4000-8000-000000000000") << UninstallCommandAnalyzer::Nsis << electronUninstaller
+        << QString() << QString("\"%1\" /currentuser /S").arg(electronUninstaller) << true;
+    QTest::newRow("electron-builder per machine")
+        << QString("\"C:\\Program Files\\Foo App\\Uninstall Foo App.exe\" /allusers") << QVariantHash()
+        << QString("a1b2c3d4-0000-4000-8000-000000000000") << UninstallCommandAnalyzer::Nsis
+        << "C:\\Program Files\\Foo App\\Uninstall Foo App.exe" << QString()
+        << QString("\"C:\\Program Files\\Foo App\\Uninstall Foo App.exe\" /S /allusers _?=C:\\Program Files\\Foo App")
+        << false;
+    
+    // 应保持未知：惯用文件名但没有第二个依据，以及其他安装程序
+    QTest::newRow("uninstall.exe without second signal")
+        << QString("\"C:\\Program Files\\Foo\\uninstall.exe\"") << QVariantHash() << QString("Foo")
+        << UninstallCommandAnalyzer::Unknown << "C:\\Program Files\\Foo\\uninstall.exe" << QString() << QString()
+        << false;
+    QTest::newRow("custom uninstaller with own switches")
+        << QString("C:\\Program Files\\Foo Tools\\UninstallHelper.exe -s -remove") << QVariantHash()
+        << QString("Foo Tools") << UninstallCommandAnalyzer::Unknown
+        << "C:\\Program Files\\Foo Tools\\UninstallHelper.exe" << QString() << QString() << false;
+    QTest::newRow("installshield driver")
+        << QString("\"C:\\Program Files (x86)\\Common Files\\InstallShield\\Driver\\8\\Intel 32\\IDriver.exe\" /M%1 /l1033")
+               .arg(kSevenZipCode)
+        << QVariantHash() << QString("InstallShield_%1").arg(kSevenZipCode) << UninstallCommandAnalyzer::Unknown
+        << "C:\\Program Files (x86)\\Common Files\\InstallShield\\Driver\\8\\Intel 32\\IDriver.exe" << QString()
+        << QString() << false;
+    QTest::newRow("wix burn bundle")
+        << QString("\"C:\\ProgramData\\Package Cache\\%1\\vc_redist.x64.exe\" /uninstall").arg(kSevenZipCode)
+        << QVariantHash{{"BundleVersion", "14.38.33135.0"}} << kSevenZipCode << UninstallCommandAnalyzer::Unknown
+        << QString("C:\\ProgramData\\Package Cache\\%1\\vc_redist.x64.exe").arg(kSevenZipCode) << QString() << QString()
+        << false;
+    QTest::newRow("chrome setup")
+        << QString("\"C:\\Program Files\\Google\\Chrome\\Application\\120.0.6099.130\\Installer\\setup.exe\" "
+                   "--uninstall --channel=stable --system-level")
+        << QVariantHash() << QString("Google Chrome") << UninstallCommandAnalyzer::Unknown
+        << "C:\\Program Files\\Google\\Chrome\\Application\\120.0.6099.130\\Installer\\setup.exe" << QString()
+        << QString() << false;
+    QTest::newRow("rundll32 inf")
+        << QString("RunDll32 advpack.dll,LaunchINFSection C:\\Windows\\INF\\foo.inf,DefaultUninstall") << QVariantHash()
+        << QString("Foo") << UninstallCommandAnalyzer::Unknown << "RunDll32" << QString() << QString() << false;
+    QTest::newRow("empty")
+        << QString() << QVariantHash() << QString() << UninstallCommandAnalyzer::Unknown << QString() << QString()
+        << QString() << false;
+    QTest::newRow("unknown with QuietUninstallString")
+        << QString("\"C:\\Program Files\\Foo\\remove.exe\"")
+        << QVariantHash{{"QuietUninstallString", "\"C:\\Program Files\\Foo\\remove.exe\" --quiet"}} << QString("Foo")
+        << UninstallCommandAnalyzer::Unknown << "C:\\Program Files\\Foo\\remove.exe" << QString()
+        << QString("\"C:\\Program Files\\Foo\\remove.exe\" --quiet") << true;
+}
+
+void UninstallCommandAnalyzerTest::analyze() {
+    QFETCH(QString, uninstallString);
+    QFETCH(QVariantHash, values);
+    QFETCH(QString, subKey);
+    QFETCH(UninstallCommandAnalyzer::Family, family);
+    QFETCH(QString, executable);
+    QFETCH(QString, productCode);
+    QFETCH(QString, quietCommand);
+    QFETCH(bool, vendorQuiet);
+    
+    const UninstallCommandAnalyzer::Analysis analysis = UninstallCommandAnalyzer::analyze(uninstallString, values, subKey);
+    QCOMPARE(UninstallCommandAnalyzer::familyName(analysis.family), UninstallCommandAnalyzer::familyName(family));
+    QCOMPARE(analysis.executable, executable);
+    QCOMPARE(analysis.productCode, productCode);
+    QCOMPARE(analysis.quietCommand, quietCommand);
+    QCOMPARE(analysis.vendorQuiet, vendorQuiet);
+    QCOMPARE(analysis.canRunQuietly(), !quietCommand.isEmpty());
+}
+
+void UninstallCommandAnalyzerTest::splitCommand_data() {
+    QTest::addColumn<QString>("command");
+    QTest::addColumn<QString>("executable");
+    QTest::addColumn<QString>("arguments");
+    
+    QTest::newRow("quoted with spaces")
+        << "\"C:\\Program Files\\Foo\\uninst.exe\" /S" << "C:\\Program Files\\Foo\\uninst.exe" << "/S";
+    QTest::newRow("quoted without arguments")
+        << "  \"C:\\Program Files\\Foo\\uninst.exe\"  " << "C:\\Program Files\\Foo\\uninst.exe" << "";
+    QTest::newRow("quoted without space before arguments")
+        << "\"C:\\Foo\\uninst.exe\"/S" << "C:\\Foo\\uninst.exe" << "/S";
+    QTest::newRow("unterminated quote")
+        << "\"C:\\Program Files\\Foo\\uninst.exe /S" << "C:\\Program Files\\Foo\\uninst.exe /S" << "";
+    QTest::newRow("unquoted with spaces")
+        << "C:\\Program Files (x86)\\Foo Bar\\uninstall.exe /x /y" << "C:\\Program Files (x86)\\Foo Bar\\uninstall.exe"
+        << "/x /y";
+    QTest::newRow("unquoted directory containing .exe")
+        << "C:\\Apps\\foo.executor\\uninst.exe /S" << "C:\\Apps\\foo.executor\\uninst.exe" << "/S";
+    QTest::newRow("no .exe")
+        << "RunDll32 advpack.dll,LaunchINFSection foo.inf" << "RunDll32" << "advpack.dll,LaunchINFSection foo.inf";
+    QTest::newRow("empty") << "   " << "" << "";
+}
+
+void UninstallCommandAnalyzerTest::splitCommand() {
+    QFETCH(QString, command);
+    QFETCH(QString, executable);
+    QFETCH(QString, arguments);
+    
+    QString actualExecutable;
+    QString actualArguments;
+    UninstallCommandAnalyzer::splitCommand(command, actualExecutable, actualArguments);
+    QCOMPARE(actualExecutable, executable);
+    QCOMPARE(actualArguments, arguments);
+}
+
+void UninstallCommandAnalyzerTest::successExitCodes() {
+    QVERIFY(UninstallCommandAnalyzer::isSuccessExitCode(UninstallCommandAnalyzer::Unknown, 0));
+    QVERIFY(UninstallCommandAnalyzer::isSuccessExitCode(UninstallCommandAnalyzer::Msi, 3010));
+    QVERIFY(UninstallCommandAnalyzer::isSuccessExitCode(UninstallCommandAnalyzer::Msi, 1641));
+    QVERIFY(UninstallCommandAnalyzer::isSuccessExitCode(UninstallCommandAnalyzer::Msi, 1605));
+    QVERIFY(!UninstallCommandAnalyzer::isSuccessExitCode(UninstallCommandAnalyzer::Msi, 1603));
+    QVERIFY(!UninstallCommandAnalyzer::isSuccessExitCode(UninstallCommandAnalyzer::Nsis, 3010));
+    QVERIFY(!UninstallCommandAnalyzer::isSuccessExitCode(UninstallCommandAnalyzer::InnoSetup, 1));
+}
+
+QTEST_APPLESS_MAIN(UninstallCommandAnalyzerTest)
+
+#include "UninstallCommandAnalyzerTest.moc"